@@ -0,0 +1,155 @@
+/**
+ * @file Arena.c
+ */
+
+#include "cgds/Arena.h"
+
+// Alignment of blocks, as guaranteed by malloc on 64-bits systems
+#define ARENA_ALIGNMENT 16
+
+#define ARENA_DEFAULT_CHUNK_SIZE (64 * 1024)
+
+// Round size up to a multiple of ARENA_ALIGNMENT [internal usage]
+size_t _arena_align(size_t size)
+{
+  return (size + ARENA_ALIGNMENT - 1) & ~((size_t)ARENA_ALIGNMENT - 1);
+}
+
+// Size of chunk header, such that chunk data is aligned [internal usage]
+#define ARENA_CHUNK_HEADER _arena_align(sizeof (ArenaChunk))
+
+// Functions of the arena allocator [internal usage]
+void* _arena_allocator_alloc(void* ctx, size_t size)
+{
+  return arena_alloc((Arena*)ctx, size);
+}
+
+void* _arena_allocator_realloc(
+  void* ctx, void* ptr, size_t oldSize, size_t size)
+{
+  return arena_realloc((Arena*)ctx, ptr, oldSize, size);
+}
+
+void arena_init_with(Arena* arena, size_t chunkSize, Allocator* allocator)
+{
+  arena->chunks = NULL;
+  arena->current = NULL;
+  arena->end = NULL;
+  arena->chunkSize =
+    _arena_align(chunkSize > 0 ? chunkSize : ARENA_DEFAULT_CHUNK_SIZE);
+  arena->used = 0;
+  arena->allocator.alloc = _arena_allocator_alloc;
+  arena->allocator.realloc = _arena_allocator_realloc;
+  arena->allocator.free = NULL;
+  arena->allocator.ctx = arena;
+  arena->chunkAllocator = allocator_or_default(allocator);
+}
+
+void arena_init(Arena* arena, size_t chunkSize)
+{
+  arena_init_with(arena, chunkSize, NULL);
+}
+
+Arena* arena_new(size_t chunkSize)
+{
+  Arena* arena = (Arena*) safe_malloc(sizeof (Arena));
+  arena_init(arena, chunkSize);
+  return arena;
+}
+
+// Start a new chunk of at least minSize bytes [internal usage]
+void _arena_add_chunk(Arena* arena, size_t minSize)
+{
+  size_t size = (minSize > arena->chunkSize ? minSize : arena->chunkSize);
+  ArenaChunk* chunk = (ArenaChunk*)
+    allocator_alloc(arena->chunkAllocator, ARENA_CHUNK_HEADER + size);
+  chunk->size = size;
+  chunk->next = arena->chunks;
+  arena->chunks = chunk;
+  arena->current = (char*)chunk + ARENA_CHUNK_HEADER;
+  arena->end = arena->current + size;
+}
+
+// Give a chunk back to the chunks allocator [internal usage]
+void _arena_free_chunk(Arena* arena, ArenaChunk* chunk)
+{
+  allocator_free(
+    arena->chunkAllocator, chunk, ARENA_CHUNK_HEADER + chunk->size);
+}
+
+void* arena_alloc(Arena* arena, size_t size)
+{
+  size = _arena_align(size > 0 ? size : 1);
+  if ((size_t)(arena->end - arena->current) < size)
+    _arena_add_chunk(arena, size);
+  void* block = arena->current;
+  arena->current += size;
+  arena->used += size;
+  return block;
+}
+
+void* arena_realloc(Arena* arena, void* ptr, size_t oldSize, size_t size)
+{
+  if (ptr == NULL)
+    return arena_alloc(arena, size);
+  oldSize = _arena_align(oldSize);
+  size_t alignedSize = _arena_align(size > 0 ? size : 1);
+  if (
+    (char*)ptr + oldSize == arena->current &&
+    (size_t)(arena->end - (char*)ptr) >= alignedSize
+  ) {
+    // Last block, with enough room behind: resize in place
+    arena->current = (char*)ptr + alignedSize;
+    arena->used = arena->used - oldSize + alignedSize;
+    return ptr;
+  }
+  void* block = arena_alloc(arena, size);
+  memcpy(block, ptr, oldSize < size ? oldSize : size);
+  return block;
+}
+
+Allocator* arena_allocator(Arena* arena)
+{
+  return &arena->allocator;
+}
+
+size_t arena_used(Arena* arena)
+{
+  return arena->used;
+}
+
+void arena_reset(Arena* arena)
+{
+  if (arena->chunks == NULL)
+    return;
+  // Keep the oldest chunk (default size, unless the first block was huge)
+  ArenaChunk* chunk = arena->chunks;
+  while (chunk->next != NULL)
+  {
+    ArenaChunk* next = chunk->next;
+    _arena_free_chunk(arena, chunk);
+    chunk = next;
+  }
+  arena->chunks = chunk;
+  arena->current = (char*)chunk + ARENA_CHUNK_HEADER;
+  arena->end = arena->current + chunk->size;
+  arena->used = 0;
+}
+
+void arena_release(Arena* arena)
+{
+  ArenaChunk* chunk = arena->chunks;
+  while (chunk != NULL)
+  {
+    ArenaChunk* next = chunk->next;
+    _arena_free_chunk(arena, chunk);
+    chunk = next;
+  }
+  arena_init_with(arena, arena->chunkSize, arena->chunkAllocator);
+}
+
+void arena_destroy(Arena* arena)
+{
+  arena_release(arena);
+  safe_free(arena);
+}
@@ -0,0 +1,124 @@
+/**
+ * @file Arena.h
+ */
+
+#ifndef CGDS_ARENA_H
+#define CGDS_ARENA_H
+
+#include <stdlib.h>
+#include <string.h>
+#include "cgds/safe_alloc.h"
+#include "cgds/types.h"
+
+/**
+ * @brief Block of memory from which an arena allocates.
+ */
+typedef struct ArenaChunk {
+  struct ArenaChunk* next; ///< Previously filled chunk (NULL if none).
+  size_t size; ///< Usable size of the chunk, in bytes.
+} ArenaChunk;
+
+/**
+ * @brief Region (bump-pointer) allocator: blocks are carved in sequence
+ * from large chunks, and all released at once by arena_reset() or
+ * arena_destroy().
+ *
+ * Containers bound to an arena (see arena_allocator()) never free their
+ * nodes one by one: clearing them just forgets the nodes.
+ * An arena is not thread-safe.
+ */
+typedef struct Arena {
+  ArenaChunk* chunks; ///< Chunk currently filled (others follow it).
+  char* current; ///< Next free byte in current chunk.
+  char* end; ///< End of current chunk.
+  size_t chunkSize; ///< Default size of a new chunk, in bytes.
+  size_t used; ///< Total size of allocated blocks, in bytes.
+  Allocator allocator; ///< Allocator drawing from this arena.
+  Allocator* chunkAllocator; ///< Allocator of the chunks.
+} Arena;
+
+/**
+ * @brief Initialize an empty arena.
+ */
+void arena_init(
+  Arena* arena, ///< "this" pointer.
+  size_t chunkSize ///< Default size of a chunk in bytes (0: 64KB).
+);
+
+/**
+ * @brief Initialize an empty arena, taking its chunks from given allocator.
+ */
+void arena_init_with(
+  Arena* arena, ///< "this" pointer.
+  size_t chunkSize, ///< Default size of a chunk in bytes (0: 64KB).
+  Allocator* allocator ///< Allocator of the chunks (NULL: default one).
+);
+
+/**
+ * @brief Return an allocated and initialized arena.
+ */
+Arena* arena_new(
+  size_t chunkSize ///< Default size of a chunk in bytes (0: 64KB).
+);
+
+/**
+ * @brief Allocate a block in the arena (aligned as malloc does).
+ * @return A pointer to the newly allocated area; exit program if fail.
+ */
+void* arena_alloc(
+  Arena* arena, ///< "this" pointer.
+  size_t size ///< Size of the block to allocate, in bytes.
+);
+
+/**
+ * @brief Resize a block of the arena: in place if it was the last one
+ * allocated, by copy otherwise.
+ */
+void* arena_realloc(
+  Arena* arena, ///< "this" pointer.
+  void* ptr, ///< Pointer on the block to be relocated.
+  size_t oldSize, ///< Current size of the block, in bytes.
+  size_t size ///< New size of the block, in bytes.
+);
+
+/**
+ * @brief Return the allocator to bind containers to this arena.
+ *
+ * Its free function is NULL: containers know that memory goes back to the
+ * arena only, and skip per-node release walks.
+ */
+Allocator* arena_allocator(
+  Arena* arena ///< "this" pointer.
+);
+
+/**
+ * @brief Return total size of blocks allocated since last reset.
+ */
+size_t arena_used(
+  Arena* arena ///< "this" pointer.
+);
+
+/**
+ * @brief Release all blocks at once; first chunk is kept for reuse.
+ *
+ * Containers bound to the arena must not be used afterwards.
+ */
+void arena_reset(
+  Arena* arena ///< "this" pointer.
+);
+
+/**
+ * @brief Release all chunks of an arena initialized by arena_init().
+ */
+void arena_release(
+  Arena* arena ///< "this" pointer.
+);
+
+/**
+ * @brief Destroy an arena and all blocks allocated from it.
+ */
+void arena_destroy(
+  Arena* arena ///< "this" pointer.
+);
+
+#endif
@@ -0,0 +1,241 @@
+/**
+ * @file BloomFilter.c
+ */
+
+#include "cgds/BloomFilter.h"
+#include <math.h>
+
+// Bits in a block, and cache line size
+#define BLOOMFILTER_BLOCK_BITS (BLOOMFILTER_BLOCK_WORDS * 64)
+#define BLOOMFILTER_BLOCK_BYTES (BLOOMFILTER_BLOCK_WORDS * sizeof(uint64_t))
+
+// Maximal number of bits set per element
+#define BLOOMFILTER_MAX_HASHES 16
+
+// Serialization format: magic bytes and version
+#define BLOOMFILTER_MAGIC "CGBF"
+#define BLOOMFILTER_VERSION 1
+
+// Key hash function and 64 bits mixer, from HashTable.c [internal usage]
+UInt _compute_hash(const void* key, size_t length);
+uint64_t _hashtable_mix(uint64_t a, uint64_t b);
+
+///////////////////////
+// BloomFilter logic //
+///////////////////////
+
+// Allocate a filter of given geometry, with all bits cleared
+// [internal usage]
+BloomFilter* _bloomfilter_alloc(UInt capacity, Real falsePositiveRate,
+                                UInt blocksCount, uint32_t hashCount,
+                                Allocator* allocator)
+{
+  allocator = allocator_or_default(allocator);
+  BloomFilter* filter =
+    (BloomFilter*) allocator_alloc(allocator, sizeof(BloomFilter));
+  filter->size = 0;
+  filter->capacity = capacity;
+  filter->falsePositiveRate = falsePositiveRate;
+  filter->blocksCount = blocksCount;
+  filter->hashCount = hashCount;
+  filter->allocator = allocator;
+  // NOTE: one extra line to align blocks on cache lines
+  filter->memory = allocator_alloc(
+    allocator, (blocksCount + 1) * BLOOMFILTER_BLOCK_BYTES);
+  filter->words = (uint64_t*)(((uintptr_t)filter->memory +
+    BLOOMFILTER_BLOCK_BYTES - 1) & ~(uintptr_t)(BLOOMFILTER_BLOCK_BYTES - 1));
+  bloomfilter_clear(filter);
+  return filter;
+}
+
+BloomFilter* _bloomfilter_new(UInt capacity, Real falsePositiveRate,
+                              Allocator* allocator)
+{
+  if (falsePositiveRate < 1e-9)
+    falsePositiveRate = 1e-9;
+  if (falsePositiveRate > 0.5)
+    falsePositiveRate = 0.5;
+  if (capacity == 0)
+    capacity = 1;
+  // Optimal (unblocked) geometry: -ln(p) / ln(2)^2 bits per element,
+  // ln(2) times as many bits set per element
+  Real bitsPerElement = -log(falsePositiveRate) / (M_LN2 * M_LN2);
+  uint32_t hashCount = (uint32_t)(bitsPerElement * M_LN2 + 0.5);
+  if (hashCount < 1)
+    hashCount = 1;
+  if (hashCount > BLOOMFILTER_MAX_HASHES)
+    hashCount = BLOOMFILTER_MAX_HASHES;
+  // NOTE: blocks fill unevenly; 25% more bits keep the target rate
+  Real bits = ceil(1.25 * bitsPerElement * capacity);
+  UInt blocksCount =
+    (UInt)((bits + BLOOMFILTER_BLOCK_BITS - 1) / BLOOMFILTER_BLOCK_BITS);
+  if (blocksCount == 0)
+    blocksCount = 1;
+  return _bloomfilter_alloc(
+    capacity, falsePositiveRate, blocksCount, hashCount, allocator);
+}
+
+BloomFilter* bloomfilter_copy(BloomFilter* filter)
+{
+  BloomFilter* copy = _bloomfilter_alloc(
+    filter->capacity, filter->falsePositiveRate, filter->blocksCount,
+    filter->hashCount, filter->allocator);
+  memcpy(copy->words, filter->words,
+         filter->blocksCount * BLOOMFILTER_BLOCK_BYTES);
+  copy->size = filter->size;
+  return copy;
+}
+
+UInt bloomfilter_size(BloomFilter* filter)
+{
+  return filter->size;
+}
+
+// Block of a hash, and (h1, h2) giving the bits h1 + i.h2 to set in it
+// [internal usage]
+uint64_t* _bloomfilter_block(BloomFilter* filter, UInt hash,
+                             uint32_t* h1, uint32_t* h2)
+{
+  // NOTE: custom hashes may be small integers: mix before splitting
+  uint64_t mixed = _hashtable_mix(hash ^ 0xa0761d6478bd642fULL,
+                                  0xe7037ed1a0b428dbULL);
+  UInt block = ((mixed >> 32) * filter->blocksCount) >> 32;
+  uint64_t probe = mixed * 0x9e3779b97f4a7c15ULL;
+  *h1 = (uint32_t)(probe >> 32);
+  *h2 = (uint32_t)probe | 1;
+  return filter->words + block * BLOOMFILTER_BLOCK_WORDS;
+}
+
+void bloomfilter_add_hash(BloomFilter* filter, UInt hash)
+{
+  uint32_t h1, h2;
+  uint64_t* block = _bloomfilter_block(filter, hash, &h1, &h2);
+  for (uint32_t i = 0; i < filter->hashCount; i++)
+  {
+    // Top 9 bits: position in the block
+    uint32_t bit = (h1 + i * h2) >> 23;
+    block[bit >> 6] |= (uint64_t)1 << (bit & 63);
+  }
+  filter->size++;
+}
+
+bool bloomfilter_has_hash(BloomFilter* filter, UInt hash)
+{
+  uint32_t h1, h2;
+  uint64_t* block = _bloomfilter_block(filter, hash, &h1, &h2);
+  for (uint32_t i = 0; i < filter->hashCount; i++)
+  {
+    uint32_t bit = (h1 + i * h2) >> 23;
+    if (!(block[bit >> 6] & ((uint64_t)1 << (bit & 63))))
+      return false;
+  }
+  return true;
+}
+
+void bloomfilter_add(BloomFilter* filter, const void* key, size_t length)
+{
+  bloomfilter_add_hash(filter, _compute_hash(key, length));
+}
+
+bool bloomfilter_has(BloomFilter* filter, const void* key, size_t length)
+{
+  return bloomfilter_has_hash(filter, _compute_hash(key, length));
+}
+
+/////////////////////////
+// Serialization logic //
+/////////////////////////
+
+// Little-endian writes and reads [internal usage]
+void _bloomfilter_write(unsigned char* p, uint64_t value, int bytes)
+{
+  for (int i = 0; i < bytes; i++)
+    p[i] = (unsigned char)(value >> (8 * i));
+}
+
+uint64_t _bloomfilter_read(const unsigned char* p, int bytes)
+{
+  uint64_t value = 0;
+  for (int i = 0; i < bytes; i++)
+    value |= (uint64_t)p[i] << (8 * i);
+  return value;
+}
+
+size_t bloomfilter_serialized_size(BloomFilter* filter)
+{
+  return BLOOMFILTER_HEADER_SIZE +
+         filter->blocksCount * BLOOMFILTER_BLOCK_BYTES;
+}
+
+void bloomfilter_serialize(BloomFilter* filter, void* buffer)
+{
+  // Header: magic, version, hashCount, 0, blocksCount, capacity, size, rate
+  unsigned char* p = (unsigned char*)buffer;
+  memcpy(p, BLOOMFILTER_MAGIC, 4);
+  _bloomfilter_write(p + 4, BLOOMFILTER_VERSION, 4);
+  _bloomfilter_write(p + 8, filter->hashCount, 4);
+  _bloomfilter_write(p + 12, 0, 4);
+  _bloomfilter_write(p + 16, filter->blocksCount, 8);
+  _bloomfilter_write(p + 24, filter->capacity, 8);
+  _bloomfilter_write(p + 32, filter->size, 8);
+  uint64_t rate;
+  memcpy(&rate, &filter->falsePositiveRate, 8);
+  _bloomfilter_write(p + 40, rate, 8);
+  p += BLOOMFILTER_HEADER_SIZE;
+  UInt wordsCount = filter->blocksCount * BLOOMFILTER_BLOCK_WORDS;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  memcpy(p, filter->words, wordsCount * sizeof(uint64_t));
+#else
+  for (UInt i = 0; i < wordsCount; i++)
+    _bloomfilter_write(p + 8 * i, filter->words[i], 8);
+#endif
+}
+
+BloomFilter* _bloomfilter_deserialize(const void* buffer, size_t length,
+                                      Allocator* allocator)
+{
+  const unsigned char* p = (const unsigned char*)buffer;
+  if (length < BLOOMFILTER_HEADER_SIZE ||
+      memcmp(p, BLOOMFILTER_MAGIC, 4) != 0 ||
+      _bloomfilter_read(p + 4, 4) != BLOOMFILTER_VERSION)
+  {
+    return NULL;
+  }
+  uint32_t hashCount = (uint32_t)_bloomfilter_read(p + 8, 4);
+  UInt blocksCount = _bloomfilter_read(p + 16, 8);
+  size_t bytes = length - BLOOMFILTER_HEADER_SIZE;
+  if (hashCount < 1 || hashCount > BLOOMFILTER_MAX_HASHES ||
+      blocksCount == 0 || bytes % BLOOMFILTER_BLOCK_BYTES != 0 ||
+      blocksCount != bytes / BLOOMFILTER_BLOCK_BYTES)
+  {
+    return NULL;
+  }
+  Real falsePositiveRate;
+  uint64_t rate = _bloomfilter_read(p + 40, 8);
+  memcpy(&falsePositiveRate, &rate, 8);
+  BloomFilter* filter = _bloomfilter_alloc(_bloomfilter_read(p + 24, 8),
+    falsePositiveRate, blocksCount, hashCount, allocator);
+  filter->size = _bloomfilter_read(p + 32, 8);
+  p += BLOOMFILTER_HEADER_SIZE;
+  UInt wordsCount = blocksCount * BLOOMFILTER_BLOCK_WORDS;
+#if __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  memcpy(filter->words, p, wordsCount * sizeof(uint64_t));
+#else
+  for (UInt i = 0; i < wordsCount; i++)
+    filter->words[i] = _bloomfilter_read(p + 8 * i, 8);
+#endif
+  return filter;
+}
+
+void bloomfilter_clear(BloomFilter* filter)
+{
+  memset(filter->words, 0, filter->blocksCount * BLOOMFILTER_BLOCK_BYTES);
+  filter->size = 0;
+}
+
+void bloomfilter_destroy(BloomFilter* filter)
+{
+  allocator_free(filter->allocator, filter->memory,
+                 (filter->blocksCount + 1) * BLOOMFILTER_BLOCK_BYTES);
+  allocator_free(filter->allocator, filter, sizeof(BloomFilter));
+}
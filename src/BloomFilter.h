@@ -0,0 +1,167 @@
+/**
+ * @file BloomFilter.h
+ */
+
+#ifndef CGDS_BLOOM_FILTER_H
+#define CGDS_BLOOM_FILTER_H
+
+#include <stdlib.h>
+#include <string.h>
+#include "cgds/safe_alloc.h"
+#include "cgds/types.h"
+
+/**
+ * @brief Number of 64-bits words in a block (one cache line).
+ */
+#define BLOOMFILTER_BLOCK_WORDS 8
+
+/**
+ * @brief Size in bytes of the header of a serialized filter.
+ */
+#define BLOOMFILTER_HEADER_SIZE 48
+
+/**
+ * @brief Probabilistic membership filter: "absent" answers are exact,
+ * "present" answers are wrong with a tunable probability.
+ *
+ * Blocked Bloom filter: the (64 bits) hash of an element selects one block
+ * of 512 bits (a cache line), in which hashCount bits are set. A lookup
+ * thus costs at most one cache miss. Elements cannot be removed: owners
+ * rebuild the filter from scratch when needed.
+ */
+typedef struct BloomFilter {
+  UInt size; ///< Count elements added.
+  UInt capacity; ///< Number of elements the filter was sized for.
+  Real falsePositiveRate; ///< Target false positive rate (at capacity).
+  UInt blocksCount; ///< Number of blocks.
+  uint32_t hashCount; ///< Number of bits set per element.
+  uint64_t* words; ///< Bits, aligned on a cache line.
+  void* memory; ///< Allocated block holding words.
+  Allocator* allocator; ///< Allocator of the struct and bits.
+} BloomFilter;
+
+/**
+ * @brief Return an allocated and initialized (empty) filter.
+ */
+BloomFilter* _bloomfilter_new(
+  UInt capacity, ///< Expected number of elements.
+  Real falsePositiveRate, ///< Target false positive rate, in ]0, 1[.
+  Allocator* allocator ///< Memory allocator (NULL: default one).
+);
+
+/**
+ * @brief Return an allocated and initialized (empty) filter.
+ *
+ * Usage: BloomFilter* bloomfilter_new(UInt capacity, Real rate)
+ */
+#define bloomfilter_new(capacity, rate) \
+  _bloomfilter_new(capacity, rate, NULL)
+
+/**
+ * @brief Return an allocated and initialized filter, using given allocator.
+ *
+ * Usage: BloomFilter* bloomfilter_new_with(UInt capacity, Real rate,
+ *                                          Allocator* a)
+ */
+#define bloomfilter_new_with(capacity, rate, allocator) \
+  _bloomfilter_new(capacity, rate, allocator)
+
+/**
+ * @brief Copy constructor.
+ */
+BloomFilter* bloomfilter_copy(
+  BloomFilter* filter ///< "this" pointer.
+);
+
+/**
+ * @brief Return the number of elements added.
+ */
+UInt bloomfilter_size(
+  BloomFilter* filter ///< "this" pointer.
+);
+
+/**
+ * @brief Add an element, given by its hash.
+ */
+void bloomfilter_add_hash(
+  BloomFilter* filter, ///< "this" pointer.
+  UInt hash ///< Hash of the element (any 64 bits function).
+);
+
+/**
+ * @brief Tell if an element, given by its hash, may have been added.
+ * @return false if the element was certainly not added.
+ */
+bool bloomfilter_has_hash(
+  BloomFilter* filter, ///< "this" pointer.
+  UInt hash ///< Hash of the element (same function as when adding).
+);
+
+/**
+ * @brief Add an element given as bytes (hashed like HashTable keys).
+ */
+void bloomfilter_add(
+  BloomFilter* filter, ///< "this" pointer.
+  const void* key, ///< Bytes of the element.
+  size_t length ///< Number of bytes.
+);
+
+/**
+ * @brief Tell if an element given as bytes may have been added.
+ * @return false if the element was certainly not added.
+ */
+bool bloomfilter_has(
+  BloomFilter* filter, ///< "this" pointer.
+  const void* key, ///< Bytes of the element.
+  size_t length ///< Number of bytes.
+);
+
+/**
+ * @brief Size in bytes of the serialized filter.
+ */
+size_t bloomfilter_serialized_size(
+  BloomFilter* filter ///< "this" pointer.
+);
+
+/**
+ * @brief Write the filter (portable: little-endian) into a buffer of
+ * bloomfilter_serialized_size() bytes.
+ */
+void bloomfilter_serialize(
+  BloomFilter* filter, ///< "this" pointer.
+  void* buffer ///< Destination.
+);
+
+/**
+ * @brief Return a filter read from a buffer written by
+ * bloomfilter_serialize(), or NULL if the buffer is not a valid filter.
+ */
+BloomFilter* _bloomfilter_deserialize(
+  const void* buffer, ///< Serialized filter.
+  size_t length, ///< Size of the buffer in bytes.
+  Allocator* allocator ///< Memory allocator (NULL: default one).
+);
+
+/**
+ * @brief Return a filter read from a buffer, or NULL if invalid.
+ *
+ * Usage: BloomFilter* bloomfilter_deserialize(void* buffer, size_t length)
+ */
+#define bloomfilter_deserialize(buffer, length) \
+  _bloomfilter_deserialize(buffer, length, NULL)
+
+/**
+ * @brief Remove all elements.
+ */
+void bloomfilter_clear(
+  BloomFilter* filter ///< "this" pointer.
+);
+
+/**
+ * @brief Destroy the filter.
+ */
+void bloomfilter_destroy(
+  BloomFilter* filter ///< "this" pointer.
+);
+
+#endif
@@ -7,20 +7,24 @@
 // NOTE: no init() method here, since BufferTop has no specific initialization
 
 BufferTop* _buffertop_new(
-  size_t dataSize, UInt capacity, OrderType bType, UInt arity)
+  size_t dataSize, UInt capacity, OrderType bType, UInt arity,
+  Allocator* allocator)
 {
-  BufferTop* bufferTop = (BufferTop*) safe_malloc(sizeof (BufferTop));
+  allocator = allocator_or_default(allocator);
+  BufferTop* bufferTop =
+    (BufferTop*) allocator_alloc(allocator, sizeof (BufferTop));
   bufferTop->capacity = capacity;
   bufferTop->bType = bType; //redondant, but facilitate understanding
   // WARNING: heap must have opposite type: "smallest" element first
   bufferTop->heap =
-    _heap_new(dataSize, (bType == MAX_T ? MIN_T : MAX_T), arity);
+    _heap_new(dataSize, (bType == MAX_T ? MIN_T : MAX_T), arity, allocator);
   return bufferTop;
 }
 
 BufferTop* buffertop_copy(BufferTop* bufferTop)
 {
-  BufferTop* bufferTopCopy = (BufferTop*) safe_malloc(sizeof (BufferTop));
+  BufferTop* bufferTopCopy = (BufferTop*)
+    allocator_alloc(bufferTop->heap->allocator, sizeof (BufferTop));
   bufferTopCopy->capacity = bufferTop->capacity;
   bufferTopCopy->bType = bufferTop->bType;
   bufferTopCopy->heap = heap_copy(bufferTop->heap);
@@ -31,7 +35,8 @@ List* buffertop_2list(BufferTop* bufferTop)
 {
   // Copy the buffer, and then use the copy to build the list
   BufferTop* bufferTopCopy = buffertop_copy(bufferTop);
-  List* bufferInList = _list_new(bufferTop->heap->items->dataSize);
+  List* bufferInList = _list_new(
+    bufferTop->heap->dataSize, bufferTop->heap->allocator);
   while (!buffertop_empty(bufferTopCopy))
   {
     void* topItem = _heap_top(bufferTopCopy->heap).item;
@@ -57,7 +62,8 @@ UInt buffertop_size(BufferTop* bufferTop)
 void _buffertop_tryadd(BufferTop* bufferTop, void* item, Real value)
 {
   if (heap_size(bufferTop->heap) >= bufferTop->capacity) {
-    Real topValue = *((Real*) (bufferTop->heap->values->datas));
+    // NOTE: value comes first in the top heap record
+    Real topValue = *((Real*) (bufferTop->heap->records->datas));
     if (
       (bufferTop->bType == MIN_T && value >= topValue) ||
       (bufferTop->bType == MAX_T && value <= topValue)
@@ -92,6 +98,7 @@ void buffertop_clear(BufferTop* bufferTop)
 
 void buffertop_destroy(BufferTop* bufferTop)
 {
+  Allocator* allocator = bufferTop->heap->allocator;
   heap_destroy(bufferTop->heap);
-  safe_free(bufferTop);
+  allocator_free(allocator, bufferTop, sizeof (BufferTop));
 }
@@ -28,7 +28,8 @@ BufferTop* _buffertop_new(
   size_t dataSize, ///< Size in bytes of a buffer element.
   UInt capacity, ///< Maximum number of elements that the buffer can contain.
   OrderType bType, ///< Type of buffer: keep max or min items (MAX_T or MIN_T).
-  UInt arity ///< Arity of the wrapped heap: any integer >=2.
+  UInt arity, ///< Arity of the wrapped heap: any integer >=2.
+  Allocator* allocator ///< Memory allocator (NULL: default one).
 );
 
 /**
@@ -41,7 +42,17 @@ BufferTop* _buffertop_new(
  * Usage: BufferTop* buffertop_new(<Type> type, UInt capacity, OrderTypebType, UInt arity)
  */
 #define buffertop_new(type, capacity, bType, arity) \
-  _buffertop_new(sizeof(type), capacity, bType, arity)
+  _buffertop_new(sizeof(type), capacity, bType, arity, NULL)
+
+/**
+ * @brief Return an allocated and initialized buffer, using given allocator.
+ *
+ * Usage: BufferTop* buffertop_new_with(<Type> type, UInt capacity,
+ *                                      OrderType bType, UInt arity,
+ *                                      Allocator* allocator)
+ */
+#define buffertop_new_with(type, capacity, bType, arity, allocator) \
+  _buffertop_new(sizeof(type), capacity, bType, arity, allocator)
 
 /**
  * @brief Copy constructor (shallow copy, ok for basic types).
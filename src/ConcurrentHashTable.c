@@ -0,0 +1,458 @@
+/**
+ * @file ConcurrentHashTable.c
+ */
+
+#include "cgds/ConcurrentHashTable.h"
+
+// Minimal number of buckets: at least one per lock, so that a bucket is
+// always covered by a single lock
+#define CONCURRENTHASHTABLE_MIN_SIZE CONCURRENTHASHTABLE_STRIPES
+
+// Try to reclaim retired blocks every that many retirements
+#define CONCURRENTHASHTABLE_RECLAIM_PERIOD 64
+
+// Key hash function, from HashTable.c [internal usage]
+UInt _compute_hash(const void* key, size_t length);
+
+//***********************************
+// Epoch-based reclamation (global)
+//***********************************
+
+// Epoch state of a thread, kept in a global list (never freed)
+typedef struct EpochRecord {
+  struct EpochRecord* next; ///< Next record in the list.
+  UInt epoch; ///< Epoch observed when entering a guard, 0 if outside.
+  UInt depth; ///< Nested guards count.
+  int inUse; ///< Whether a thread owns this record.
+} EpochRecord;
+
+static UInt _epoch_global = 1;
+static EpochRecord* _epoch_records = NULL;
+static __thread EpochRecord* _epoch_local = NULL;
+static pthread_key_t _epoch_key;
+static pthread_once_t _epoch_once = PTHREAD_ONCE_INIT;
+
+// Give the record of an exiting thread back [internal usage]
+void _epoch_release_record(void* record)
+{
+  __atomic_store_n(&((EpochRecord*)record)->inUse, 0, __ATOMIC_RELEASE);
+}
+
+void _epoch_create_key()
+{
+  pthread_key_create(&_epoch_key, _epoch_release_record);
+}
+
+// Record of the current thread: reuse a free one, or add one [internal usage]
+EpochRecord* _epoch_record()
+{
+  if (_epoch_local != NULL)
+    return _epoch_local;
+  pthread_once(&_epoch_once, _epoch_create_key);
+  EpochRecord* record =
+    __atomic_load_n(&_epoch_records, __ATOMIC_ACQUIRE);
+  for (; record != NULL; record = record->next)
+  {
+    int unused = 0;
+    if (__atomic_compare_exchange_n(&record->inUse, &unused, 1, false,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_RELAXED))
+    {
+      break;
+    }
+  }
+  if (record == NULL)
+  {
+    record = (EpochRecord*) safe_malloc(sizeof(EpochRecord));
+    record->epoch = 0;
+    record->depth = 0;
+    record->inUse = 1;
+    record->next = __atomic_load_n(&_epoch_records, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&_epoch_records, &record->next,
+                                        record, true, __ATOMIC_RELEASE,
+                                        __ATOMIC_RELAXED));
+  }
+  pthread_setspecific(_epoch_key, record);
+  _epoch_local = record;
+  return record;
+}
+
+// Start reading shared nodes [internal usage]
+void _epoch_enter()
+{
+  EpochRecord* record = _epoch_record();
+  if (record->depth++ == 0)
+  {
+    __atomic_store_n(&record->epoch,
+                     __atomic_load_n(&_epoch_global, __ATOMIC_SEQ_CST),
+                     __ATOMIC_SEQ_CST);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  }
+}
+
+// Stop reading shared nodes [internal usage]
+void _epoch_exit()
+{
+  EpochRecord* record = _epoch_local;
+  if (--record->depth == 0)
+    __atomic_store_n(&record->epoch, 0, __ATOMIC_RELEASE);
+}
+
+// Advance global epoch if all threads in a guard observed it; return the
+// (possibly new) global epoch [internal usage]
+UInt _epoch_try_advance()
+{
+  UInt epoch = __atomic_load_n(&_epoch_global, __ATOMIC_SEQ_CST);
+  EpochRecord* record = __atomic_load_n(&_epoch_records, __ATOMIC_ACQUIRE);
+  for (; record != NULL; record = record->next)
+  {
+    UInt observed = __atomic_load_n(&record->epoch, __ATOMIC_SEQ_CST);
+    if (observed != 0 && observed != epoch)
+      return epoch;
+  }
+  __atomic_compare_exchange_n(&_epoch_global, &epoch, epoch + 1, false,
+                              __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+  return __atomic_load_n(&_epoch_global, __ATOMIC_SEQ_CST);
+}
+
+//*****************
+// Table logic
+//*****************
+
+// Allocate empty buckets [internal usage]
+ConcurrentHashBuckets* _concurrenthashtable_new_buckets(
+  ConcurrentHashTable* hashTable, size_t count)
+{
+  size_t size =
+    sizeof(ConcurrentHashBuckets) + count * sizeof(ConcurrentHashNode*);
+  ConcurrentHashBuckets* buckets = (ConcurrentHashBuckets*)
+    allocator_alloc(hashTable->allocator, size);
+  buckets->garbage.size = size;
+  buckets->count = count;
+  memset(buckets->heads, 0, count * sizeof(ConcurrentHashNode*));
+  return buckets;
+}
+
+ConcurrentHashTable* _concurrenthashtable_new(
+  size_t keySize, size_t dataSize, size_t hashSize,
+  UInt (*getHash)(void*, size_t), bool (*equal)(void*, void*),
+  Allocator* allocator)
+{
+  allocator = allocator_or_default(allocator);
+  ConcurrentHashTable* hashTable = (ConcurrentHashTable*)
+    allocator_alloc(allocator, sizeof(ConcurrentHashTable));
+  hashTable->allocator = allocator;
+  hashTable->dataSize = dataSize;
+  hashTable->keySize = keySize;
+  hashTable->getHash = getHash; //may be NULL
+  hashTable->equal = equal; //may be NULL
+  size_t count = CONCURRENTHASHTABLE_MIN_SIZE;
+  while (count < hashSize)
+    count <<= 1;
+  hashTable->buckets = _concurrenthashtable_new_buckets(hashTable, count);
+  hashTable->size = 0;
+  for (int i = 0; i < CONCURRENTHASHTABLE_STRIPES; i++)
+    pthread_mutex_init(&hashTable->locks[i], NULL);
+  pthread_mutex_init(&hashTable->garbageLock, NULL);
+  hashTable->garbageHead = NULL;
+  hashTable->garbageTail = NULL;
+  hashTable->garbageCount = 0;
+  return hashTable;
+}
+
+bool concurrenthashtable_empty(ConcurrentHashTable* hashTable)
+{
+  return (concurrenthashtable_size(hashTable) == 0);
+}
+
+UInt concurrenthashtable_size(ConcurrentHashTable* hashTable)
+{
+  return __atomic_load_n(&hashTable->size, __ATOMIC_RELAXED);
+}
+
+// Key of a node, stored after data [internal usage]
+char* _concurrenthashtable_node_key(
+  ConcurrentHashTable* hashTable, ConcurrentHashNode* node)
+{
+  return node->data + pool_align(hashTable->dataSize);
+}
+
+// Build an unpublished node [internal usage]
+ConcurrentHashNode* _concurrenthashtable_new_node(
+  ConcurrentHashTable* hashTable, void* key, size_t keyLength, UInt hash,
+  void* data)
+{
+  // NOTE: string keys keep their final '\0'
+  size_t size = sizeof(ConcurrentHashNode) +
+    pool_align(hashTable->dataSize) +
+    keyLength + (hashTable->keySize > 0 ? 0 : 1);
+  ConcurrentHashNode* node = (ConcurrentHashNode*)
+    allocator_alloc(hashTable->allocator, size);
+  node->garbage.size = size;
+  node->next = NULL;
+  node->hash = hash;
+  node->keyLength = keyLength;
+  memcpy(node->data, data, hashTable->dataSize);
+  memcpy(_concurrenthashtable_node_key(hashTable, node), key,
+         size - sizeof(ConcurrentHashNode) - pool_align(hashTable->dataSize));
+  return node;
+}
+
+// Free retired blocks older than two epochs [internal usage]
+void _concurrenthashtable_reclaim(ConcurrentHashTable* hashTable, UInt epoch)
+{
+  ConcurrentHashGarbage* garbage = hashTable->garbageHead;
+  // NOTE: list is sorted by epoch (retirements are serialized)
+  while (garbage != NULL && garbage->epoch + 2 <= epoch)
+  {
+    ConcurrentHashGarbage* next = garbage->next;
+    allocator_free(hashTable->allocator, garbage, garbage->size);
+    hashTable->garbageCount--;
+    garbage = next;
+  }
+  hashTable->garbageHead = garbage;
+  if (garbage == NULL)
+    hashTable->garbageTail = NULL;
+}
+
+// Queue an unlinked block for reclamation [internal usage]
+void _concurrenthashtable_retire(
+  ConcurrentHashTable* hashTable, ConcurrentHashGarbage* garbage)
+{
+  pthread_mutex_lock(&hashTable->garbageLock);
+  // NOTE: epoch read after unlinking: readers which may still see the block
+  // observed this epoch or an earlier one
+  garbage->epoch = __atomic_load_n(&_epoch_global, __ATOMIC_SEQ_CST);
+  garbage->next = NULL;
+  if (hashTable->garbageTail != NULL)
+    hashTable->garbageTail->next = garbage;
+  else
+    hashTable->garbageHead = garbage;
+  hashTable->garbageTail = garbage;
+  if (++hashTable->garbageCount % CONCURRENTHASHTABLE_RECLAIM_PERIOD == 0)
+    _concurrenthashtable_reclaim(hashTable, _epoch_try_advance());
+  pthread_mutex_unlock(&hashTable->garbageLock);
+}
+
+// Length of a key: string length, or fixed size [internal usage]
+size_t _concurrenthashtable_key_length(
+  ConcurrentHashTable* hashTable, void* key)
+{
+  if (hashTable->keySize > 0)
+    return hashTable->keySize;
+  return strlen((char*)key);
+}
+
+// Hash of a key of given length [internal usage]
+UInt _concurrenthashtable_hash(
+  ConcurrentHashTable* hashTable, void* key, size_t keyLength)
+{
+  if (hashTable->getHash != NULL)
+    return hashTable->getHash(key, keyLength);
+  return _compute_hash(key, keyLength);
+}
+
+// Whether a node holds given key [internal usage]
+bool _concurrenthashtable_match(ConcurrentHashTable* hashTable,
+                                ConcurrentHashNode* node, void* key,
+                                size_t keyLength, UInt hash)
+{
+  if (node->hash != hash || node->keyLength != keyLength)
+    return false;
+  char* nodeKey = _concurrenthashtable_node_key(hashTable, node);
+  if (hashTable->equal != NULL)
+    return hashTable->equal(nodeKey, key);
+  return (memcmp(nodeKey, key, keyLength) == 0);
+}
+
+// Lock of the buckets of given hash: the same for all buckets arrays, since
+// their sizes are multiples of the stripes count [internal usage]
+pthread_mutex_t* _concurrenthashtable_lock(
+  ConcurrentHashTable* hashTable, UInt hash)
+{
+  return &hashTable->locks[hash & (CONCURRENTHASHTABLE_STRIPES - 1)];
+}
+
+bool _concurrenthashtable_get(
+  ConcurrentHashTable* hashTable, void* key, void* data)
+{
+  size_t keyLength = _concurrenthashtable_key_length(hashTable, key);
+  UInt hash = _concurrenthashtable_hash(hashTable, key, keyLength);
+  bool found = false;
+  _epoch_enter();
+  ConcurrentHashBuckets* buckets =
+    __atomic_load_n(&hashTable->buckets, __ATOMIC_ACQUIRE);
+  ConcurrentHashNode* node = __atomic_load_n(
+    &buckets->heads[hash & (buckets->count - 1)], __ATOMIC_ACQUIRE);
+  while (node != NULL)
+  {
+    if (_concurrenthashtable_match(hashTable, node, key, keyLength, hash))
+    {
+      if (data != NULL)
+        memcpy(data, node->data, hashTable->dataSize);
+      found = true;
+      break;
+    }
+    node = __atomic_load_n(&node->next, __ATOMIC_ACQUIRE);
+  }
+  _epoch_exit();
+  return found;
+}
+
+bool concurrenthashtable_contains(ConcurrentHashTable* hashTable, void* key)
+{
+  return _concurrenthashtable_get(hashTable, key, NULL);
+}
+
+// Lock all stripes (in order), for whole table operations [internal usage]
+void _concurrenthashtable_lock_all(ConcurrentHashTable* hashTable)
+{
+  for (int i = 0; i < CONCURRENTHASHTABLE_STRIPES; i++)
+    pthread_mutex_lock(&hashTable->locks[i]);
+}
+
+void _concurrenthashtable_unlock_all(ConcurrentHashTable* hashTable)
+{
+  for (int i = CONCURRENTHASHTABLE_STRIPES - 1; i >= 0; i--)
+    pthread_mutex_unlock(&hashTable->locks[i]);
+}
+
+// Replace buckets by new ones of given size, holding copies of all nodes
+// if asked (published nodes are never relinked: readers may walk them).
+// All stripes must be locked [internal usage]
+void _concurrenthashtable_rebuild(
+  ConcurrentHashTable* hashTable, size_t count, bool copyNodes)
+{
+  ConcurrentHashBuckets* old = hashTable->buckets;
+  ConcurrentHashBuckets* buckets =
+    _concurrenthashtable_new_buckets(hashTable, count);
+  for (size_t i = 0; copyNodes && i < old->count; i++)
+  {
+    for (ConcurrentHashNode* node = old->heads[i]; node != NULL;
+         node = node->next)
+    {
+      ConcurrentHashNode* copy = _concurrenthashtable_new_node(
+        hashTable, _concurrenthashtable_node_key(hashTable, node),
+        node->keyLength, node->hash, node->data);
+      size_t j = node->hash & (count - 1);
+      copy->next = buckets->heads[j];
+      buckets->heads[j] = copy;
+    }
+  }
+  __atomic_store_n(&hashTable->buckets, buckets, __ATOMIC_RELEASE);
+  // Old nodes and buckets become garbage
+  for (size_t i = 0; i < old->count; i++)
+  {
+    ConcurrentHashNode* node = old->heads[i];
+    while (node != NULL)
+    {
+      ConcurrentHashNode* next = node->next;
+      _concurrenthashtable_retire(hashTable, &node->garbage);
+      node = next;
+    }
+  }
+  _concurrenthashtable_retire(hashTable, &old->garbage);
+}
+
+// Double buckets count if load factor exceeds 1 [internal usage]
+void _concurrenthashtable_grow(ConcurrentHashTable* hashTable)
+{
+  _concurrenthashtable_lock_all(hashTable);
+  size_t count = hashTable->buckets->count;
+  // NOTE: another writer may have resized meanwhile
+  if (concurrenthashtable_size(hashTable) > count)
+    _concurrenthashtable_rebuild(hashTable, 2 * count, true);
+  _concurrenthashtable_unlock_all(hashTable);
+}
+
+void _concurrenthashtable_set(
+  ConcurrentHashTable* hashTable, void* key, void* data)
+{
+  size_t keyLength = _concurrenthashtable_key_length(hashTable, key);
+  UInt hash = _concurrenthashtable_hash(hashTable, key, keyLength);
+  ConcurrentHashNode* node =
+    _concurrenthashtable_new_node(hashTable, key, keyLength, hash, data);
+  pthread_mutex_t* lock = _concurrenthashtable_lock(hashTable, hash);
+  pthread_mutex_lock(lock);
+  ConcurrentHashBuckets* buckets = hashTable->buckets;
+  ConcurrentHashNode** link = &buckets->heads[hash & (buckets->count - 1)];
+  while (*link != NULL)
+  {
+    ConcurrentHashNode* current = *link;
+    if (_concurrenthashtable_match(hashTable, current, key, keyLength, hash))
+    {
+      // Modify: publish the new node in place of the old one
+      node->next = current->next;
+      __atomic_store_n(link, node, __ATOMIC_RELEASE);
+      pthread_mutex_unlock(lock);
+      _concurrenthashtable_retire(hashTable, &current->garbage);
+      return;
+    }
+    link = &current->next;
+  }
+  // New element, at bucket head
+  link = &buckets->heads[hash & (buckets->count - 1)];
+  node->next = *link;
+  __atomic_store_n(link, node, __ATOMIC_RELEASE);
+  UInt size = __atomic_add_fetch(&hashTable->size, 1, __ATOMIC_RELAXED);
+  size_t count = buckets->count;
+  pthread_mutex_unlock(lock);
+  if (size > count)
+    _concurrenthashtable_grow(hashTable);
+}
+
+bool concurrenthashtable_delete(ConcurrentHashTable* hashTable, void* key)
+{
+  size_t keyLength = _concurrenthashtable_key_length(hashTable, key);
+  UInt hash = _concurrenthashtable_hash(hashTable, key, keyLength);
+  pthread_mutex_t* lock = _concurrenthashtable_lock(hashTable, hash);
+  pthread_mutex_lock(lock);
+  ConcurrentHashBuckets* buckets = hashTable->buckets;
+  ConcurrentHashNode** link = &buckets->heads[hash & (buckets->count - 1)];
+  while (*link != NULL)
+  {
+    ConcurrentHashNode* current = *link;
+    if (_concurrenthashtable_match(hashTable, current, key, keyLength, hash))
+    {
+      // NOTE: current->next is left as is, for readers standing on current
+      __atomic_store_n(link, current->next, __ATOMIC_RELEASE);
+      __atomic_sub_fetch(&hashTable->size, 1, __ATOMIC_RELAXED);
+      pthread_mutex_unlock(lock);
+      _concurrenthashtable_retire(hashTable, &current->garbage);
+      return true;
+    }
+    link = &current->next;
+  }
+  pthread_mutex_unlock(lock);
+  return false;
+}
+
+void concurrenthashtable_clear(ConcurrentHashTable* hashTable)
+{
+  _concurrenthashtable_lock_all(hashTable);
+  _concurrenthashtable_rebuild(
+    hashTable, CONCURRENTHASHTABLE_MIN_SIZE, false);
+  __atomic_store_n(&hashTable->size, 0, __ATOMIC_RELAXED);
+  _concurrenthashtable_unlock_all(hashTable);
+}
+
+void concurrenthashtable_destroy(ConcurrentHashTable* hashTable)
+{
+  // NOTE: no reader left, everything can go at once
+  ConcurrentHashBuckets* buckets = hashTable->buckets;
+  for (size_t i = 0; i < buckets->count; i++)
+  {
+    ConcurrentHashNode* node = buckets->heads[i];
+    while (node != NULL)
+    {
+      ConcurrentHashNode* next = node->next;
+      allocator_free(hashTable->allocator, node, node->garbage.size);
+      node = next;
+    }
+  }
+  allocator_free(hashTable->allocator, buckets, buckets->garbage.size);
+  _concurrenthashtable_reclaim(hashTable, (UInt)-1);
+  for (int i = 0; i < CONCURRENTHASHTABLE_STRIPES; i++)
+    pthread_mutex_destroy(&hashTable->locks[i]);
+  pthread_mutex_destroy(&hashTable->garbageLock);
+  allocator_free(hashTable->allocator, hashTable, sizeof(ConcurrentHashTable));
+}
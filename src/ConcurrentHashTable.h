@@ -0,0 +1,212 @@
+/**
+ * @file ConcurrentHashTable.h
+ */
+
+#ifndef CGDS_CONCURRENT_HASH_TABLE_H
+#define CGDS_CONCURRENT_HASH_TABLE_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "cgds/safe_alloc.h"
+#include "cgds/Pool.h"
+#include "cgds/types.h"
+
+/**
+ * @brief Number of locks shared by the buckets (power of 2).
+ */
+#define CONCURRENTHASHTABLE_STRIPES 64
+
+/**
+ * @brief Header of blocks waiting for reclamation (nodes, buckets arrays).
+ */
+typedef struct ConcurrentHashGarbage {
+  struct ConcurrentHashGarbage* next; ///< Next retired block.
+  size_t size; ///< Size of the block, in bytes.
+  UInt epoch; ///< Global epoch when the block was retired.
+} ConcurrentHashGarbage;
+
+/**
+ * @brief Node of a bucket chain; never modified once published
+ * (except for its next pointer).
+ */
+typedef struct ConcurrentHashNode {
+  ConcurrentHashGarbage garbage; ///< Reclamation header.
+  struct ConcurrentHashNode* next; ///< Next node in the bucket.
+  UInt hash; ///< Full hash of the key.
+  size_t keyLength; ///< Length of the key (without final '\0' if string).
+  char data[] POOL_PAYLOAD; ///< Data, followed by the key.
+} ConcurrentHashNode;
+
+/**
+ * @brief Buckets array, replaced as a whole when resizing.
+ */
+typedef struct ConcurrentHashBuckets {
+  ConcurrentHashGarbage garbage; ///< Reclamation header.
+  size_t count; ///< Number of buckets (power of 2).
+  ConcurrentHashNode* heads[]; ///< First node of each bucket.
+} ConcurrentHashBuckets;
+
+/**
+ * @brief Generic dictionary string (or fixed-size key) --> any data,
+ * safe to share between threads.
+ *
+ * Lookups take no lock: they walk bucket chains under an epoch guard.
+ * Writers lock one of CONCURRENTHASHTABLE_STRIPES mutexes (chosen by key
+ * hash), and never modify a published node: an update publishes a new node
+ * in place of the old one. Unlinked nodes (and old buckets arrays after a
+ * resize) are retired, and freed once every thread which could still read
+ * them left its epoch guard (epoch-based reclamation).
+ * Lookups copy data out, so no pointer into the table escapes.
+ * NOTE: the allocator must be thread-safe (the default one is).
+ */
+typedef struct ConcurrentHashTable {
+  ConcurrentHashBuckets* buckets; ///< Current buckets (atomic pointer).
+  UInt size; ///< Count elements in the dictionary (atomic).
+  size_t dataSize; ///< Size of a dict element in bytes.
+  size_t keySize; ///< Size of a key in bytes (0 for strings).
+  UInt (*getHash)(void*, size_t); ///< Custom hash function (optional).
+  bool (*equal)(void*, void*); ///< Custom keys equality (optional).
+  Allocator* allocator; ///< Allocator of the struct, buckets and nodes.
+  pthread_mutex_t locks[CONCURRENTHASHTABLE_STRIPES]; ///< Writers locks.
+  pthread_mutex_t garbageLock; ///< Protects the retired blocks list.
+  ConcurrentHashGarbage* garbageHead; ///< Oldest retired block.
+  ConcurrentHashGarbage* garbageTail; ///< Newest retired block.
+  UInt garbageCount; ///< Number of retired blocks.
+} ConcurrentHashTable;
+
+/**
+ * @brief Return an allocated and initialized concurrent dictionary.
+ */
+ConcurrentHashTable* _concurrenthashtable_new(
+  size_t keySize, ///< Size in bytes of a key (0 for strings).
+  size_t dataSize, ///< Size in bytes of a dictionary element.
+  size_t hashSize, ///< Initial number of buckets (rounded to a power of 2).
+  UInt (*getHash)(void*, size_t), ///< Hash (key, keySize) (nullable).
+  bool (*equal)(void*, void*), ///< Keys equality (nullable).
+  Allocator* allocator ///< Memory allocator (NULL: default one).
+);
+
+/**
+ * @brief Return an allocated and initialized concurrent dictionary with
+ * string keys.
+ *
+ * Usage: ConcurrentHashTable* concurrenthashtable_new(<Type> type,
+ *                                                    UInt hash_size)
+ */
+#define concurrenthashtable_new(type, hsize) \
+  _concurrenthashtable_new(0, sizeof(type), hsize, NULL, NULL, NULL)
+
+/**
+ * @brief Return an allocated and initialized concurrent dictionary with
+ * string keys, using given (thread-safe) allocator.
+ */
+#define concurrenthashtable_new_with(type, hsize, allocator) \
+  _concurrenthashtable_new(0, sizeof(type), hsize, NULL, NULL, allocator)
+
+/**
+ * @brief Return an allocated and initialized concurrent dictionary with
+ * keys of type ktype, hashed and compared as bytes if getHash and equal are
+ * NULL. A concurrent set is obtained with an empty struct as element type.
+ *
+ * Usage: ConcurrentHashTable* concurrenthashtable_new_keyed(<Type> ktype,
+ *   <Type> type, UInt hash_size, UInt (*getHash)(void*, size_t),
+ *   bool (*equal)(void*, void*))
+ */
+#define concurrenthashtable_new_keyed(ktype, type, hsize, getHash, equal) \
+  _concurrenthashtable_new(sizeof(ktype), sizeof(type), hsize, getHash, \
+                           equal, NULL)
+
+/**
+ * @brief Check if the dictionary is empty.
+ */
+bool concurrenthashtable_empty(
+  ConcurrentHashTable* hashTable ///< "this" pointer.
+);
+
+/**
+ * @brief Return current size.
+ */
+UInt concurrenthashtable_size(
+  ConcurrentHashTable* hashTable ///< "this" pointer.
+);
+
+/**
+ * @brief Copy the element of given key into data (lock-free).
+ * @return true if the key was found.
+ */
+bool _concurrenthashtable_get(
+  ConcurrentHashTable* hashTable, ///< "this" pointer.
+  void* key, ///< Key (string, or pointer to key) of the element.
+  void* data ///< Destination of the element (may be NULL).
+);
+
+/**
+ * @brief Copy the element of given key into data (lock-free).
+ * @param hashTable "this" pointer.
+ * @param key Key of the element to retrieve.
+ * @param data 'out' variable to contain the result.
+ * @return true if the key was found.
+ *
+ * Usage: bool concurrenthashtable_get(ConcurrentHashTable* hashTable,
+ *                                     void* key, void data)
+ */
+#define concurrenthashtable_get(hashTable, key, data) \
+  _concurrenthashtable_get(hashTable, key, &(data))
+
+/**
+ * @brief Check if the dictionary contains given key (lock-free).
+ */
+bool concurrenthashtable_contains(
+  ConcurrentHashTable* hashTable, ///< "this" pointer.
+  void* key ///< Key (string, or pointer to key) to look for.
+);
+
+/**
+ * @brief Add or replace the entry (key, value).
+ */
+void _concurrenthashtable_set(
+  ConcurrentHashTable* hashTable, ///< "this" pointer.
+  void* key, ///< Key (string, or pointer to key) of the element to set.
+  void* data ///< Pointer to new data at given key.
+);
+
+/**
+ * @brief Add or replace the entry (key, value).
+ * @param hashTable "this" pointer.
+ * @param key Key of the element to add or modify.
+ * @param data New data at given key.
+ *
+ * Usage: void concurrenthashtable_set(ConcurrentHashTable* hashTable,
+ *                                     void* key, void data)
+ */
+#define concurrenthashtable_set(hashTable, key, data) \
+{ \
+  typeof(data) tmp = data; \
+  _concurrenthashtable_set(hashTable, key, &tmp); \
+}
+
+/**
+ * @brief Remove the given key (+ associated value).
+ * @return true if the key was found.
+ */
+bool concurrenthashtable_delete(
+  ConcurrentHashTable* hashTable, ///< "this" pointer.
+  void* key ///< Key (string, or pointer to key) of the element to delete.
+);
+
+/**
+ * @brief Remove all entries (concurrent lookups see the old or new state).
+ */
+void concurrenthashtable_clear(
+  ConcurrentHashTable* hashTable ///< "this" pointer.
+);
+
+/**
+ * @brief Destroy the dictionary; no other thread may still use it.
+ */
+void concurrenthashtable_destroy(
+  ConcurrentHashTable* hashTable ///< "this" pointer.
+);
+
+#endif
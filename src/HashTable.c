@@ -4,48 +4,189 @@
 
 #include "cgds/HashTable.h"
 
-void _hashtable_init(HashTable* hashTable, size_t dataSize, size_t hashSize)
+// Minimal number of slots
+#define HASHTABLE_MIN_SIZE 8
+
+// Size of chunks of long keys arena
+#define HASHTABLE_KEY_CHUNK_SIZE 4096
+
+// Allocate empty slots arrays of given size [internal usage]
+void _hashtable_alloc_slots(HashTable* hashTable, size_t hashSize)
 {
   hashTable->hashSize = hashSize;
+  hashTable->used = 0;
+  hashTable->slots =
+    allocator_alloc(hashTable->allocator, hashSize * sizeof(HashCell*));
+  memset(hashTable->slots, 0, hashSize * sizeof(HashCell*));
+  hashTable->meta = allocator_alloc(hashTable->allocator, hashSize);
+  memset(hashTable->meta, HASHTABLE_EMPTY, hashSize);
+}
+
+// Release slots arrays being rehashed [internal usage]
+void _hashtable_free_old_slots(HashTable* hashTable)
+{
+  allocator_free(hashTable->allocator, hashTable->oldSlots,
+                 hashTable->oldHashSize * sizeof(HashCell*));
+  allocator_free(
+    hashTable->allocator, hashTable->oldMeta, hashTable->oldHashSize);
+  hashTable->oldSlots = NULL;
+  hashTable->oldMeta = NULL;
+  hashTable->oldHashSize = 0;
+}
+
+// Release slots arrays [internal usage]
+void _hashtable_free_slots(HashTable* hashTable)
+{
+  allocator_free(hashTable->allocator, hashTable->slots,
+                 hashTable->hashSize * sizeof(HashCell*));
+  allocator_free(hashTable->allocator, hashTable->meta, hashTable->hashSize);
+  if (hashTable->oldSlots != NULL)
+    _hashtable_free_old_slots(hashTable);
+}
+
+void _hashtable_init_keyed(HashTable* hashTable, size_t keySize,
+                           size_t dataSize, size_t hashSize,
+                           UInt (*getHash)(void*, size_t),
+                           bool (*equal)(void*, void*), Allocator* allocator)
+{
   hashTable->dataSize = dataSize;
-  hashTable->head = safe_malloc(hashSize * sizeof(HashCell*));
-  for (UInt i = 0; i < hashSize; i++)
-    hashTable->head[i] = NULL;
+  hashTable->keySize = keySize;
+  hashTable->getHash = getHash; //may be NULL
+  hashTable->equal = equal; //may be NULL
+  hashTable->allocator = allocator_or_default(allocator);
+  // Fixed-size (or short string) keys are stored in the cell, after data
+  pool_init(&hashTable->cellPool,
+            sizeof(HashCell) + pool_align(dataSize) +
+              (keySize > 0 ? keySize : HASHTABLE_INLINE_KEY),
+            hashTable->allocator);
+  arena_init_with(
+    &hashTable->keyArena, HASHTABLE_KEY_CHUNK_SIZE, hashTable->allocator);
+  hashTable->deadKeyBytes = 0;
+  size_t slotsCount = HASHTABLE_MIN_SIZE;
+  while (slotsCount < hashSize)
+    slotsCount <<= 1;
+  _hashtable_alloc_slots(hashTable, slotsCount);
+  hashTable->oldSlots = NULL;
+  hashTable->oldMeta = NULL;
+  hashTable->oldHashSize = 0;
+  hashTable->rehashIndex = 0;
   hashTable->size = 0;
+  hashTable->filter = NULL;
 }
 
-HashTable* _hashtable_new(size_t dataSize, size_t hashSize)
+void _hashtable_init(HashTable* hashTable, size_t dataSize, size_t hashSize,
+                     Allocator* allocator)
 {
-  HashTable* hashTable = (HashTable*) safe_malloc(sizeof(HashTable));
-  _hashtable_init(hashTable, dataSize, hashSize);
+  _hashtable_init_keyed(
+    hashTable, 0, dataSize, hashSize, NULL, NULL, allocator);
+}
+
+HashTable* _hashtable_new_keyed(size_t keySize, size_t dataSize,
+                                size_t hashSize,
+                                UInt (*getHash)(void*, size_t),
+                                bool (*equal)(void*, void*),
+                                Allocator* allocator)
+{
+  allocator = allocator_or_default(allocator);
+  HashTable* hashTable =
+    (HashTable*) allocator_alloc(allocator, sizeof(HashTable));
+  _hashtable_init_keyed(
+    hashTable, keySize, dataSize, hashSize, getHash, equal, allocator);
   return hashTable;
 }
 
+HashTable* _hashtable_new(size_t dataSize, size_t hashSize,
+                          Allocator* allocator)
+{
+  return _hashtable_new_keyed(0, dataSize, hashSize, NULL, NULL, allocator);
+}
+
+// Get a cell from the pool, holding copies of key and data [internal usage]
+HashCell* _hashtable_new_cell(HashTable* hashTable, void* key,
+                              size_t keyLength, UInt hash, void* data)
+{
+  HashCell* cell = (HashCell*) pool_alloc(&hashTable->cellPool);
+  if (hashTable->keySize > 0)
+  {
+    cell->key = cell->data + pool_align(hashTable->dataSize);
+    memcpy(cell->key, key, keyLength);
+  }
+  else
+  {
+    if (keyLength < HASHTABLE_INLINE_KEY)
+      cell->key = cell->data + pool_align(hashTable->dataSize);
+    else
+      cell->key = (char*) arena_alloc(&hashTable->keyArena, keyLength + 1);
+    memcpy(cell->key, key, keyLength + 1);
+  }
+  cell->keyLength = keyLength;
+  cell->hash = hash;
+  memcpy(cell->data, data, hashTable->dataSize);
+  return cell;
+}
+
+// Give a cell back to the pool; a long key just becomes dead [internal usage]
+void _hashtable_free_cell(HashTable* hashTable, HashCell* cell)
+{
+  if (hashTable->keySize == 0 && cell->keyLength >= HASHTABLE_INLINE_KEY)
+    hashTable->deadKeyBytes += cell->keyLength + 1;
+  pool_free(&hashTable->cellPool, cell);
+}
+
+// Move long keys of cells in slots to the keys arena [internal usage]
+void _hashtable_move_keys(
+  HashTable* hashTable, HashCell** slots, size_t hashSize)
+{
+  for (UInt i = 0; i < hashSize; i++)
+  {
+    HashCell* cell = slots[i];
+    if (cell != NULL && cell->keyLength >= HASHTABLE_INLINE_KEY)
+    {
+      char* key = (char*) arena_alloc(
+        &hashTable->keyArena, cell->keyLength + 1);
+      memcpy(key, cell->key, cell->keyLength + 1);
+      cell->key = key;
+    }
+  }
+}
+
+// Copy live long keys into a new arena, drop the old one [internal usage]
+void _hashtable_compact_keys(HashTable* hashTable)
+{
+  Arena oldArena = hashTable->keyArena;
+  arena_init_with(
+    &hashTable->keyArena, HASHTABLE_KEY_CHUNK_SIZE, hashTable->allocator);
+  _hashtable_move_keys(hashTable, hashTable->slots, hashTable->hashSize);
+  if (hashTable->oldSlots != NULL)
+  {
+    _hashtable_move_keys(
+      hashTable, hashTable->oldSlots, hashTable->oldHashSize);
+  }
+  arena_release(&oldArena);
+  hashTable->deadKeyBytes = 0;
+}
+
 HashTable* hashtable_copy(HashTable* hashTable)
 {
-  HashTable* hashTableCopy =
-    _hashtable_new(hashTable->dataSize, hashTable->hashSize);
-  hashTableCopy->size = hashTable->size;
+  hashtable_rehash_step(hashTable, hashTable->oldHashSize);
+  HashTable* hashTableCopy = _hashtable_new_keyed(
+    hashTable->keySize, hashTable->dataSize, hashTable->hashSize,
+    hashTable->getHash, hashTable->equal, hashTable->allocator);
+  // Same slots count: cells copies go to the same slots
   for (UInt i = 0; i < hashTable->hashSize; i++)
   {
-    HashCell *cell = hashTable->head[i],
-             *cellCopy = hashTableCopy->head[i],
-             *prev = NULL;
-    while (cell != NULL)
+    HashCell* cell = hashTable->slots[i];
+    if (cell != NULL)
     {
-      // cellCopy == NULL (from empty list)
-      cellCopy = (HashCell*) safe_malloc(sizeof(HashCell));
-      cellCopy->key = (char*) safe_malloc(strlen(cell->key) + 1);
-      strcpy(cellCopy->key, cell->key);
-      cellCopy->data = safe_malloc(hashTable->dataSize);
-      memcpy(cellCopy->data, cell->data, hashTable->dataSize);
-      if (prev == NULL) hashTableCopy->head[i] = cellCopy;
-      else prev->next = cellCopy;
-      prev = cellCopy;
-      cell = cell->next;
+      hashTableCopy->slots[i] = _hashtable_new_cell(
+        hashTableCopy, cell->key, cell->keyLength, cell->hash, cell->data);
     }
-    if (cellCopy != NULL) cellCopy->next = NULL;
   }
+  memcpy(hashTableCopy->meta, hashTable->meta, hashTable->hashSize);
+  hashTableCopy->size = hashTable->size;
+  hashTableCopy->used = hashTable->used;
+  if (hashTable->filter != NULL)
+    hashTableCopy->filter = bloomfilter_copy(hashTable->filter);
   return hashTableCopy;
 }
 
@@ -59,104 +200,536 @@ UInt hashtable_size(HashTable* hashTable)
   return hashTable->size;
 }
 
-// Function (string) key --> (integer) hash [internal usage]
-UInt _compute_hash(char* key, size_t hashSize)
+// Hash function constants (from wyhash, public domain)
+static const uint64_t HASHTABLE_SECRET[4] = {
+  0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL,
+  0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL
+};
+
+// 64x64 -> 128 bits multiplication, folded to 64 bits [internal usage]
+uint64_t _hashtable_mix(uint64_t a, uint64_t b)
+{
+  __uint128_t product = (__uint128_t)a * b;
+  return (uint64_t)product ^ (uint64_t)(product >> 64);
+}
+
+// Unaligned reads [internal usage]
+uint64_t _hashtable_read8(const unsigned char* p)
 {
-  UInt res = 0;
-  for (unsigned char* s = key; *s != '\0'; s++)
-    // NOTE: '31' from here https://stackoverflow.com/a/4384446
-    res = (*s + 31 * res) % hashSize;
-  return res;
+  uint64_t v;
+  memcpy(&v, p, 8);
+  return v;
 }
 
-void* _hashtable_get(HashTable* hashTable, char* key)
+uint64_t _hashtable_read4(const unsigned char* p)
 {
-  UInt hashIdx = _compute_hash(key, hashTable->hashSize);
-  HashCell* cell = hashTable->head[hashIdx];
-  while (cell != NULL)
+  uint32_t v;
+  memcpy(&v, p, 4);
+  return v;
+}
+
+// Function (bytes) key --> (integer) hash, following wyhash [internal usage]
+// NOTE: long keys are consumed 48 bytes at a time, by 3 independent
+// multiply chains which the CPU runs in parallel.
+UInt _compute_hash(const void* key, size_t length)
+{
+  const unsigned char* p = (const unsigned char*)key;
+  const uint64_t* s = HASHTABLE_SECRET;
+  uint64_t seed = _hashtable_mix(s[0], s[1]), a, b;
+  if (length <= 16)
   {
-    if (strcmp(cell->key, key) == 0)
-      return cell->data;
-    cell = cell->next;
+    if (length >= 4)
+    {
+      size_t shift = (length >> 3) << 2;
+      a = (_hashtable_read4(p) << 32) | _hashtable_read4(p + shift);
+      b = (_hashtable_read4(p + length - 4) << 32) |
+          _hashtable_read4(p + length - 4 - shift);
+    }
+    else if (length > 0)
+    {
+      a = ((uint64_t)p[0] << 16) | ((uint64_t)p[length >> 1] << 8) |
+          p[length - 1];
+      b = 0;
+    }
+    else
+      a = b = 0;
   }
-  return NULL;
+  else
+  {
+    size_t i = length;
+    if (i > 48)
+    {
+      uint64_t seed1 = seed, seed2 = seed;
+      do
+      {
+        seed = _hashtable_mix(
+          _hashtable_read8(p) ^ s[1], _hashtable_read8(p + 8) ^ seed);
+        seed1 = _hashtable_mix(
+          _hashtable_read8(p + 16) ^ s[2], _hashtable_read8(p + 24) ^ seed1);
+        seed2 = _hashtable_mix(
+          _hashtable_read8(p + 32) ^ s[3], _hashtable_read8(p + 40) ^ seed2);
+        p += 48;
+        i -= 48;
+      }
+      while (i > 48);
+      seed ^= seed1 ^ seed2;
+    }
+    while (i > 16)
+    {
+      seed = _hashtable_mix(
+        _hashtable_read8(p) ^ s[1], _hashtable_read8(p + 8) ^ seed);
+      p += 16;
+      i -= 16;
+    }
+    a = _hashtable_read8(p + i - 16);
+    b = _hashtable_read8(p + i - 8);
+  }
+  __uint128_t product = (__uint128_t)(a ^ s[1]) * (b ^ seed);
+  return _hashtable_mix(
+    (uint64_t)product ^ s[0] ^ length, (uint64_t)(product >> 64) ^ s[1]);
+}
+
+// Control byte of a full slot: 7 upper bits of the hash [internal usage]
+uint8_t _hashtable_tag(UInt hash)
+{
+  return (uint8_t)(hash >> 57);
+}
+
+// Length of a key: string length, or fixed size [internal usage]
+size_t _hashtable_key_length(HashTable* hashTable, void* key)
+{
+  if (hashTable->keySize > 0)
+    return hashTable->keySize;
+  return strlen((char*)key);
+}
+
+// Hash of a key of given length [internal usage]
+UInt _hashtable_hash(HashTable* hashTable, void* key, size_t keyLength)
+{
+  if (hashTable->getHash != NULL)
+    return hashTable->getHash(key, keyLength);
+  return _compute_hash(key, keyLength);
 }
 
-void _hashtable_set(HashTable* hashTable, char* key, void* data)
+// Index of the slot holding key in given slots arrays, or hashSize if
+// absent [internal usage]
+UInt _hashtable_find_in(HashTable* hashTable, HashCell** slots, uint8_t* meta,
+                        size_t hashSize, void* key, size_t keyLength,
+                        UInt hash)
 {
-  UInt hashIdx = _compute_hash(key, hashTable->hashSize);
-  HashCell *cell = hashTable->head[hashIdx],
-           *prev = NULL;
-  while (cell != NULL)
+  UInt mask = hashSize - 1,
+       i = hash & mask;
+  uint8_t tag = _hashtable_tag(hash);
+  // NOTE: load factor < 1, so an empty slot ends the probe sequence
+  while (meta[i] != HASHTABLE_EMPTY)
   {
-    if (strcmp(cell->key, key) == 0)
+    if (meta[i] == tag)
     {
-      // Modify:
-      memcpy(cell->data, data, hashTable->dataSize);
-      return;
+      HashCell* cell = slots[i];
+      if (
+        cell->hash == hash &&
+        cell->keyLength == keyLength &&
+        (hashTable->equal != NULL
+          ? hashTable->equal(cell->key, key)
+          : memcmp(cell->key, key, keyLength) == 0)
+      ) {
+        return i;
+      }
     }
-    prev = cell;
-    cell = cell->next;
-  }
-  // New element: insert after prev (which may be NULL)
-  HashCell* newCell = (HashCell*) safe_malloc(sizeof(HashCell));
-  newCell->key = (char*) safe_malloc(strlen(key) + 1);
-  strcpy(newCell->key, key);
-  newCell->data = safe_malloc(hashTable->dataSize);
-  memcpy(newCell->data, data, hashTable->dataSize);
-  newCell->next = NULL;
-  if (prev == NULL)
-    hashTable->head[hashIdx] = newCell;
-  else
-    prev->next = newCell;
-  hashTable->size++;
+    i = (i + 1) & mask;
+  }
+  return hashSize;
+}
+
+// Index of the slot holding key, or hashSize if absent [internal usage]
+UInt _hashtable_find(
+  HashTable* hashTable, void* key, size_t keyLength, UInt hash)
+{
+  return _hashtable_find_in(hashTable, hashTable->slots, hashTable->meta,
+                            hashTable->hashSize, key, keyLength, hash);
+}
+
+// Index of the old slot holding key, or oldHashSize if absent (or not
+// rehashing) [internal usage]
+UInt _hashtable_find_old(
+  HashTable* hashTable, void* key, size_t keyLength, UInt hash)
+{
+  if (hashTable->oldSlots == NULL)
+    return hashTable->oldHashSize;
+  return _hashtable_find_in(hashTable, hashTable->oldSlots,
+                            hashTable->oldMeta, hashTable->oldHashSize,
+                            key, keyLength, hash);
 }
 
-void hashtable_delete(HashTable* hashTable, char* key)
+// Tell if the filter proves the key of given hash absent [internal usage]
+bool _hashtable_filter_rejects(HashTable* hashTable, UInt hash)
 {
-  UInt hashIdx = _compute_hash(key, hashTable->hashSize);
-  HashCell *cell = hashTable->head[hashIdx],
-           *prev = NULL;
-  while (cell != NULL)
+  return (hashTable->filter != NULL &&
+          !bloomfilter_has_hash(hashTable->filter, hash));
+}
+
+// Add the hashes of cells in slots to the filter [internal usage]
+void _hashtable_fill_filter(
+  HashTable* hashTable, HashCell** slots, size_t hashSize)
+{
+  for (UInt i = 0; i < hashSize; i++)
   {
-    if (strcmp(cell->key, key) == 0)
+    if (slots[i] != NULL)
+      bloomfilter_add_hash(hashTable->filter, slots[i]->hash);
+  }
+}
+
+// (Re)build the filter from all cells, with room for as many new keys
+// [internal usage]
+void _hashtable_build_filter(HashTable* hashTable, Real falsePositiveRate)
+{
+  if (hashTable->filter != NULL)
+    bloomfilter_destroy(hashTable->filter);
+  UInt capacity = 2 * hashTable->size;
+  if (capacity < HASHTABLE_MIN_SIZE)
+    capacity = HASHTABLE_MIN_SIZE;
+  hashTable->filter =
+    _bloomfilter_new(capacity, falsePositiveRate, hashTable->allocator);
+  _hashtable_fill_filter(hashTable, hashTable->slots, hashTable->hashSize);
+  if (hashTable->oldSlots != NULL)
+  {
+    _hashtable_fill_filter(
+      hashTable, hashTable->oldSlots, hashTable->oldHashSize);
+  }
+}
+
+// Put a cell in the first free slot of its probe sequence [internal usage]
+void _hashtable_place(HashTable* hashTable, HashCell* cell, UInt hash)
+{
+  UInt mask = hashTable->hashSize - 1,
+       i = hash & mask;
+  while (hashTable->slots[i] != NULL)
+    i = (i + 1) & mask;
+  if (hashTable->meta[i] == HASHTABLE_EMPTY)
+    hashTable->used++;
+  hashTable->slots[i] = cell;
+  hashTable->meta[i] = _hashtable_tag(hash);
+}
+
+bool hashtable_rehash_step(HashTable* hashTable, UInt count)
+{
+  if (hashTable->oldSlots == NULL)
+    return false;
+  UInt end = hashTable->rehashIndex + count;
+  if (end > hashTable->oldHashSize || end < hashTable->rehashIndex)
+    end = hashTable->oldHashSize;
+  for (UInt i = hashTable->rehashIndex; i < end; i++)
+  {
+    HashCell* cell = hashTable->oldSlots[i];
+    if (cell != NULL)
     {
-      if (prev == NULL)
-        hashTable->head[hashIdx] = cell->next;
-      else
-        prev->next = cell->next;
-      safe_free(cell->key);
-      safe_free(cell->data);
-      safe_free(cell);
-      hashTable->size--;
-      break;
+      _hashtable_place(hashTable, cell, cell->hash);
+      // NOTE: a tombstone keeps old probe sequences going through slot i
+      hashTable->oldSlots[i] = NULL;
+      hashTable->oldMeta[i] = HASHTABLE_DELETED;
     }
-    prev = cell;
-    cell = cell->next;
   }
+  hashTable->rehashIndex = end;
+  if (end < hashTable->oldHashSize)
+    return true;
+  _hashtable_free_old_slots(hashTable);
+  // Reclaim long keys space if mostly dead
+  if (hashTable->deadKeyBytes * 2 > arena_used(&hashTable->keyArena))
+    _hashtable_compact_keys(hashTable);
+  return false;
 }
 
-void hashtable_clear(HashTable* hashTable)
+// Start moving all cells into new slots arrays (tombstones vanish), after
+// completing a rehash in progress [internal usage]
+void _hashtable_rehash(HashTable* hashTable, size_t newHashSize)
 {
-  for (UInt i = 0; i < hashTable->hashSize; i++)
+  hashtable_rehash_step(hashTable, hashTable->oldHashSize);
+  hashTable->oldSlots = hashTable->slots;
+  hashTable->oldMeta = hashTable->meta;
+  hashTable->oldHashSize = hashTable->hashSize;
+  hashTable->rehashIndex = 0;
+  _hashtable_alloc_slots(hashTable, newHashSize);
+  hashtable_rehash_step(hashTable, HASHTABLE_REHASH_STEP);
+}
+
+void* _hashtable_get(HashTable* hashTable, void* key)
+{
+  hashtable_rehash_step(hashTable, HASHTABLE_REHASH_STEP);
+  size_t keyLength = _hashtable_key_length(hashTable, key);
+  UInt hash = _hashtable_hash(hashTable, key, keyLength);
+  if (_hashtable_filter_rejects(hashTable, hash))
+    return NULL;
+  UInt i = _hashtable_find(hashTable, key, keyLength, hash);
+  if (i < hashTable->hashSize)
+    return hashTable->slots[i]->data;
+  i = _hashtable_find_old(hashTable, key, keyLength, hash);
+  if (i < hashTable->oldHashSize)
+    return hashTable->oldSlots[i]->data;
+  return NULL;
+}
+
+// Number of lookups in flight in hashtable_get_batch()
+#define HASHTABLE_BATCH_SIZE 16
+
+void hashtable_get_batch(HashTable* hashTable, void* keys, UInt n, void** out)
+{
+  hashtable_rehash_step(hashTable, HASHTABLE_REHASH_STEP);
+  void* batchKeys[HASHTABLE_BATCH_SIZE];
+  size_t lengths[HASHTABLE_BATCH_SIZE];
+  UInt hashes[HASHTABLE_BATCH_SIZE];
+  bool rejected[HASHTABLE_BATCH_SIZE];
+  UInt mask = hashTable->hashSize - 1;
+  for (UInt start = 0; start < n; start += HASHTABLE_BATCH_SIZE)
   {
-    HashCell* cell = hashTable->head[i];
-    while (cell != NULL)
+    UInt count = (n - start < HASHTABLE_BATCH_SIZE
+      ? n - start : HASHTABLE_BATCH_SIZE);
+    // Stage 1: hash keys, prefetch their first slots
+    for (UInt j = 0; j < count; j++)
+    {
+      batchKeys[j] = (hashTable->keySize > 0
+        ? (char*)keys + (start + j) * hashTable->keySize
+        : ((char**)keys)[start + j]);
+      lengths[j] = _hashtable_key_length(hashTable, batchKeys[j]);
+      hashes[j] = _hashtable_hash(hashTable, batchKeys[j], lengths[j]);
+      rejected[j] = _hashtable_filter_rejects(hashTable, hashes[j]);
+      if (rejected[j])
+        continue;
+      __builtin_prefetch(&hashTable->meta[hashes[j] & mask]);
+      __builtin_prefetch(&hashTable->slots[hashes[j] & mask]);
+    }
+    // Stage 2: prefetch cells of slots with matching tags
+    for (UInt j = 0; j < count; j++)
+    {
+      UInt i = hashes[j] & mask;
+      if (!rejected[j] && hashTable->meta[i] == _hashtable_tag(hashes[j]))
+        __builtin_prefetch(hashTable->slots[i]);
+    }
+    // Stage 3: resolve lookups (data mostly in cache now)
+    for (UInt j = 0; j < count; j++)
     {
-      HashCell* next = cell->next;
-      safe_free(cell->key);
-      safe_free(cell->data);
-      safe_free(cell);
-      cell = next;
+      if (rejected[j])
+      {
+        out[start + j] = NULL;
+        continue;
+      }
+      UInt i = _hashtable_find(hashTable, batchKeys[j], lengths[j], hashes[j]);
+      if (i < hashTable->hashSize)
+      {
+        out[start + j] = hashTable->slots[i]->data;
+        continue;
+      }
+      i = _hashtable_find_old(hashTable, batchKeys[j], lengths[j], hashes[j]);
+      out[start + j] = (i < hashTable->oldHashSize
+        ? hashTable->oldSlots[i]->data : NULL);
     }
-    hashTable->head[i] = NULL;
   }
+}
+
+void _hashtable_set(HashTable* hashTable, void* key, void* data)
+{
+  hashtable_rehash_step(hashTable, HASHTABLE_REHASH_STEP);
+  size_t keyLength = _hashtable_key_length(hashTable, key);
+  UInt hash = _hashtable_hash(hashTable, key, keyLength);
+  if (!_hashtable_filter_rejects(hashTable, hash))
+  {
+    UInt i = _hashtable_find(hashTable, key, keyLength, hash);
+    if (i < hashTable->hashSize)
+    {
+      // Modify:
+      memcpy(hashTable->slots[i]->data, data, hashTable->dataSize);
+      return;
+    }
+    i = _hashtable_find_old(hashTable, key, keyLength, hash);
+    if (i < hashTable->oldHashSize)
+    {
+      // Modify (not migrated yet):
+      memcpy(hashTable->oldSlots[i]->data, data, hashTable->dataSize);
+      return;
+    }
+  }
+  // New element: keep load factor (with tombstones) under 3/4
+  if ((hashTable->used + 1) * 4 > hashTable->hashSize * 3)
+  {
+    // Grow if really full, otherwise just clean tombstones
+    size_t newHashSize = hashTable->hashSize;
+    if ((hashTable->size + 1) * 2 > newHashSize)
+      newHashSize *= 2;
+    _hashtable_rehash(hashTable, newHashSize);
+  }
+  HashCell* cell = _hashtable_new_cell(hashTable, key, keyLength, hash, data);
+  _hashtable_place(hashTable, cell, hash);
+  hashTable->size++;
+  if (hashTable->filter != NULL)
+  {
+    bloomfilter_add_hash(hashTable->filter, hash);
+    if (hashTable->filter->size > hashTable->filter->capacity)
+    {
+      _hashtable_build_filter(
+        hashTable, hashTable->filter->falsePositiveRate);
+    }
+  }
+}
+
+void hashtable_delete(HashTable* hashTable, void* key)
+{
+  hashtable_rehash_step(hashTable, HASHTABLE_REHASH_STEP);
+  size_t keyLength = _hashtable_key_length(hashTable, key);
+  UInt hash = _hashtable_hash(hashTable, key, keyLength);
+  if (_hashtable_filter_rejects(hashTable, hash))
+    return;
+  UInt i = _hashtable_find(hashTable, key, keyLength, hash);
+  if (i == hashTable->hashSize)
+  {
+    i = _hashtable_find_old(hashTable, key, keyLength, hash);
+    if (i == hashTable->oldHashSize)
+      return;
+    // Not migrated yet: old slots just get a tombstone
+    _hashtable_free_cell(hashTable, hashTable->oldSlots[i]);
+    hashTable->oldSlots[i] = NULL;
+    hashTable->oldMeta[i] = HASHTABLE_DELETED;
+    hashTable->size--;
+    return;
+  }
+  _hashtable_free_cell(hashTable, hashTable->slots[i]);
+  hashTable->slots[i] = NULL;
+  UInt next = (i + 1) & (hashTable->hashSize - 1);
+  if (hashTable->meta[next] == HASHTABLE_EMPTY)
+  {
+    // No probe sequence goes through this slot: it can be freed
+    hashTable->meta[i] = HASHTABLE_EMPTY;
+    hashTable->used--;
+  }
+  else
+    hashTable->meta[i] = HASHTABLE_DELETED;
+  hashTable->size--;
+  // Reclaim long keys space if mostly dead (and worth a slots walk)
+  if (
+    hashTable->deadKeyBytes * 2 > arena_used(&hashTable->keyArena) &&
+    hashTable->deadKeyBytes >= hashTable->hashSize
+  ) {
+    _hashtable_compact_keys(hashTable);
+  }
+}
+
+void hashtable_attach_filter(HashTable* hashTable, Real falsePositiveRate)
+{
+  _hashtable_build_filter(hashTable, falsePositiveRate);
+}
+
+void hashtable_detach_filter(HashTable* hashTable)
+{
+  if (hashTable->filter != NULL)
+    bloomfilter_destroy(hashTable->filter);
+  hashTable->filter = NULL;
+}
+
+void hashtable_clear(HashTable* hashTable)
+{
+  // NOTE: cells and keys are in the pool or keys arena: no walk needed
+  pool_release(&hashTable->cellPool);
+  arena_release(&hashTable->keyArena);
+  hashTable->deadKeyBytes = 0;
+  if (hashTable->oldSlots != NULL)
+    _hashtable_free_old_slots(hashTable);
+  memset(hashTable->slots, 0, hashTable->hashSize * sizeof(HashCell*));
+  memset(hashTable->meta, HASHTABLE_EMPTY, hashTable->hashSize);
   hashTable->size = 0;
+  hashTable->used = 0;
+  if (hashTable->filter != NULL)
+    bloomfilter_clear(hashTable->filter);
 }
 
 void hashtable_destroy(HashTable* hashTable)
 {
+  hashtable_detach_filter(hashTable);
   hashtable_clear(hashTable);
-  safe_free(hashTable->head);
-  safe_free(hashTable);
+  _hashtable_free_slots(hashTable);
+  allocator_free(hashTable->allocator, hashTable, sizeof(HashTable));
+}
+
+////////////////////
+// Iterator logic //
+////////////////////
+
+HashTableIterator* hashtable_get_range_iterator(
+  HashTable* hashTable, UInt begin, UInt end)
+{
+  // NOTE: all entries must be in current slots
+  hashtable_rehash_step(hashTable, hashTable->oldHashSize);
+  HashTableIterator* hashtableI = (HashTableIterator*)
+    allocator_alloc(hashTable->allocator, sizeof(HashTableIterator));
+  hashtableI->hashTable = hashTable;
+  hashtableI->allocator = hashTable->allocator;
+  hashtableI->end = (end < hashTable->hashSize ? end : hashTable->hashSize);
+  hashtableI->begin = (begin < hashtableI->end ? begin : hashtableI->end);
+  hashtableI_reset_begin(hashtableI);
+  return hashtableI;
+}
+
+HashTableIterator* hashtable_get_iterator(HashTable* hashTable)
+{
+  return hashtable_get_range_iterator(hashTable, 0, hashTable->hashSize);
+}
+
+// First full slot from given one, or end of range [internal usage]
+UInt _hashtableI_skip(HashTableIterator* hashtableI, UInt slot)
+{
+  // NOTE: only control bytes are read (full slots have bit 7 unset)
+  uint8_t* meta = hashtableI->hashTable->meta;
+  while (slot < hashtableI->end && (meta[slot] & HASHTABLE_EMPTY))
+    slot++;
+  return slot;
+}
+
+void hashtableI_reset_begin(HashTableIterator* hashtableI)
+{
+  hashtableI->current = _hashtableI_skip(hashtableI, hashtableI->begin);
+}
+
+bool hashtableI_has_data(HashTableIterator* hashtableI)
+{
+  return (hashtableI->current < hashtableI->end);
+}
+
+void* hashtableI_get_key(HashTableIterator* hashtableI)
+{
+  return hashtableI->hashTable->slots[hashtableI->current]->key;
+}
+
+void* _hashtableI_get(HashTableIterator* hashtableI)
+{
+  return hashtableI->hashTable->slots[hashtableI->current]->data;
+}
+
+void _hashtableI_set(HashTableIterator* hashtableI, void* data)
+{
+  memcpy(hashtableI->hashTable->slots[hashtableI->current]->data, data,
+         hashtableI->hashTable->dataSize);
+}
+
+void hashtableI_move_next(HashTableIterator* hashtableI)
+{
+  hashtableI->current = _hashtableI_skip(hashtableI, hashtableI->current + 1);
+}
+
+UInt hashtableI_next_chunk(
+  HashTableIterator* hashtableI, HashCell** cells, UInt maxCount)
+{
+  HashCell** slots = hashtableI->hashTable->slots;
+  UInt count = 0;
+  while (count < maxCount && hashtableI->current < hashtableI->end)
+  {
+    HashCell* cell = slots[hashtableI->current];
+    // Cells are read by the caller next: start loading them now
+    __builtin_prefetch(cell);
+    cells[count++] = cell;
+    hashtableI_move_next(hashtableI);
+  }
+  return count;
+}
+
+void hashtableI_destroy(HashTableIterator* hashtableI)
+{
+  allocator_free(
+    hashtableI->allocator, hashtableI, sizeof(HashTableIterator));
 }
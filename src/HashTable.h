@@ -8,25 +8,90 @@
 #include <stdlib.h>
 #include <string.h>
 #include "cgds/safe_alloc.h"
+#include "cgds/Arena.h"
+#include "cgds/BloomFilter.h"
+#include "cgds/Pool.h"
 #include "cgds/types.h"
 
 /**
  * @brief Cell of a dictionary.
  */
 typedef struct HashCell {
-  char* key; ///< Key (as a string).
-  void* data; ///< Generic data contained in this cell.
-  struct HashCell* next; ///< Pointer to next cell in the list.
+  char* key; ///< Key (stored after data, or in the keys arena if long).
+  UInt hash; ///< Full hash of the key.
+  size_t keyLength; ///< Length of the key (without final '\0' if string).
+  char data[] POOL_PAYLOAD; ///< Generic data contained in this cell.
 } HashCell;
 
 /**
- * @brief Generic dictionary string --> any data.
+ * @brief String keys shorter than this (with final '\0') are stored in the
+ * cell, after data; longer ones go to the keys arena.
+ */
+#define HASHTABLE_INLINE_KEY 24
+
+/**
+ * @brief Number of old slots migrated by each operation while rehashing.
+ */
+#define HASHTABLE_REHASH_STEP 64
+
+/**
+ * @brief Control byte of an empty slot.
+ */
+#define HASHTABLE_EMPTY 0x80
+
+/**
+ * @brief Control byte of a deleted slot (tombstone).
+ */
+#define HASHTABLE_DELETED 0xFE
+
+/**
+ * @brief Generic dictionary string (or fixed-size key) --> any data.
+ *
+ * Keys are NUL-terminated strings by default: short ones are copied into
+ * the cells, longer ones appended to an arena (space of deleted long keys is
+ * reclaimed once they fill half of the arena). With keySize > 0, keys are
+ * blocks of keySize bytes (integers, structs...), copied into the cells and
+ * hashed/compared as bytes, or with custom getHash/equal functions.
+ * NOTE: comparing struct keys as bytes includes padding: zero them first,
+ * or provide an equal function.
+ *
+ * Open addressing with linear probing over a power-of-two slots array.
+ * Each slot has a control byte: empty, deleted, or the 7 upper bits of the
+ * key hash, so that most mismatches are rejected without reading the cell;
+ * then full hashes and lengths are compared before key bytes.
+ * Slots are rehashed into a twice larger array when the load factor
+ * (including tombstones) would exceed 3/4. Rehashing is incremental: both
+ * arrays coexist, and each get/set/delete moves the cells of a bounded
+ * number of old slots (HASHTABLE_REHASH_STEP), so that no operation pays
+ * for a whole table rehash. Cells stay in place: pointers returned by
+ * _hashtable_get() remain valid until the key is deleted.
+ * NOTE: lookups (get, get_batch) and iterator creation thus write to the
+ * dictionary while a rehash is pending (oldSlots != NULL): concurrent
+ * readers must first complete it, with
+ * hashtable_rehash_step(hashTable, hashTable->oldHashSize). Then they only
+ * read, until the next set or delete.
+ * An optional Bloom filter of the key hashes (see hashtable_attach_filter())
+ * rejects most absent keys before any slot or cell is read.
  */
 typedef struct HashTable {
   UInt size; ///< Count elements in the dictionary.
   size_t dataSize; ///< Size of a dict cell element in bytes.
-  size_t hashSize; ///< (Maximum) Number of stored hash keys.
-  HashCell** head; ///< Pointers to the first cell in a list.
+  size_t keySize; ///< Size of a key in bytes (0 for strings).
+  UInt (*getHash)(void*, size_t); ///< Custom hash function (optional).
+  bool (*equal)(void*, void*); ///< Custom keys equality (optional).
+  size_t hashSize; ///< Number of slots (power of 2).
+  UInt used; ///< Count slots full or deleted.
+  HashCell** slots; ///< Pointers to cells (NULL for empty slots).
+  uint8_t* meta; ///< Control byte of each slot.
+  HashCell** oldSlots; ///< Slots being rehashed (NULL if not rehashing).
+  uint8_t* oldMeta; ///< Control bytes of slots being rehashed.
+  size_t oldHashSize; ///< Number of slots being rehashed.
+  UInt rehashIndex; ///< Next old slot to migrate.
+  Allocator* allocator; ///< Allocator of the struct, arrays and chunks.
+  Pool cellPool; ///< Pool of cells (with their data and short keys).
+  Arena keyArena; ///< Append-only storage of long string keys.
+  size_t deadKeyBytes; ///< Size of deleted keys still in keyArena.
+  BloomFilter* filter; ///< Filter of absent keys (NULL if not attached).
 } HashTable;
 
 /**
@@ -35,7 +100,8 @@ typedef struct HashTable {
 void _hashtable_init(
   HashTable* hashTable, ///< "this" pointer.
   size_t dataSize, ///< Size in bytes of a dictionary element.
-  size_t hashSize ///< (Maximum) Number of stored hash keys.
+  size_t hashSize, ///< Initial number of slots (rounded to a power of 2).
+  Allocator* allocator ///< Memory allocator (NULL: default one).
 );
 
 /**
@@ -43,17 +109,76 @@ void _hashtable_init(
  */
 HashTable* _hashtable_new(
   size_t dataSize, ///< Size in bytes of a dictionary element.
-  size_t hashSize ///< (Maximum) Number of stored hash keys.
+  size_t hashSize, ///< Initial number of slots (rounded to a power of 2).
+  Allocator* allocator ///< Memory allocator (NULL: default one).
 );
 
 /**
- * @brief Return an allocated and initialized vector.
- * @param type Type of a vector element (int, char*, ...).
+ * @brief Initialize an empty dictionary with fixed-size keys.
+ */
+void _hashtable_init_keyed(
+  HashTable* hashTable, ///< "this" pointer.
+  size_t keySize, ///< Size in bytes of a key.
+  size_t dataSize, ///< Size in bytes of a dictionary element.
+  size_t hashSize, ///< Initial number of slots (rounded to a power of 2).
+  UInt (*getHash)(void*, size_t), ///< Hash (key, keySize) (nullable).
+  bool (*equal)(void*, void*), ///< Keys equality (nullable).
+  Allocator* allocator ///< Memory allocator (NULL: default one).
+);
+
+/**
+ * @brief Return an allocated and initialized dictionary with fixed-size keys.
+ */
+HashTable* _hashtable_new_keyed(
+  size_t keySize, ///< Size in bytes of a key.
+  size_t dataSize, ///< Size in bytes of a dictionary element.
+  size_t hashSize, ///< Initial number of slots (rounded to a power of 2).
+  UInt (*getHash)(void*, size_t), ///< Hash (key, keySize) (nullable).
+  bool (*equal)(void*, void*), ///< Keys equality (nullable).
+  Allocator* allocator ///< Memory allocator (NULL: default one).
+);
+
+/**
+ * @brief Return an allocated and initialized dictionary.
+ * @param type Type of a dictionary element (int, char*, ...).
+ * @param hsize Initial number of slots (grows as needed).
  *
  * Usage: HashTable* hashtable_new(<Type> type, UInt hash_size)
  */
 #define hashtable_new(type, hsize) \
-  _hashtable_new(sizeof(type), hsize)
+  _hashtable_new(sizeof(type), hsize, NULL)
+
+/**
+ * @brief Return an allocated and initialized dictionary, using given
+ * allocator.
+ *
+ * Usage: HashTable* hashtable_new_with(<Type> type, UInt hash_size,
+ *                                      Allocator* allocator)
+ */
+#define hashtable_new_with(type, hsize, allocator) \
+  _hashtable_new(sizeof(type), hsize, allocator)
+
+/**
+ * @brief Return an allocated and initialized dictionary with keys of type
+ * ktype (int, struct...), hashed and compared as bytes if getHash and equal
+ * are NULL.
+ *
+ * Usage: HashTable* hashtable_new_keyed(<Type> ktype, <Type> type,
+ *   UInt hash_size, UInt (*getHash)(void*, size_t),
+ *   bool (*equal)(void*, void*))
+ */
+#define hashtable_new_keyed(ktype, type, hsize, getHash, equal) \
+  _hashtable_new_keyed(sizeof(ktype), sizeof(type), hsize, getHash, equal, \
+                       NULL)
+
+/**
+ * @brief Return an allocated and initialized dictionary with keys of type
+ * ktype, using given allocator.
+ */
+#define hashtable_new_keyed_with(ktype, type, hsize, getHash, equal, \
+                                 allocator) \
+  _hashtable_new_keyed(sizeof(ktype), sizeof(type), hsize, getHash, equal, \
+                       allocator)
 
 /**
  * @brief Copy constructor (shallow copy, ok for basic types).
@@ -81,7 +206,7 @@ UInt hashtable_size(
  */
 void* _hashtable_get(
   HashTable* hashTable, ///< "this" pointer.
-  char* key ///< Key of the element to retrieve.
+  void* key ///< Key (string, or pointer to key) of the element to retrieve.
 );
 
 /**
@@ -97,12 +222,39 @@ void* _hashtable_get(
   data = (typeof(data))_hashtable_get(hashTable, key); \
 }
 
+/**
+ * @brief Lookup element of given (fixed-size) key value.
+ *
+ * Usage: void hashtable_get_key(HashTable* hashTable, void key, void* data)
+ */
+#define hashtable_get_key(hashTable, key, data) \
+{ \
+  typeof(key) tmpKey = key; \
+  data = (typeof(data))_hashtable_get(hashTable, &tmpKey); \
+}
+
+/**
+ * @brief Lookup elements of n keys at once: out[i] receives the data
+ * pointer of key i, or NULL if absent.
+ *
+ * Keys are an array of n strings (char**), or of n fixed-size keys (laid
+ * out contiguously) for keyed dictionaries. Keys are processed by groups:
+ * all hashes first, then slots and cells are prefetched before being
+ * compared, so that cache misses of different lookups overlap.
+ */
+void hashtable_get_batch(
+  HashTable* hashTable, ///< "this" pointer.
+  void* keys, ///< Array of keys to lookup.
+  UInt n, ///< Number of keys.
+  void** out ///< Array of (at least) n data pointers (output).
+);
+
 /**
  * @brief Add the entry (key, value) to dictionary.
  */
 void _hashtable_set(
   HashTable* hashTable, ///< "this" pointer.
-  char* key, ///< Key of the element to add or modify.
+  void* key, ///< Key (string, or pointer to key) of the element to set.
   void* data ///< Pointer to new data at given key.
 );
 
@@ -120,14 +272,71 @@ void _hashtable_set(
   _hashtable_set(hashTable, key, &tmp); \
 }
 
+/**
+ * @brief Add the entry (key, value) to dictionary, for a (fixed-size) key
+ * value.
+ *
+ * Usage: void hashtable_set_key(HashTable* hashTable, void key, void data)
+ */
+#define hashtable_set_key(hashTable, key, data) \
+{ \
+  typeof(key) tmpKey = key; \
+  typeof(data) tmp = data; \
+  _hashtable_set(hashTable, &tmpKey, &tmp); \
+}
+
 /**
  * @brief Remove the given key (+ associated value).
  *
- * Usage: void hashtable_delete(HashTable* hashTable, char* key)
+ * Usage: void hashtable_delete(HashTable* hashTable, void* key)
  */
 void hashtable_delete(
   HashTable* hashTable, ///< "this" pointer.
-  char* key ///< Key of the element to delete.
+  void* key ///< Key (string, or pointer to key) of the element to delete.
+);
+
+/**
+ * @brief Remove the given (fixed-size) key value (+ associated value).
+ *
+ * Usage: void hashtable_delete_key(HashTable* hashTable, void key)
+ */
+#define hashtable_delete_key(hashTable, key) \
+{ \
+  typeof(key) tmpKey = key; \
+  hashtable_delete(hashTable, &tmpKey); \
+}
+
+/**
+ * @brief Migrate up to count old slots, if rehashing.
+ * @return true if the rehash is still in progress.
+ *
+ * Rehashing proceeds along with operations; this allows to speed it up
+ * (e.g. when idle), or to complete it (count = hashTable->oldHashSize),
+ * e.g. before concurrent lookups or scans.
+ */
+bool hashtable_rehash_step(
+  HashTable* hashTable, ///< "this" pointer.
+  UInt count ///< Maximum number of old slots to migrate.
+);
+
+/**
+ * @brief Attach a Bloom filter, checked before the slots by lookups, sets
+ * and deletes.
+ *
+ * The filter is kept up to date by the dictionary: it is rebuilt (from
+ * stored hashes, dropping deleted keys) when twice as many keys as the
+ * dictionary size at last build were added.
+ */
+void hashtable_attach_filter(
+  HashTable* hashTable, ///< "this" pointer.
+  Real falsePositiveRate ///< Target rate of absent keys not rejected.
+);
+
+/**
+ * @brief Remove the Bloom filter (if any).
+ */
+void hashtable_detach_filter(
+  HashTable* hashTable ///< "this" pointer.
 );
 
 /**
@@ -138,10 +347,140 @@ void hashtable_clear(
 );
 
 /**
- * @brief Destroy the dictionary: clear it, and free hashes array.
+ * @brief Destroy the dictionary: clear it, and free slots arrays.
  */
 void hashtable_destroy(
   HashTable* hashTable ///< "this" pointer.
 );
 
+//***************
+// Iterator logic
+//***************
+
+/**
+ * @brief Iterator on the entries of a dictionary, in slots order.
+ *
+ * Keys and data are accessed in place (no copy). A range iterator covers
+ * only the slots [begin, end[: disjoint ranges split a scan across threads.
+ * Creating an iterator completes a pending rehash, which writes to the
+ * dictionary: complete it (see hashtable_rehash_step()) before handing
+ * ranges to threads.
+ * The dictionary must not be modified while iterating, except through
+ * hashtableI_set().
+ */
+typedef struct HashTableIterator {
+  HashTable* hashTable; ///< Dictionary to be iterated.
+  UInt begin; ///< First slot of the range.
+  UInt end; ///< End of the range (excluded).
+  UInt current; ///< Current slot (full, or end).
+  Allocator* allocator; ///< Allocator of the iterator (may outlive table).
+} HashTableIterator;
+
+/**
+ * @brief Obtain an iterator object, on all entries (completing a rehash in
+ * progress).
+ */
+HashTableIterator* hashtable_get_iterator(
+  HashTable* hashTable ///< Pointer to the dictionary to iterate over.
+);
+
+/**
+ * @brief Obtain an iterator object, on entries in slots [begin, end[
+ * (completing a rehash in progress).
+ */
+HashTableIterator* hashtable_get_range_iterator(
+  HashTable* hashTable, ///< Pointer to the dictionary to iterate over.
+  UInt begin, ///< First slot.
+  UInt end ///< End slot (excluded), capped to hashTable->hashSize.
+);
+
+/**
+ * @brief (Re)set current position to the first entry of the range.
+ */
+void hashtableI_reset_begin(
+  HashTableIterator* hashtableI ///< "this" pointer.
+);
+
+/**
+ * @brief Tell if there is some entry at the current position.
+ */
+bool hashtableI_has_data(
+  HashTableIterator* hashtableI ///< "this" pointer.
+);
+
+/**
+ * @brief Get the key at the current position (string, or pointer to key).
+ */
+void* hashtableI_get_key(
+  HashTableIterator* hashtableI ///< "this" pointer.
+);
+
+/**
+ * @brief Get (a pointer to) the data at the current position.
+ */
+void* _hashtableI_get(
+  HashTableIterator* hashtableI ///< "this" pointer.
+);
+
+/**
+ * @brief Get data at the current position.
+ * @param hashtableI "this" pointer.
+ * @param data 'out' variable to contain the result.
+ *
+ * Usage: void hashtableI_get(HashTableIterator* hashtableI, void data)
+ */
+#define hashtableI_get(hashtableI, data) \
+{ \
+  void* pData = _hashtableI_get(hashtableI); \
+  data = *((typeof(&data))pData); \
+}
+
+/**
+ * @brief Set data at the current position.
+ */
+void _hashtableI_set(
+  HashTableIterator* hashtableI, ///< "this" pointer.
+  void* data ///< Data to be assigned.
+);
+
+/**
+ * @brief Set data at the current position.
+ * @param hashtableI "this" pointer.
+ * @param data Data to be assigned.
+ *
+ * Usage: void hashtableI_set(HashTableIterator* hashtableI, void data)
+ */
+#define hashtableI_set(hashtableI, data) \
+{ \
+  typeof(data) tmp = data; \
+  _hashtableI_set(hashtableI, &tmp); \
+}
+
+/**
+ * @brief Move current position to the next entry of the range.
+ */
+void hashtableI_move_next(
+  HashTableIterator* hashtableI ///< "this" pointer.
+);
+
+/**
+ * @brief Fill cells with up to maxCount entries from the current position,
+ * and move after them.
+ * @return Number of cells obtained (0 when the range is exhausted).
+ *
+ * Cells give in place access to keys and data (cell->key, cell->data).
+ */
+UInt hashtableI_next_chunk(
+  HashTableIterator* hashtableI, ///< "this" pointer.
+  HashCell** cells, ///< Array of (at least) maxCount cells pointers.
+  UInt maxCount ///< Maximum number of cells to obtain.
+);
+
+/**
+ * @brief Free memory allocated for the iterator.
+ */
+void hashtableI_destroy(
+  HashTableIterator* hashtableI ///< "this" pointer.
+);
+
 #endif
@@ -4,183 +4,191 @@
 
 #include "cgds/Heap.h"
 
+// Records up to this size are saved on the stack while sifting
+#define HEAP_STACK_RECORD 64
+
 // NOTE: no init() method here, since Heap has no specific initialization
 
-Heap* _heap_new(size_t dataSize, OrderType hType, UInt arity)
+Heap* _heap_new(size_t dataSize, OrderType hType, UInt arity,
+                Allocator* allocator)
 {
-  Heap* heap = (Heap*) safe_malloc(sizeof(Heap));
+  allocator = allocator_or_default(allocator);
+  Heap* heap = (Heap*) allocator_alloc(allocator, sizeof(Heap));
   heap->arity = arity;
   heap->hType = hType;
-  heap->items = _vector_new(dataSize);
-  heap->values = _vector_new(sizeof(Real));
+  heap->allocator = allocator;
+  heap->dataSize = dataSize;
+  // Value first, then item padded to keep next value aligned
+  heap->recordSize = sizeof(Real) +
+    (dataSize + sizeof(Real) - 1) / sizeof(Real) * sizeof(Real);
+  // Small heaps are common: first records live in an inline buffer,
+  // around two cache lines
+  heap->records = _smallvector_new(heap->recordSize,
+    heap->recordSize < 128 ? 128 / heap->recordSize : 1, allocator);
   return heap;
 }
 
 Heap* heap_copy(Heap* heap)
 {
-  Heap* heapCopy = (Heap*) safe_malloc(sizeof(Heap));
+  Heap* heapCopy = (Heap*) allocator_alloc(heap->allocator, sizeof(Heap));
   heapCopy->arity = heap->arity;
   heapCopy->hType = heap->hType;
-  heapCopy->items = vector_copy(heap->items);
-  heapCopy->values = vector_copy(heap->values);
+  heapCopy->allocator = heap->allocator;
+  heapCopy->dataSize = heap->dataSize;
+  heapCopy->recordSize = heap->recordSize;
+  heapCopy->records = vector_copy(heap->records);
   return heapCopy;
 }
 
 bool heap_empty(Heap* heap)
 {
-  return vector_empty(heap->items);
+  return vector_empty(heap->records);
 }
 
 UInt heap_size(Heap* heap)
 {
-  return vector_size(heap->items);
+  return vector_size(heap->records);
+}
+
+// Record at given index [internal usage]
+char* _heap_record(Heap* heap, UInt index)
+{
+  return (char*)heap->records->datas + index * heap->recordSize;
+}
+
+// Value of a record [internal usage]
+Real _heap_value(char* record)
+{
+  Real value;
+  memcpy(&value, record, sizeof(Real));
+  return value;
+}
+
+// Tell if value a comes strictly before value b [internal usage]
+bool _heap_before(Heap* heap, Real a, Real b)
+{
+  return (heap->hType == MIN_T ? a < b : a > b);
 }
 
 // NOTE: [perf] in two following methods, full heap[k] exchanges are
-// not needed; we keep track of the moving element without assigning it at
-// every step, thus saving array accesses and affectations + 'aux' tmp memory.
-// --> this is not the most natural way of writing these functions.
+// not needed; we keep track of the moving record without assigning it at
+// every step: each level moves one record (one memcpy) into the "hole",
+// and the saved record lands at the end.
 
 void _heap_bubble_up(Heap* heap, UInt startIndex)
 {
   if (startIndex == 0)
     // Nothing to do in this case
     return;
+  size_t recordSize = heap->recordSize;
+  Real stackRecord[HEAP_STACK_RECORD / sizeof(Real)];
+  char* saved = NULL;
+  Real startValue = _heap_value(_heap_record(heap, startIndex));
   UInt currentIndex = startIndex;
-  void* startItem = _vector_get(heap->items, startIndex);
-  Real startValue = *((Real*)(_vector_get(heap->values, startIndex)));
-  bool startItemReallocated = false;
-  while (true)
+  while (currentIndex > 0)
   {
-    bool land = (currentIndex == 0), //at root: can't go up
-         applyExchange = true;
-    if (!land)
+    // Get parent and compare to it
+    UInt nextIndex = (currentIndex - 1) / heap->arity;
+    char* next = _heap_record(heap, nextIndex);
+    if (!_heap_before(heap, startValue, _heap_value(next)))
+      // At correct relative place
+      break;
+    // Move one level up: the parent goes one level down
+    if (saved == NULL)
     {
-      // Get parent and compare to it
-      UInt nextIndex = (currentIndex - 1) / heap->arity;
-      Real nextValue = *((Real*)(_vector_get(heap->values, nextIndex)));
-      land = (
-        (heap->hType == MIN_T && startValue >= nextValue) ||
-        (heap->hType == MAX_T && startValue <= nextValue)
-      );
-      if (!land)
-      {
-        // Move one level up: the parent goes one level down
-        if (currentIndex == startIndex)
-        {
-          // Save startItem (because *startItem is about to be changed)
-          void* newStartItem = safe_malloc(heap->items->dataSize);
-          memcpy(newStartItem, startItem, heap->items->dataSize);
-          startItem = newStartItem;
-          startItemReallocated = true;
-        }
-        void* nextItem = _vector_get(heap->items, nextIndex);
-        _vector_set(heap->items, currentIndex, nextItem);
-        _vector_set(heap->values, currentIndex, &nextValue);
-        currentIndex = nextIndex;
-        continue;
-      }
-      // At correct relative place: will now land
-      if (currentIndex == startIndex)
-        applyExchange = false;
+      // Save start record (because it is about to be overwritten)
+      saved = (recordSize <= HEAP_STACK_RECORD
+        ? (char*)stackRecord
+        : allocator_alloc(heap->allocator, recordSize));
+      memcpy(saved, _heap_record(heap, startIndex), recordSize);
     }
-    if (applyExchange)
-    {
-      _vector_set(heap->items, currentIndex, startItem);
-      _vector_set(heap->values, currentIndex, &startValue);
-    }
-    break;
+    memcpy(_heap_record(heap, currentIndex), next, recordSize);
+    currentIndex = nextIndex;
+  }
+  if (saved != NULL)
+  {
+    // Moving record has landed: apply final affectation
+    memcpy(_heap_record(heap, currentIndex), saved, recordSize);
+    if (saved != (char*)stackRecord)
+      allocator_free(heap->allocator, saved, recordSize);
   }
-  if (startItemReallocated)
-    safe_free(startItem);
 }
 
 void _heap_bubble_down(Heap* heap, UInt startIndex)
 {
-  if (startIndex * heap->arity + 1 >= heap->items->size)
+  UInt size = heap->records->size;
+  if (startIndex * heap->arity + 1 >= size)
     // Nothing to do: already in a leaf
     return;
+  size_t recordSize = heap->recordSize;
+  Real stackRecord[HEAP_STACK_RECORD / sizeof(Real)];
+  char* saved = NULL;
+  Real startValue = _heap_value(_heap_record(heap, startIndex));
   UInt currentIndex = startIndex;
-  void* startItem = _vector_get(heap->items, startIndex);
-  Real startValue = *((Real*)(_vector_get(heap->values, startIndex)));
-  bool startItemReallocated = false;
-  while (true)
+  while (currentIndex * heap->arity + 1 < size)
   {
-    bool land = (currentIndex * heap->arity + 1 >= heap->items->size),
-         applyExchange = true;
-    if (!land)
+    // Find top child (min or max): children records are contiguous
+    UInt firstChild = currentIndex * heap->arity + 1,
+         lastChild = firstChild + heap->arity;
+    if (lastChild > size)
+      lastChild = size;
+    UInt topChildIndex = firstChild;
+    Real topChildValue = _heap_value(_heap_record(heap, firstChild));
+    for (UInt childIndex = firstChild + 1; childIndex < lastChild;
+         childIndex++)
     {
-      // Find top child (min or max)
-      UInt topChildIndex;
-      Real topChildValue = (heap->hType == MIN_T ? INFINITY : -INFINITY);
-      for (UInt i = 1; i <= heap->arity; i++)
-      {
-        UInt childIndex = currentIndex * heap->arity + i;
-        if (childIndex >= heap->items->size)
-          break;
-        Real childValue = *((Real*)(_vector_get(heap->values, childIndex)));
-        if (
-          (heap->hType == MIN_T && childValue < topChildValue) ||
-          (heap->hType == MAX_T && childValue > topChildValue)
-        ) {
-          topChildIndex = childIndex;
-          topChildValue = childValue;
-        }
-      }
-      // Compare to top child
-      land = (
-        (heap->hType == MIN_T && startValue <= topChildValue) ||
-        (heap->hType == MAX_T && startValue >= topChildValue)
-      );
-      if (!land)
+      Real childValue = _heap_value(_heap_record(heap, childIndex));
+      if (_heap_before(heap, childValue, topChildValue))
       {
-        // Move one level down: the child goes one level up
-        if (currentIndex == startIndex)
-        {
-          // Save startItem (because *startItem is about to be changed)
-          void* newStartItem = safe_malloc(heap->items->dataSize);
-          memcpy(newStartItem, startItem, heap->items->dataSize);
-          startItem = newStartItem;
-          startItemReallocated = true;
-        }
-        void* topChildItem = _vector_get(heap->items, topChildIndex);
-        _vector_set(heap->items, currentIndex, topChildItem);
-        _vector_set(heap->values, currentIndex, &topChildValue);
-        currentIndex = topChildIndex;
-        continue;
+        topChildIndex = childIndex;
+        topChildValue = childValue;
       }
-      // At correct relative place: will now land
-      if (currentIndex == startIndex)
-        applyExchange = false;
     }
-    if (applyExchange)
+    // Compare to top child
+    if (!_heap_before(heap, topChildValue, startValue))
+      // At correct relative place
+      break;
+    // Move one level down: the child goes one level up
+    if (saved == NULL)
     {
-      // Moving element has landed (in a leaf): apply final affectation
-      _vector_set(heap->items, currentIndex, startItem);
-      _vector_set(heap->values, currentIndex, &startValue);
+      // Save start record (because it is about to be overwritten)
+      saved = (recordSize <= HEAP_STACK_RECORD
+        ? (char*)stackRecord
+        : allocator_alloc(heap->allocator, recordSize));
+      memcpy(saved, _heap_record(heap, startIndex), recordSize);
     }
-    break;
+    memcpy(_heap_record(heap, currentIndex),
+           _heap_record(heap, topChildIndex), recordSize);
+    currentIndex = topChildIndex;
+  }
+  if (saved != NULL)
+  {
+    // Moving record has landed: apply final affectation
+    memcpy(_heap_record(heap, currentIndex), saved, recordSize);
+    if (saved != (char*)stackRecord)
+      allocator_free(heap->allocator, saved, recordSize);
   }
-  if (startItemReallocated)
-    safe_free(startItem);
 }
 
 void _heap_insert(Heap* heap, void* item, Real value)
 {
-  _vector_push(heap->items, item);
-  _vector_push(heap->values, &value);
-  _heap_bubble_up(heap, heap->items->size - 1);
+  // Grow by one record, then fill it in place
+  vector_resize(heap->records, heap->records->size + 1);
+  char* record = _heap_record(heap, heap->records->size - 1);
+  memcpy(record, &value, sizeof(Real));
+  memcpy(record + sizeof(Real), item, heap->dataSize);
+  _heap_bubble_up(heap, heap->records->size - 1);
 }
 
 Int _heap_get_index(Heap* heap, void* item)
 {
-  for (Int index = 0; index < heap->items->size; index++)
+  for (Int index = 0; index < heap->records->size; index++)
   {
     if (
       memcmp(
-        heap->items->datas + index * heap->items->dataSize,
+        _heap_record(heap, index) + sizeof(Real),
         item,
-        heap->items->dataSize
+        heap->dataSize
       ) == 0
     ) {
       return index;
@@ -196,8 +204,9 @@ void _heap_modify(Heap* heap, void* item, Real newValue)
   if (index < 0)
     // Element not found
     return;
-  Real oldValue = *((Real*)_vector_get(heap->values, index));
-  _vector_set(heap->values, index, &newValue);
+  char* record = _heap_record(heap, index);
+  Real oldValue = _heap_value(record);
+  memcpy(record, &newValue, sizeof(Real));
   if (
     (heap->hType == MIN_T && newValue > oldValue) ||
     (heap->hType == MAX_T && newValue < oldValue)
@@ -210,21 +219,14 @@ void _heap_modify(Heap* heap, void* item, Real newValue)
 
 void _heap_remove_at_index(Heap* heap, Int index)
 {
-  const bool removeLast = (index == heap->items->size - 1);
+  const bool removeLast = (index == heap->records->size - 1);
   if (!removeLast)
   {
-    _vector_set(
-      heap->items,
-      index,
-      _vector_get(heap->items, heap->items->size - 1));
-    _vector_set(
-      heap->values,
-      index,
-      _vector_get(heap->values, heap->values->size - 1));
+    memcpy(_heap_record(heap, index),
+           _heap_record(heap, heap->records->size - 1), heap->recordSize);
   }
-  vector_pop(heap->items);
-  vector_pop(heap->values);
-  if (!removeLast && heap->items->size > 0)
+  vector_pop(heap->records);
+  if (!removeLast && heap->records->size > 0)
     _heap_bubble_down(heap, index);
 }
 
@@ -239,8 +241,9 @@ void _heap_remove(Heap* heap, void* item)
 ItemValue _heap_top(Heap* heap)
 {
   ItemValue top;
-  top.item = _vector_get(heap->items, 0);
-  vector_get(heap->values, 0, top.value);
+  char* record = _heap_record(heap, 0);
+  top.item = record + sizeof(Real);
+  top.value = _heap_value(record);
   return top;
 }
 
@@ -251,13 +254,11 @@ void heap_pop(Heap* heap)
 
 void heap_clear(Heap* heap)
 {
-  vector_clear(heap->items);
-  vector_clear(heap->values);
+  vector_clear(heap->records);
 }
 
 void heap_destroy(Heap* heap)
 {
-  vector_destroy(heap->items);
-  vector_destroy(heap->values);
-  safe_free(heap);
+  vector_destroy(heap->records);
+  allocator_free(heap->allocator, heap, sizeof(Heap));
 }
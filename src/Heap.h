@@ -14,12 +14,19 @@
 
 /**
  * @brief Generic d-ary heap.
+ *
+ * Each element is a record: its value (a Real) followed by its item, padded
+ * to a multiple of sizeof(Real). Records are stored in a single vector, so
+ * a sift step reads and moves one contiguous record, and the children of a
+ * node are contiguous.
  */
 typedef struct Heap {
   OrderType hType; ///< Type of heap: max first (MAX_T) or min first (MIN_T).
   UInt arity; ///< Arity of the underlying tree.
-  Vector* items; ///< Vector of items (any type).
-  Vector* values; ///< Vector of items values (real numbers).
+  size_t dataSize; ///< Size of an item in bytes.
+  size_t recordSize; ///< Size of a (value, item) record in bytes.
+  Vector* records; ///< Vector of (value, item) records.
+  Allocator* allocator; ///< Allocator of the struct and vector.
 } Heap;
 
 /**
@@ -28,7 +35,8 @@ typedef struct Heap {
 Heap* _heap_new(
   size_t dataSize, ///< Size in bytes of a heap element.
   OrderType hType, ///< Type of heap: max first (MAX_T) or min first (MIN_T).
-  UInt arity ///< Arity of the underlying tree.
+  UInt arity, ///< Arity of the underlying tree.
+  Allocator* allocator ///< Memory allocator (NULL: default one).
 );
 
 /**
@@ -40,7 +48,16 @@ Heap* _heap_new(
  * Usage: Heap* heap_new(<Type> type, OrderType hType, UInt arity)
  */
 #define heap_new(type, hType, arity) \
-  _heap_new(sizeof(type), hType, arity)
+  _heap_new(sizeof(type), hType, arity, NULL)
+
+/**
+ * @brief Return an allocated and initialized heap, using given allocator.
+ *
+ * Usage: Heap* heap_new_with(<Type> type, OrderType hType, UInt arity,
+ *                            Allocator* allocator)
+ */
+#define heap_new_with(type, hType, arity, allocator) \
+  _heap_new(sizeof(type), hType, arity, allocator)
 
 /**
  * @brief Copy constructor (shallow copy, ok for basic types).
@@ -8,24 +8,27 @@
 // List logic //
 ////////////////
 
-void _list_init(List* list, size_t dataSize)
+void _list_init(List* list, size_t dataSize, Allocator* allocator)
 {
   list->size = 0;
   list->dataSize = dataSize;
   list->head = NULL;
   list->tail = NULL;
+  list->allocator = allocator_or_default(allocator);
+  pool_init(&list->cellPool, sizeof (ListCell) + dataSize, list->allocator);
 }
 
-List* _list_new(size_t dataSize)
+List* _list_new(size_t dataSize, Allocator* allocator)
 {
-  List* list = (List*) safe_malloc(sizeof (List));
-  _list_init(list, dataSize);
+  allocator = allocator_or_default(allocator);
+  List* list = (List*) allocator_alloc(allocator, sizeof (List));
+  _list_init(list, dataSize, allocator);
   return list;
 }
 
 List* list_copy(List* list)
 {
-  List* listCopy = _list_new(list->dataSize);
+  List* listCopy = _list_new(list->dataSize, list->allocator);
   ListCell* listCell = list->head;
   while (listCell != NULL)
   {
@@ -55,10 +58,21 @@ void _list_set(List* list, ListCell* listCell, void* data)
   memcpy(listCell->data, data, list->dataSize);
 }
 
+// Get a cell (with room for its data) from the pool [internal usage]
+ListCell* _list_new_cell(List* list)
+{
+  return (ListCell*) pool_alloc(&list->cellPool);
+}
+
+// Give a cell (and its data) back to the pool [internal usage]
+void _list_free_cell(List* list, ListCell* listCell)
+{
+  pool_free(&list->cellPool, listCell);
+}
+
 void _list_insert_first_element(List* list, void* data)
 {
-  ListCell* newListCell = (ListCell*) safe_malloc(sizeof (ListCell));
-  newListCell->data = safe_malloc(list->dataSize);
+  ListCell* newListCell = _list_new_cell(list);
   memcpy(newListCell->data, data, list->dataSize);
   newListCell->prev = NULL;
   newListCell->next = NULL;
@@ -69,8 +83,7 @@ void _list_insert_first_element(List* list, void* data)
 
 void _list_insert_before(List* list, ListCell* listCell, void* data)
 {
-  ListCell* newListCell = (ListCell*) safe_malloc(sizeof (ListCell));
-  newListCell->data = safe_malloc(list->dataSize);
+  ListCell* newListCell = _list_new_cell(list);
   memcpy(newListCell->data, data, list->dataSize);
   newListCell->prev = listCell->prev;
   newListCell->next = listCell;
@@ -84,8 +97,7 @@ void _list_insert_before(List* list, ListCell* listCell, void* data)
 
 void _list_insert_after(List* list, ListCell* listCell, void* data)
 {
-  ListCell* newListCell = (ListCell*) safe_malloc(sizeof (ListCell));
-  newListCell->data = safe_malloc(list->dataSize);
+  ListCell* newListCell = _list_new_cell(list);
   memcpy(newListCell->data, data, list->dataSize);
   newListCell->prev = listCell;
   newListCell->next = listCell->next;
@@ -123,8 +135,7 @@ void list_remove(List* list, ListCell* listCell)
     listCell->next->prev = listCell->prev;
   else
     list->tail = listCell->prev;
-  safe_free(listCell->data);
-  safe_free(listCell);
+  _list_free_cell(list, listCell);
   list->size--;
 }
 
@@ -140,21 +151,15 @@ void list_remove_back(List* list)
 
 void list_clear(List* list)
 {
-  ListCell* current = list->head;
-  while (current != NULL)
-  {
-    safe_free(current->data);
-    ListCell* nextListCell = current->next;
-    safe_free(current);
-    current = nextListCell;
-  }
-  _list_init(list, list->dataSize);
+  // NOTE: all cells are in the pool: no need to walk them
+  pool_release(&list->cellPool);
+  _list_init(list, list->dataSize, list->allocator);
 }
 
 void list_destroy(List* list)
 {
   list_clear(list);
-  safe_free(list);
+  allocator_free(list->allocator, list, sizeof (List));
 }
 
 ////////////////////
@@ -163,8 +168,10 @@ void list_destroy(List* list)
 
 ListIterator* list_get_iterator(List* list)
 {
-  ListIterator* listI = (ListIterator*) safe_malloc(sizeof (ListIterator));
+  ListIterator* listI = (ListIterator*)
+    allocator_alloc(list->allocator, sizeof (ListIterator));
   listI->list = list;
+  listI->allocator = list->allocator;
   listI->current = NULL;
   listI_reset_head(listI);
   return listI;
@@ -214,5 +221,5 @@ void listI_move_prev(ListIterator* listI)
 
 void listI_destroy(ListIterator* listI)
 {
-  safe_free(listI);
+  allocator_free(listI->allocator, listI, sizeof (ListIterator));
 }
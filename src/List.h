@@ -8,6 +8,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "cgds/safe_alloc.h"
+#include "cgds/Pool.h"
 #include "cgds/types.h"
 
 ////////////////
@@ -18,9 +19,9 @@
  * @brief Cell of a double-linked list.
  */
 typedef struct ListCell {
-  void* data; ///< Generic data contained in this cell.
   struct ListCell* prev; ///< Pointer to previous cell in the list.
   struct ListCell* next; ///< Pointer to next cell in the list.
+  char data[] POOL_PAYLOAD; ///< Generic data contained in this cell.
 } ListCell;
 
 /**
@@ -31,6 +32,8 @@ typedef struct List {
   size_t dataSize; ///< Size of a list cell element in bytes.
   ListCell* head; ///< Pointer to the first cell in the list.
   ListCell* tail; ///< Pointer to the last cell in the list.
+  Allocator* allocator; ///< Allocator of the struct, cells and iterators.
+  Pool cellPool; ///< Pool of cells (with their data).
 } List;
 
 /**
@@ -38,7 +41,8 @@ typedef struct List {
  */
 void _list_init(
   List* list, ///< "this" pointer.
-  size_t dataSize ///< Size of a list cell elements in bytes.
+  size_t dataSize, ///< Size of a list cell elements in bytes.
+  Allocator* allocator ///< Memory allocator (NULL: default one).
 );
 
 /**
@@ -46,7 +50,8 @@ void _list_init(
  * @param dataSize Size in bytes of a list element.
  */
 List* _list_new(
-  size_t dataSize ///< Size of a list cell elements in bytes.
+  size_t dataSize, ///< Size of a list cell elements in bytes.
+  Allocator* allocator ///< Memory allocator (NULL: default one).
 );
 
 /**
@@ -56,7 +61,17 @@ List* _list_new(
  * Usage: List* list_new(<Type> type)
  */
 #define list_new(type) \
-  _list_new(sizeof(type))
+  _list_new(sizeof(type), NULL)
+
+/**
+ * @brief Return an allocated and initialized list, using given allocator.
+ * @param type Type of a list element (int, char*, ...).
+ * @param allocator Memory allocator (Allocator*).
+ *
+ * Usage: List* list_new_with(<Type> type, Allocator* allocator)
+ */
+#define list_new_with(type, allocator) \
+  _list_new(sizeof(type), allocator)
 
 /**
  * @brief Copy constructor (shallow copy, ok for basic types).
@@ -264,6 +279,7 @@ void list_destroy(
 typedef struct ListIterator {
   List* list; ///< The list to be iterate.
   ListCell* current; ///< The current iterated list cell.
+  Allocator* allocator; ///< Allocator of the iterator (may outlive list).
 } ListIterator;
 
 /**
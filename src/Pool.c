@@ -0,0 +1,97 @@
+/**
+ * @file Pool.c
+ */
+
+#include "cgds/Pool.h"
+
+// Number of blocks of the first slab, and maximum slab capacity
+#define POOL_MIN_SLAB_CAPACITY 16
+#define POOL_MAX_SLAB_CAPACITY 4096
+
+// Size of slab header, such that blocks are aligned [internal usage]
+#define POOL_SLAB_HEADER pool_align(sizeof (PoolSlab))
+
+void pool_init(Pool* pool, size_t blockSize, Allocator* allocator)
+{
+  // NOTE: a free block stores the next free block address
+  if (blockSize < sizeof (void*))
+    blockSize = sizeof (void*);
+  pool->blockSize = pool_align(blockSize);
+  pool->freeList = NULL;
+  pool->slabs = NULL;
+  pool->current = NULL;
+  pool->end = NULL;
+  pool->slabCapacity = POOL_MIN_SLAB_CAPACITY;
+  pool->count = 0;
+  pool->allocator = allocator_or_default(allocator);
+}
+
+Pool* pool_new(size_t blockSize, Allocator* allocator)
+{
+  allocator = allocator_or_default(allocator);
+  Pool* pool = (Pool*) allocator_alloc(allocator, sizeof (Pool));
+  pool_init(pool, blockSize, allocator);
+  return pool;
+}
+
+// Allocate next slab, twice larger than the previous one [internal usage]
+void _pool_add_slab(Pool* pool)
+{
+  UInt capacity = pool->slabCapacity;
+  PoolSlab* slab = (PoolSlab*) allocator_alloc(
+    pool->allocator, POOL_SLAB_HEADER + capacity * pool->blockSize);
+  slab->capacity = capacity;
+  slab->next = pool->slabs;
+  pool->slabs = slab;
+  pool->current = (char*)slab + POOL_SLAB_HEADER;
+  pool->end = pool->current + capacity * pool->blockSize;
+  if (pool->slabCapacity < POOL_MAX_SLAB_CAPACITY)
+    pool->slabCapacity *= 2;
+}
+
+void* pool_alloc(Pool* pool)
+{
+  void* block = pool->freeList;
+  if (block != NULL)
+    pool->freeList = *((void**)block);
+  else
+  {
+    if (pool->current == pool->end)
+      _pool_add_slab(pool);
+    block = pool->current;
+    pool->current += pool->blockSize;
+  }
+  pool->count++;
+  return block;
+}
+
+void pool_free(Pool* pool, void* block)
+{
+  *((void**)block) = pool->freeList;
+  pool->freeList = block;
+  pool->count--;
+}
+
+UInt pool_count(Pool* pool)
+{
+  return pool->count;
+}
+
+void pool_release(Pool* pool)
+{
+  PoolSlab* slab = pool->slabs;
+  while (slab != NULL)
+  {
+    PoolSlab* next = slab->next;
+    allocator_free(pool->allocator, slab,
+                   POOL_SLAB_HEADER + slab->capacity * pool->blockSize);
+    slab = next;
+  }
+  pool_init(pool, pool->blockSize, pool->allocator);
+}
+
+void pool_destroy(Pool* pool)
+{
+  pool_release(pool);
+  allocator_free(pool->allocator, pool, sizeof (Pool));
+}
@@ -0,0 +1,110 @@
+/**
+ * @file Pool.h
+ */
+
+#ifndef CGDS_POOL_H
+#define CGDS_POOL_H
+
+#include <stdlib.h>
+#include <string.h>
+#include "cgds/safe_alloc.h"
+#include "cgds/types.h"
+
+/**
+ * @brief Alignment of pool blocks (as guaranteed by malloc).
+ */
+#define POOL_ALIGNMENT 16
+
+/**
+ * @brief Round a size up to a multiple of POOL_ALIGNMENT.
+ */
+#define pool_align(size) \
+  (((size) + POOL_ALIGNMENT - 1) & ~((size_t)POOL_ALIGNMENT - 1))
+
+/**
+ * @brief Attribute of a flexible array member holding a payload at the end
+ * of a pool block, to align it as malloc would.
+ */
+#define POOL_PAYLOAD __attribute__((aligned(POOL_ALIGNMENT)))
+
+/**
+ * @brief Slab: contiguous array of pool blocks.
+ */
+typedef struct PoolSlab {
+  struct PoolSlab* next; ///< Previously filled slab (NULL if none).
+  UInt capacity; ///< Number of blocks in the slab.
+} PoolSlab;
+
+/**
+ * @brief Fixed-size blocks allocator (slabs plus free list).
+ *
+ * Blocks are handed out in address order from slabs (of doubling sizes,
+ * obtained from the pool allocator); released blocks are recycled first.
+ * Allocating or releasing a block is a pointer pop/push, and releasing all
+ * blocks costs one free per slab.
+ */
+typedef struct Pool {
+  size_t blockSize; ///< Size of a block in bytes (aligned).
+  void* freeList; ///< Released blocks, linked through their first word.
+  PoolSlab* slabs; ///< Slab currently filled (others follow it).
+  char* current; ///< Next never used block in current slab.
+  char* end; ///< End of current slab.
+  UInt slabCapacity; ///< Number of blocks of the next slab.
+  UInt count; ///< Number of blocks in use.
+  Allocator* allocator; ///< Allocator of the slabs.
+} Pool;
+
+/**
+ * @brief Initialize an empty pool.
+ */
+void pool_init(
+  Pool* pool, ///< "this" pointer.
+  size_t blockSize, ///< Size of a block in bytes.
+  Allocator* allocator ///< Allocator of the slabs (NULL: default one).
+);
+
+/**
+ * @brief Return an allocated and initialized pool.
+ */
+Pool* pool_new(
+  size_t blockSize, ///< Size of a block in bytes.
+  Allocator* allocator ///< Allocator of the slabs (NULL: default one).
+);
+
+/**
+ * @brief Return a block of the pool; exit program if allocation fails.
+ */
+void* pool_alloc(
+  Pool* pool ///< "this" pointer.
+);
+
+/**
+ * @brief Give a block back to the pool.
+ */
+void pool_free(
+  Pool* pool, ///< "this" pointer.
+  void* block ///< Block obtained from pool_alloc().
+);
+
+/**
+ * @brief Return the number of blocks in use.
+ */
+UInt pool_count(
+  Pool* pool ///< "this" pointer.
+);
+
+/**
+ * @brief Release all blocks at once (slabs go back to the allocator).
+ */
+void pool_release(
+  Pool* pool ///< "this" pointer.
+);
+
+/**
+ * @brief Destroy a pool returned by pool_new(), and all its blocks.
+ */
+void pool_destroy(
+  Pool* pool ///< "this" pointer.
+);
+
+#endif
@@ -7,18 +7,20 @@
 // NOTE: no init() method here,
 // since PriorityQueue has no specific initialization
 
-PriorityQueue* _priorityqueue_new(size_t dataSize, OrderType pType, UInt arity)
+PriorityQueue* _priorityqueue_new(size_t dataSize, OrderType pType, UInt arity,
+                                  Allocator* allocator)
 {
+  allocator = allocator_or_default(allocator);
   PriorityQueue* priorityQueue =
-    (PriorityQueue*) safe_malloc(sizeof (PriorityQueue));
-  priorityQueue->heap = _heap_new(dataSize, pType, arity);
+    (PriorityQueue*) allocator_alloc(allocator, sizeof (PriorityQueue));
+  priorityQueue->heap = _heap_new(dataSize, pType, arity, allocator);
   return priorityQueue;
 }
 
 PriorityQueue* priorityqueue_copy(PriorityQueue* priorityQueue)
 {
-  PriorityQueue* priorityQueueCopy =
-    (PriorityQueue*) safe_malloc(sizeof (PriorityQueue));
+  PriorityQueue* priorityQueueCopy = (PriorityQueue*)
+    allocator_alloc(priorityQueue->heap->allocator, sizeof (PriorityQueue));
   priorityQueueCopy->heap = heap_copy(priorityQueue->heap);
   return priorityQueueCopy;
 }
@@ -50,6 +52,7 @@ void priorityqueue_clear(PriorityQueue* priorityQueue)
 
 void priorityqueue_destroy(PriorityQueue* priorityQueue)
 {
+  Allocator* allocator = priorityQueue->heap->allocator;
   heap_destroy(priorityQueue->heap);
-  safe_free(priorityQueue);
+  allocator_free(allocator, priorityQueue, sizeof (PriorityQueue));
 }
@@ -24,7 +24,8 @@ typedef struct PriorityQueue {
 PriorityQueue* _priorityqueue_new(
   size_t dataSize, ///< Size in bytes of a priority queue element.
   OrderType pType, ///< Type of priority queue: max or min first (MAX_T or MIN_T).
-  UInt arity ///< Arity of the wrapped heap: any integer >=2.
+  UInt arity, ///< Arity of the wrapped heap: any integer >=2.
+  Allocator* allocator ///< Memory allocator (NULL: default one).
 );
 
 /**
@@ -36,7 +37,16 @@ PriorityQueue* _priorityqueue_new(
  * Usage: PriorityQueue* priorityqueue_new(<Type> type, OrderType pType, UInt arity)
  */
 #define priorityqueue_new(type, pType, arity) \
-  _priorityqueue_new(sizeof(type), pType, arity)
+  _priorityqueue_new(sizeof(type), pType, arity, NULL)
+
+/**
+ * @brief Return an allocated and initialized Queue, using given allocator.
+ *
+ * Usage: PriorityQueue* priorityqueue_new_with(<Type> type, OrderType pType,
+ *                                              UInt arity, Allocator* a)
+ */
+#define priorityqueue_new_with(type, pType, arity, allocator) \
+  _priorityqueue_new(sizeof(type), pType, arity, allocator)
 
 /**
  * @brief Copy constructor (shallow copy, ok for basic types).
@@ -4,23 +4,25 @@
 
 #include "cgds/Queue.h"
 
-void _queue_init(Queue* queue, size_t dataSize)
+void _queue_init(Queue* queue, size_t dataSize, Allocator* allocator)
 {
   queue->dataSize = dataSize;
-  _list_init(queue->list, dataSize);
+  _list_init(queue->list, dataSize, allocator);
 }
 
-Queue* _queue_new(size_t dataSize)
+Queue* _queue_new(size_t dataSize, Allocator* allocator)
 {
-  Queue* queue = (Queue*) safe_malloc(sizeof (Queue));
-  queue->list = _list_new(dataSize);
-  _queue_init(queue, dataSize);
+  allocator = allocator_or_default(allocator);
+  Queue* queue = (Queue*) allocator_alloc(allocator, sizeof (Queue));
+  queue->list = _list_new(dataSize, allocator);
+  _queue_init(queue, dataSize, allocator);
   return queue;
 }
 
 Queue* queue_copy(Queue* queue)
 {
-  Queue* queueCopy = (Queue*) safe_malloc(sizeof (Queue));
+  Queue* queueCopy =
+    (Queue*) allocator_alloc(queue->list->allocator, sizeof (Queue));
   queueCopy->dataSize = queue->dataSize;
   List* listCopy = list_copy(queue->list);
   queueCopy->list = listCopy;
@@ -59,6 +61,7 @@ void queue_clear(Queue* queue)
 
 void queue_destroy(Queue* queue)
 {
+  Allocator* allocator = queue->list->allocator;
   list_destroy(queue->list);
-  safe_free(queue);
+  allocator_free(allocator, queue, sizeof (Queue));
 }
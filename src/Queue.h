@@ -27,14 +27,16 @@ typedef struct Queue {
  */
 void _queue_init(
   Queue* queue, ///< "this" pointer.
-  size_t dataSize ///< Size in bytes of a queue element.
+  size_t dataSize, ///< Size in bytes of a queue element.
+  Allocator* allocator ///< Memory allocator (NULL: default one).
 );
 
 /**
  * @brief Return an allocated and initialized queue.
  */
 Queue* _queue_new(
-  size_t dataSize ///< Size in bytes of a queue element.
+  size_t dataSize, ///< Size in bytes of a queue element.
+  Allocator* allocator ///< Memory allocator (NULL: default one).
 );
 
 /**
@@ -44,7 +46,17 @@ Queue* _queue_new(
  * Usage: Queue* queue_new(<Type> type)
  */
 #define queue_new(type) \
-  _queue_new(sizeof(type))
+  _queue_new(sizeof(type), NULL)
+
+/**
+ * @brief Return an allocated and initialized queue, using given allocator.
+ * @param type Type of a queue element (int, char*, ...).
+ * @param allocator Memory allocator (Allocator*).
+ *
+ * Usage: Queue* queue_new_with(<Type> type, Allocator* allocator)
+ */
+#define queue_new_with(type, allocator) \
+  _queue_new(sizeof(type), allocator)
 
 /**
  * @brief Copy constructor (shallow copy, ok for basic types).
@@ -0,0 +1,720 @@
+/**
+ * @file RoaringSet.c
+ */
+
+#include "cgds/RoaringSet.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ROARINGSET_X86
+#endif
+
+// Size of a bitmap container, in bytes
+#define ROARINGSET_BITMAP_BYTES (ROARINGSET_BITMAP_WORDS * sizeof(uint64_t))
+
+// Initial capacity of an array container
+#define ROARINGSET_MIN_ARRAY 4
+
+// Operation combining two containers
+typedef enum {
+  ROARINGSET_AND = 0,
+  ROARINGSET_OR = 1,
+  ROARINGSET_ANDNOT = 2
+} RoaringOp;
+
+// CPU features check, from Vector.c [internal usage]
+bool _vector_has_avx2();
+
+//////////////////
+// Kernel logic //
+//////////////////
+
+// NOTE: [perf] bitmaps are combined word by word and result bits counted in
+// the same pass: AVX2 flavor (selected at runtime) counts 4 words at once
+// with a nibble lookup table (pshufb) summed by psadbw.
+
+#ifdef ROARINGSET_X86
+
+__attribute__((target("avx2")))
+UInt _roaringset_bitmap_op_avx2(const uint64_t* words1, const uint64_t* words2,
+                                uint64_t* out, RoaringOp op)
+{
+  const __m256i lookup = _mm256_setr_epi8(
+    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+    0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i nibble = _mm256_set1_epi8(0x0f);
+  __m256i total = _mm256_setzero_si256();
+  for (UInt i = 0; i < ROARINGSET_BITMAP_WORDS; i += 4)
+  {
+    __m256i w1 = _mm256_loadu_si256((const __m256i*)(words1 + i));
+    __m256i w2 = _mm256_loadu_si256((const __m256i*)(words2 + i));
+    __m256i w;
+    if (op == ROARINGSET_AND)
+      w = _mm256_and_si256(w1, w2);
+    else if (op == ROARINGSET_OR)
+      w = _mm256_or_si256(w1, w2);
+    else
+      w = _mm256_andnot_si256(w2, w1);
+    if (out != NULL)
+      _mm256_storeu_si256((__m256i*)(out + i), w);
+    __m256i counts = _mm256_add_epi8(
+      _mm256_shuffle_epi8(lookup, _mm256_and_si256(w, nibble)),
+      _mm256_shuffle_epi8(lookup,
+                          _mm256_and_si256(_mm256_srli_epi16(w, 4), nibble)));
+    total = _mm256_add_epi64(total,
+                             _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+  }
+  return _mm256_extract_epi64(total, 0) + _mm256_extract_epi64(total, 1) +
+         _mm256_extract_epi64(total, 2) + _mm256_extract_epi64(total, 3);
+}
+
+#endif
+
+// Combine two bitmaps into out (nullable), return result cardinality
+// [internal usage]
+UInt _roaringset_bitmap_op(const uint64_t* words1, const uint64_t* words2,
+                           uint64_t* out, RoaringOp op)
+{
+#ifdef ROARINGSET_X86
+  if (_vector_has_avx2())
+    return _roaringset_bitmap_op_avx2(words1, words2, out, op);
+#endif
+  UInt count = 0;
+  for (UInt i = 0; i < ROARINGSET_BITMAP_WORDS; i++)
+  {
+    uint64_t w;
+    if (op == ROARINGSET_AND)
+      w = words1[i] & words2[i];
+    else if (op == ROARINGSET_OR)
+      w = words1[i] | words2[i];
+    else
+      w = words1[i] & ~words2[i];
+    if (out != NULL)
+      out[i] = w;
+    count += __builtin_popcountll(w);
+  }
+  return count;
+}
+
+/////////////////////
+// Container logic //
+/////////////////////
+
+// Tell if the container is a bitmap [internal usage]
+bool _roaringset_is_bitmap(RoaringContainer* container)
+{
+  return container->cardinality > ROARINGSET_ARRAY_MAX;
+}
+
+// Size of the container data, in bytes [internal usage]
+size_t _roaringset_data_bytes(RoaringContainer* container)
+{
+  if (_roaringset_is_bitmap(container))
+    return ROARINGSET_BITMAP_BYTES;
+  return container->capacity * sizeof(uint16_t);
+}
+
+// Release container data [internal usage]
+void _roaringset_free_data(RoaringSet* set, RoaringContainer* container)
+{
+  allocator_free(set->allocator, container->data,
+                 _roaringset_data_bytes(container));
+}
+
+// Index of the first value >= given one in a sorted array [internal usage]
+UInt _roaringset_lower_bound(const uint16_t* values, UInt size,
+                             uint16_t value)
+{
+  UInt low = 0, high = size;
+  while (low < high)
+  {
+    UInt middle = (low + high) / 2;
+    if (values[middle] < value)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+  return low;
+}
+
+// Lookup low bits of an element in a container [internal usage]
+bool _roaringset_container_has(RoaringContainer* container, uint16_t value)
+{
+  if (_roaringset_is_bitmap(container))
+  {
+    const uint64_t* words = container->data;
+    return (words[value >> 6] >> (value & 63)) & 1;
+  }
+  const uint16_t* values = container->data;
+  UInt i = _roaringset_lower_bound(values, container->cardinality, value);
+  return (i < container->cardinality && values[i] == value);
+}
+
+// Allocate a bitmap with the values of an array [internal usage]
+uint64_t* _roaringset_array_to_bitmap(RoaringSet* set,
+                                      const uint16_t* values, UInt size)
+{
+  uint64_t* words = allocator_alloc(set->allocator, ROARINGSET_BITMAP_BYTES);
+  memset(words, 0, ROARINGSET_BITMAP_BYTES);
+  for (UInt i = 0; i < size; i++)
+    words[values[i] >> 6] |= (uint64_t)1 << (values[i] & 63);
+  return words;
+}
+
+// Allocate a sorted array with the size bits set in a bitmap
+// [internal usage]
+uint16_t* _roaringset_bitmap_to_array(RoaringSet* set,
+                                      const uint64_t* words, UInt size)
+{
+  uint16_t* values = allocator_alloc(set->allocator, size * sizeof(uint16_t));
+  UInt k = 0;
+  for (UInt i = 0; i < ROARINGSET_BITMAP_WORDS && k < size; i++)
+  {
+    for (uint64_t w = words[i]; w != 0; w &= w - 1)
+      values[k++] = (uint16_t)(i * 64 + __builtin_ctzll(w));
+  }
+  return values;
+}
+
+// Wrap a bitmap of given cardinality into a container, as an array if
+// small enough (data is NULL if empty) [internal usage]
+RoaringContainer _roaringset_from_bitmap(RoaringSet* set, UInt key,
+                                         uint64_t* words, UInt cardinality)
+{
+  RoaringContainer container = {key, cardinality, 0, words};
+  if (cardinality <= ROARINGSET_ARRAY_MAX)
+  {
+    container.data = (cardinality > 0
+      ? _roaringset_bitmap_to_array(set, words, cardinality)
+      : NULL);
+    container.capacity = cardinality;
+    allocator_free(set->allocator, words, ROARINGSET_BITMAP_BYTES);
+  }
+  return container;
+}
+
+// Copy a container, using allocator of given set [internal usage]
+RoaringContainer _roaringset_copy_container(RoaringSet* set,
+                                            RoaringContainer* container)
+{
+  RoaringContainer copy = *container;
+  if (!_roaringset_is_bitmap(container))
+    copy.capacity = container->cardinality;
+  size_t bytes = _roaringset_data_bytes(&copy);
+  copy.data = allocator_alloc(set->allocator, bytes);
+  memcpy(copy.data, container->data, bytes);
+  return copy;
+}
+
+// Keep values of an array container which are (or not) in another
+// container [internal usage]
+RoaringContainer _roaringset_filter_array(RoaringSet* set,
+  RoaringContainer* array, RoaringContainer* other, bool keep)
+{
+  const uint16_t* values = array->data;
+  uint16_t* kept =
+    allocator_alloc(set->allocator, array->cardinality * sizeof(uint16_t));
+  UInt count = 0;
+  if (!_roaringset_is_bitmap(other))
+  {
+    // Merge two sorted arrays
+    const uint16_t* others = other->data;
+    UInt j = 0;
+    for (UInt i = 0; i < array->cardinality; i++)
+    {
+      while (j < other->cardinality && others[j] < values[i])
+        j++;
+      bool found = (j < other->cardinality && others[j] == values[i]);
+      if (found == keep)
+        kept[count++] = values[i];
+    }
+  }
+  else
+  {
+    for (UInt i = 0; i < array->cardinality; i++)
+    {
+      if (_roaringset_container_has(other, values[i]) == keep)
+        kept[count++] = values[i];
+    }
+  }
+  RoaringContainer container = {array->key, count, array->cardinality, kept};
+  if (count == 0)
+  {
+    allocator_free(set->allocator, kept,
+                   array->cardinality * sizeof(uint16_t));
+    container.data = NULL;
+  }
+  return container;
+}
+
+// Set bits of an array container values in a bitmap, return the number of
+// bits newly set [internal usage]
+UInt _roaringset_set_bits(uint64_t* words, RoaringContainer* array)
+{
+  const uint16_t* values = array->data;
+  UInt count = 0;
+  for (UInt i = 0; i < array->cardinality; i++)
+  {
+    uint64_t bit = (uint64_t)1 << (values[i] & 63);
+    count += !(words[values[i] >> 6] & bit);
+    words[values[i] >> 6] |= bit;
+  }
+  return count;
+}
+
+// Union of two containers [internal usage]
+RoaringContainer _roaringset_container_or(RoaringSet* set,
+  RoaringContainer* c1, RoaringContainer* c2)
+{
+  bool bitmap1 = _roaringset_is_bitmap(c1), bitmap2 = _roaringset_is_bitmap(c2);
+  if (!bitmap1 && !bitmap2 &&
+      c1->cardinality + c2->cardinality <= ROARINGSET_ARRAY_MAX)
+  {
+    // Merge two sorted arrays
+    const uint16_t* values1 = c1->data, * values2 = c2->data;
+    UInt capacity = c1->cardinality + c2->cardinality, i = 0, j = 0, k = 0;
+    uint16_t* values =
+      allocator_alloc(set->allocator, capacity * sizeof(uint16_t));
+    while (i < c1->cardinality && j < c2->cardinality)
+    {
+      if (values1[i] < values2[j])
+        values[k++] = values1[i++];
+      else if (values2[j] < values1[i])
+        values[k++] = values2[j++];
+      else
+      {
+        values[k++] = values1[i++];
+        j++;
+      }
+    }
+    while (i < c1->cardinality)
+      values[k++] = values1[i++];
+    while (j < c2->cardinality)
+      values[k++] = values2[j++];
+    return (RoaringContainer){c1->key, k, capacity, values};
+  }
+  uint64_t* words = allocator_alloc(set->allocator, ROARINGSET_BITMAP_BYTES);
+  UInt cardinality;
+  if (bitmap1 && bitmap2)
+  {
+    return _roaringset_from_bitmap(set, c1->key, words,
+      _roaringset_bitmap_op(c1->data, c2->data, words, ROARINGSET_OR));
+  }
+  // Start from the bitmap operand (or the first array), add the array
+  RoaringContainer* array = c2;
+  if (bitmap1 || bitmap2)
+  {
+    RoaringContainer* bitmap = (bitmap1 ? c1 : c2);
+    array = (bitmap1 ? c2 : c1);
+    memcpy(words, bitmap->data, ROARINGSET_BITMAP_BYTES);
+    cardinality = bitmap->cardinality;
+  }
+  else
+  {
+    memset(words, 0, ROARINGSET_BITMAP_BYTES);
+    cardinality = _roaringset_set_bits(words, c1);
+  }
+  cardinality += _roaringset_set_bits(words, array);
+  return _roaringset_from_bitmap(set, c1->key, words, cardinality);
+}
+
+// Combine two containers of the same key (result data is NULL if empty)
+// [internal usage]
+RoaringContainer _roaringset_combine(RoaringSet* set, RoaringContainer* c1,
+                                     RoaringContainer* c2, RoaringOp op)
+{
+  if (op == ROARINGSET_OR)
+    return _roaringset_container_or(set, c1, c2);
+  bool bitmap1 = _roaringset_is_bitmap(c1), bitmap2 = _roaringset_is_bitmap(c2);
+  if (op == ROARINGSET_AND && !bitmap1)
+    return _roaringset_filter_array(set, c1, c2, true);
+  if (op == ROARINGSET_AND && !bitmap2)
+    return _roaringset_filter_array(set, c2, c1, true);
+  if (op == ROARINGSET_ANDNOT && !bitmap1)
+    return _roaringset_filter_array(set, c1, c2, false);
+  // Bitmap result (before shrinking)
+  uint64_t* words = allocator_alloc(set->allocator, ROARINGSET_BITMAP_BYTES);
+  UInt cardinality;
+  if (bitmap2)
+    cardinality = _roaringset_bitmap_op(c1->data, c2->data, words, op);
+  else
+  {
+    // Bitmap minus array
+    memcpy(words, c1->data, ROARINGSET_BITMAP_BYTES);
+    cardinality = c1->cardinality;
+    const uint16_t* values = c2->data;
+    for (UInt i = 0; i < c2->cardinality; i++)
+    {
+      uint64_t bit = (uint64_t)1 << (values[i] & 63);
+      cardinality -= !!(words[values[i] >> 6] & bit);
+      words[values[i] >> 6] &= ~bit;
+    }
+  }
+  return _roaringset_from_bitmap(set, c1->key, words, cardinality);
+}
+
+//////////////////////
+// RoaringSet logic //
+//////////////////////
+
+RoaringSet* _roaringset_new(Allocator* allocator)
+{
+  allocator = allocator_or_default(allocator);
+  RoaringSet* set =
+    (RoaringSet*) allocator_alloc(allocator, sizeof(RoaringSet));
+  set->size = 0;
+  set->count = 0;
+  set->capacity = 0;
+  set->containers = NULL;
+  set->allocator = allocator;
+  return set;
+}
+
+// Ensure the containers array can hold capacity containers [internal usage]
+void _roaringset_reserve(RoaringSet* set, UInt capacity)
+{
+  if (capacity <= set->capacity)
+    return;
+  set->containers = allocator_realloc(set->allocator, set->containers,
+    set->capacity * sizeof(RoaringContainer),
+    capacity * sizeof(RoaringContainer));
+  set->capacity = capacity;
+}
+
+// Append a (non-empty) container with the greatest key [internal usage]
+void _roaringset_append(RoaringSet* set, RoaringContainer* container)
+{
+  if (set->count == set->capacity)
+    _roaringset_reserve(set, set->capacity > 0 ? 2 * set->capacity : 4);
+  set->containers[set->count++] = *container;
+  set->size += container->cardinality;
+}
+
+// Find the container of given key, or its insertion index [internal usage]
+bool _roaringset_find(RoaringSet* set, UInt key, UInt* index)
+{
+  UInt low = 0, high = set->count;
+  while (low < high)
+  {
+    UInt middle = (low + high) / 2;
+    if (set->containers[middle].key < key)
+      low = middle + 1;
+    else
+      high = middle;
+  }
+  *index = low;
+  return (low < set->count && set->containers[low].key == key);
+}
+
+RoaringSet* roaringset_copy(RoaringSet* set)
+{
+  RoaringSet* copy = _roaringset_new(set->allocator);
+  _roaringset_reserve(copy, set->count);
+  for (UInt i = 0; i < set->count; i++)
+  {
+    RoaringContainer container =
+      _roaringset_copy_container(copy, set->containers + i);
+    _roaringset_append(copy, &container);
+  }
+  return copy;
+}
+
+bool roaringset_empty(RoaringSet* set)
+{
+  return (set->size == 0);
+}
+
+UInt roaringset_size(RoaringSet* set)
+{
+  return set->size;
+}
+
+size_t roaringset_memory(RoaringSet* set)
+{
+  size_t bytes =
+    sizeof(RoaringSet) + set->capacity * sizeof(RoaringContainer);
+  for (UInt i = 0; i < set->count; i++)
+    bytes += _roaringset_data_bytes(set->containers + i);
+  return bytes;
+}
+
+bool roaringset_has(RoaringSet* set, UInt item)
+{
+  UInt index;
+  if (!_roaringset_find(set, item >> 16, &index))
+    return false;
+  return _roaringset_container_has(set->containers + index,
+                                   (uint16_t)(item & 0xFFFF));
+}
+
+void roaringset_add(RoaringSet* set, UInt item)
+{
+  UInt key = item >> 16, index;
+  uint16_t value = (uint16_t)(item & 0xFFFF);
+  if (!_roaringset_find(set, key, &index))
+  {
+    // New array container, inserted at index
+    if (set->count == set->capacity)
+      _roaringset_reserve(set, set->capacity > 0 ? 2 * set->capacity : 4);
+    memmove(set->containers + index + 1, set->containers + index,
+            (set->count - index) * sizeof(RoaringContainer));
+    set->containers[index] = (RoaringContainer){key, 0, ROARINGSET_MIN_ARRAY,
+      allocator_alloc(set->allocator,
+                      ROARINGSET_MIN_ARRAY * sizeof(uint16_t))};
+    set->count++;
+  }
+  RoaringContainer* container = set->containers + index;
+  if (_roaringset_is_bitmap(container))
+  {
+    uint64_t* words = container->data;
+    uint64_t bit = (uint64_t)1 << (value & 63);
+    if (words[value >> 6] & bit)
+      return;
+    words[value >> 6] |= bit;
+  }
+  else
+  {
+    uint16_t* values = container->data;
+    UInt i = _roaringset_lower_bound(values, container->cardinality, value);
+    if (i < container->cardinality && values[i] == value)
+      return;
+    if (container->cardinality == ROARINGSET_ARRAY_MAX)
+    {
+      // Full array: switch to a bitmap
+      uint64_t* words =
+        _roaringset_array_to_bitmap(set, values, container->cardinality);
+      words[value >> 6] |= (uint64_t)1 << (value & 63);
+      _roaringset_free_data(set, container);
+      container->data = words;
+      container->capacity = 0;
+    }
+    else
+    {
+      if (container->cardinality == container->capacity)
+      {
+        UInt capacity = 2 * container->capacity;
+        if (capacity > ROARINGSET_ARRAY_MAX)
+          capacity = ROARINGSET_ARRAY_MAX;
+        values = container->data = allocator_realloc(set->allocator, values,
+          container->capacity * sizeof(uint16_t),
+          capacity * sizeof(uint16_t));
+        container->capacity = capacity;
+      }
+      memmove(values + i + 1, values + i,
+              (container->cardinality - i) * sizeof(uint16_t));
+      values[i] = value;
+    }
+  }
+  container->cardinality++;
+  set->size++;
+}
+
+void roaringset_delete(RoaringSet* set, UInt item)
+{
+  UInt index;
+  if (!_roaringset_find(set, item >> 16, &index))
+    return;
+  uint16_t value = (uint16_t)(item & 0xFFFF);
+  RoaringContainer* container = set->containers + index;
+  if (_roaringset_is_bitmap(container))
+  {
+    uint64_t* words = container->data;
+    uint64_t bit = (uint64_t)1 << (value & 63);
+    if (!(words[value >> 6] & bit))
+      return;
+    words[value >> 6] &= ~bit;
+    if (container->cardinality - 1 == ROARINGSET_ARRAY_MAX)
+    {
+      // Back to an array
+      container->data =
+        _roaringset_bitmap_to_array(set, words, ROARINGSET_ARRAY_MAX);
+      allocator_free(set->allocator, words, ROARINGSET_BITMAP_BYTES);
+      container->capacity = ROARINGSET_ARRAY_MAX;
+    }
+  }
+  else
+  {
+    uint16_t* values = container->data;
+    UInt i = _roaringset_lower_bound(values, container->cardinality, value);
+    if (i == container->cardinality || values[i] != value)
+      return;
+    if (container->cardinality == 1)
+    {
+      // Last element: remove the container
+      _roaringset_free_data(set, container);
+      memmove(container, container + 1,
+              (set->count - index - 1) * sizeof(RoaringContainer));
+      set->count--;
+      set->size--;
+      return;
+    }
+    memmove(values + i, values + i + 1,
+            (container->cardinality - i - 1) * sizeof(uint16_t));
+  }
+  container->cardinality--;
+  set->size--;
+}
+
+//////////////////////////////
+// RoaringSet algebra logic //
+//////////////////////////////
+
+// Combine containers of two sets into a new set, walking both sorted keys
+// sequences [internal usage]
+RoaringSet* _roaringset_merge(RoaringSet* set1, RoaringSet* set2,
+                              RoaringOp op)
+{
+  RoaringSet* result = _roaringset_new(set1->allocator);
+  _roaringset_reserve(result,
+    op == ROARINGSET_OR ? set1->count + set2->count : set1->count);
+  UInt i = 0, j = 0;
+  while (i < set1->count || j < set2->count)
+  {
+    RoaringContainer* c1 = (i < set1->count ? set1->containers + i : NULL);
+    RoaringContainer* c2 = (j < set2->count ? set2->containers + j : NULL);
+    RoaringContainer container;
+    if (c2 == NULL || (c1 != NULL && c1->key < c2->key))
+    {
+      // Key only in set1
+      i++;
+      if (op == ROARINGSET_AND)
+        continue;
+      container = _roaringset_copy_container(result, c1);
+    }
+    else if (c1 == NULL || c2->key < c1->key)
+    {
+      // Key only in set2
+      j++;
+      if (op != ROARINGSET_OR)
+        continue;
+      container = _roaringset_copy_container(result, c2);
+    }
+    else
+    {
+      i++;
+      j++;
+      container = _roaringset_combine(result, c1, c2, op);
+      if (container.cardinality == 0)
+        continue;
+    }
+    _roaringset_append(result, &container);
+  }
+  return result;
+}
+
+// Replace content of set by content of other, then destroy other
+// [internal usage]
+void _roaringset_take(RoaringSet* set, RoaringSet* other)
+{
+  roaringset_clear(set);
+  allocator_free(set->allocator, set->containers,
+                 set->capacity * sizeof(RoaringContainer));
+  *set = *other;
+  allocator_free(other->allocator, other, sizeof(RoaringSet));
+}
+
+RoaringSet* roaringset_union(RoaringSet* set1, RoaringSet* set2)
+{
+  return _roaringset_merge(set1, set2, ROARINGSET_OR);
+}
+
+RoaringSet* roaringset_intersect(RoaringSet* set1, RoaringSet* set2)
+{
+  return _roaringset_merge(set1, set2, ROARINGSET_AND);
+}
+
+RoaringSet* roaringset_difference(RoaringSet* set1, RoaringSet* set2)
+{
+  return _roaringset_merge(set1, set2, ROARINGSET_ANDNOT);
+}
+
+void roaringset_union_inplace(RoaringSet* set, RoaringSet* other)
+{
+  _roaringset_take(set, _roaringset_merge(set, other, ROARINGSET_OR));
+}
+
+void roaringset_intersect_inplace(RoaringSet* set, RoaringSet* other)
+{
+  _roaringset_take(set, _roaringset_merge(set, other, ROARINGSET_AND));
+}
+
+void roaringset_difference_inplace(RoaringSet* set, RoaringSet* other)
+{
+  _roaringset_take(set, _roaringset_merge(set, other, ROARINGSET_ANDNOT));
+}
+
+UInt roaringset_intersect_size(RoaringSet* set1, RoaringSet* set2)
+{
+  UInt count = 0, i = 0, j = 0;
+  while (i < set1->count && j < set2->count)
+  {
+    RoaringContainer* c1 = set1->containers + i, * c2 = set2->containers + j;
+    if (c1->key < c2->key)
+      i++;
+    else if (c2->key < c1->key)
+      j++;
+    else
+    {
+      if (_roaringset_is_bitmap(c1) && _roaringset_is_bitmap(c2))
+      {
+        count += _roaringset_bitmap_op(c1->data, c2->data, NULL,
+                                       ROARINGSET_AND);
+      }
+      else
+      {
+        // Probe the other container with values of the array
+        RoaringContainer* array = (_roaringset_is_bitmap(c1) ? c2 : c1);
+        RoaringContainer* other = (array == c1 ? c2 : c1);
+        const uint16_t* values = array->data;
+        for (UInt k = 0; k < array->cardinality; k++)
+          count += _roaringset_container_has(other, values[k]);
+      }
+      i++;
+      j++;
+    }
+  }
+  return count;
+}
+
+Vector* roaringset_to_vector(RoaringSet* set)
+{
+  Vector* v = _vector_new(sizeof(UInt), set->allocator);
+  vector_resize(v, set->size);
+  UInt* items = (UInt*) v->datas, k = 0;
+  for (UInt i = 0; i < set->count; i++)
+  {
+    RoaringContainer* container = set->containers + i;
+    UInt high = container->key << 16;
+    if (_roaringset_is_bitmap(container))
+    {
+      const uint64_t* words = container->data;
+      for (UInt w = 0; w < ROARINGSET_BITMAP_WORDS; w++)
+      {
+        for (uint64_t bits = words[w]; bits != 0; bits &= bits - 1)
+          items[k++] = high | (w * 64 + __builtin_ctzll(bits));
+      }
+    }
+    else
+    {
+      const uint16_t* values = container->data;
+      for (UInt j = 0; j < container->cardinality; j++)
+        items[k++] = high | values[j];
+    }
+  }
+  return v;
+}
+
+void roaringset_clear(RoaringSet* set)
+{
+  for (UInt i = 0; i < set->count; i++)
+    _roaringset_free_data(set, set->containers + i);
+  set->count = 0;
+  set->size = 0;
+}
+
+void roaringset_destroy(RoaringSet* set)
+{
+  roaringset_clear(set);
+  allocator_free(set->allocator, set->containers,
+                 set->capacity * sizeof(RoaringContainer));
+  allocator_free(set->allocator, set, sizeof(RoaringSet));
+}
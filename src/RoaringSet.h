@@ -0,0 +1,213 @@
+/**
+ * @file RoaringSet.h
+ */
+
+#ifndef CGDS_ROARING_SET_H
+#define CGDS_ROARING_SET_H
+
+#include <stdlib.h>
+#include <string.h>
+#include "cgds/safe_alloc.h"
+#include "cgds/types.h"
+#include "cgds/Vector.h"
+
+/**
+ * @brief Maximal cardinality of an array container; beyond, it becomes a
+ * bitmap (which takes as much memory as a full array).
+ */
+#define ROARINGSET_ARRAY_MAX 4096
+
+/**
+ * @brief Number of 64-bits words in a bitmap container (2^16 bits).
+ */
+#define ROARINGSET_BITMAP_WORDS 1024
+
+/**
+ * @brief Elements sharing the same high bits (element >> 16).
+ *
+ * Low 16 bits of the elements are stored either as a sorted array
+ * (cardinality <= ROARINGSET_ARRAY_MAX) or as a bitmap of 2^16 bits.
+ */
+typedef struct RoaringContainer {
+  UInt key; ///< High bits of the elements.
+  uint32_t cardinality; ///< Number of elements (always > 0).
+  uint32_t capacity; ///< Capacity of the array (unused for a bitmap).
+  void* data; ///< uint16_t sorted values, or uint64_t bitmap words.
+} RoaringContainer;
+
+/**
+ * @brief Set of unsigned integers, as a compressed (roaring) bitmap.
+ *
+ * Containers are sorted by key in a flat array, found by binary search.
+ * Sparse containers cost 2 bytes per element, dense ones 1 bit per
+ * possible element. Set algebra combines bitmaps word by word, counting
+ * result bits on the fly (AVX2 kernels when the CPU supports them).
+ */
+typedef struct RoaringSet {
+  UInt size; ///< Count elements in the set.
+  UInt count; ///< Number of containers.
+  UInt capacity; ///< Capacity of the containers array.
+  RoaringContainer* containers; ///< Containers, sorted by key.
+  Allocator* allocator; ///< Allocator of the struct and containers.
+} RoaringSet;
+
+/**
+ * @brief Return an allocated and initialized set.
+ */
+RoaringSet* _roaringset_new(
+  Allocator* allocator ///< Memory allocator (NULL: default one).
+);
+
+/**
+ * @brief Return an allocated and initialized set.
+ *
+ * Usage: RoaringSet* roaringset_new()
+ */
+#define roaringset_new() \
+  _roaringset_new(NULL)
+
+/**
+ * @brief Return an allocated and initialized set, using given allocator.
+ *
+ * Usage: RoaringSet* roaringset_new_with(Allocator* a)
+ */
+#define roaringset_new_with(allocator) \
+  _roaringset_new(allocator)
+
+/**
+ * @brief Copy constructor.
+ */
+RoaringSet* roaringset_copy(
+  RoaringSet* set ///< "this" pointer.
+);
+
+/**
+ * @brief Check if the set is empty.
+ */
+bool roaringset_empty(
+  RoaringSet* set ///< "this" pointer.
+);
+
+/**
+ * @brief Return current size.
+ */
+UInt roaringset_size(
+  RoaringSet* set ///< "this" pointer.
+);
+
+/**
+ * @brief Return the number of bytes used by the set.
+ */
+size_t roaringset_memory(
+  RoaringSet* set ///< "this" pointer.
+);
+
+/**
+ * @brief Lookup given element.
+ */
+bool roaringset_has(
+  RoaringSet* set, ///< "this" pointer.
+  UInt item ///< Element to search.
+);
+
+/**
+ * @brief Add an item to the set.
+ */
+void roaringset_add(
+  RoaringSet* set, ///< "this" pointer.
+  UInt item ///< Element to add.
+);
+
+/**
+ * @brief Remove the given item.
+ */
+void roaringset_delete(
+  RoaringSet* set, ///< "this" pointer.
+  UInt item ///< Element to delete.
+);
+
+//**************************
+// RoaringSet algebra logic
+//**************************
+
+// NOTE: results use the allocator of the first operand.
+
+/**
+ * @brief Return a new set with elements of set1 or set2.
+ */
+RoaringSet* roaringset_union(
+  RoaringSet* set1, ///< First operand.
+  RoaringSet* set2 ///< Second operand.
+);
+
+/**
+ * @brief Return a new set with elements of set1 and set2.
+ */
+RoaringSet* roaringset_intersect(
+  RoaringSet* set1, ///< First operand.
+  RoaringSet* set2 ///< Second operand.
+);
+
+/**
+ * @brief Return a new set with elements of set1 not in set2.
+ */
+RoaringSet* roaringset_difference(
+  RoaringSet* set1, ///< First operand.
+  RoaringSet* set2 ///< Second operand.
+);
+
+/**
+ * @brief Add elements of other to set.
+ */
+void roaringset_union_inplace(
+  RoaringSet* set, ///< "this" pointer.
+  RoaringSet* other ///< Set to merge into "this".
+);
+
+/**
+ * @brief Keep only elements of set also in other.
+ */
+void roaringset_intersect_inplace(
+  RoaringSet* set, ///< "this" pointer.
+  RoaringSet* other ///< Set to intersect "this" with.
+);
+
+/**
+ * @brief Remove elements of other from set.
+ */
+void roaringset_difference_inplace(
+  RoaringSet* set, ///< "this" pointer.
+  RoaringSet* other ///< Set of elements to remove from "this".
+);
+
+/**
+ * @brief Return the number of elements of set1 and set2, without building
+ * the intersection.
+ */
+UInt roaringset_intersect_size(
+  RoaringSet* set1, ///< First operand.
+  RoaringSet* set2 ///< Second operand.
+);
+
+/**
+ * @brief Initialize a vector with set elements (UInt), in increasing order.
+ */
+Vector* roaringset_to_vector(
+  RoaringSet* set ///< "this" pointer.
+);
+
+/**
+ * @brief Clear the entire set.
+ */
+void roaringset_clear(
+  RoaringSet* set ///< "this" pointer.
+);
+
+/**
+ * @brief Destroy the set: free containers.
+ */
+void roaringset_destroy(
+  RoaringSet* set ///< "this" pointer.
+);
+
+#endif
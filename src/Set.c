@@ -3,50 +3,71 @@
  */
 
 #include "cgds/Set.h"
+#include <pthread.h>
+#include <unistd.h>
 
-void _set_init(Set* set, size_t dataSize, size_t hashSize,
-               UInt (*getHash)(void*, size_t))
+// Minimal number of slots
+#define SET_MIN_SIZE 8
+
+// Set algebra: minimal number of slots scanned by a thread, and maximal
+// number of threads
+#define SET_PARALLEL_SLOTS 32768
+#define SET_MAX_THREADS 16
+
+// Key hash function, from HashTable.c [internal usage]
+UInt _compute_hash(const void* key, size_t length);
+
+// Allocate empty slots arrays of given size [internal usage]
+void _set_alloc_slots(Set* set, size_t hashSize)
 {
   set->hashSize = hashSize;
+  set->used = 0;
+  set->items = allocator_alloc(set->allocator, hashSize * set->dataSize);
+  set->meta = allocator_alloc(set->allocator, hashSize);
+  memset(set->meta, SET_EMPTY, hashSize);
+}
+
+// Release slots arrays [internal usage]
+void _set_free_slots(Set* set)
+{
+  allocator_free(set->allocator, set->items, set->hashSize * set->dataSize);
+  allocator_free(set->allocator, set->meta, set->hashSize);
+}
+
+void _set_init(Set* set, size_t dataSize, size_t hashSize,
+               UInt (*getHash)(void*, size_t), Allocator* allocator)
+{
   set->dataSize = dataSize;
-  set->head = safe_malloc(hashSize * sizeof(SetCell*));
-  for (UInt i = 0; i < hashSize; i++)
-    set->head[i] = NULL;
+  set->allocator = allocator_or_default(allocator);
+  size_t slotsCount = SET_MIN_SIZE;
+  while (slotsCount < hashSize)
+    slotsCount <<= 1;
+  _set_alloc_slots(set, slotsCount);
   set->size = 0;
   set->getHash = getHash; //may be NULL
+  set->filter = NULL;
 }
 
-Set* _set_new(size_t dataSize, size_t hashSize, UInt (*getHash)(void*, size_t))
+Set* _set_new(size_t dataSize, size_t hashSize,
+              UInt (*getHash)(void*, size_t), Allocator* allocator)
 {
-  Set* set = (Set*) safe_malloc(sizeof(Set));
-  _set_init(set, dataSize, hashSize, getHash);
+  allocator = allocator_or_default(allocator);
+  Set* set = (Set*) allocator_alloc(allocator, sizeof(Set));
+  _set_init(set, dataSize, hashSize, getHash, allocator);
   return set;
 }
 
 Set* set_copy(Set* set)
 {
-  Set* setCopy = _set_new(set->dataSize, set->hashSize, set->getHash);
+  Set* setCopy = _set_new(
+    set->dataSize, set->hashSize, set->getHash, set->allocator);
+  // Same slots count: flat arrays are copied as they are
+  memcpy(setCopy->items, set->items, set->hashSize * set->dataSize);
+  memcpy(setCopy->meta, set->meta, set->hashSize);
   setCopy->size = set->size;
-  for (UInt i = 0; i < set->hashSize; i++)
-  {
-    SetCell *cell = set->head[i],
-             *cellCopy = setCopy->head[i],
-             *prev = NULL;
-    while (cell != NULL)
-    {
-      // cellCopy == NULL (from empty list)
-      cellCopy = (SetCell*) safe_malloc(sizeof(SetCell));
-      cellCopy->item = safe_malloc(set->dataSize);
-      memcpy(cellCopy->item, cell->item, set->dataSize);
-      if (prev == NULL)
-        setCopy->head[i] = cellCopy;
-      else
-        prev->next = cellCopy;
-      prev = cellCopy;
-      cell = cell->next;
-    }
-    if (cellCopy != NULL) cellCopy->next = NULL;
-  }
+  setCopy->used = set->used;
+  if (set->filter != NULL)
+    setCopy->filter = bloomfilter_copy(set->filter);
   return setCopy;
 }
 
@@ -60,120 +81,459 @@ UInt set_size(Set* set)
   return set->size;
 }
 
-// Function (string) key --> (integer) hash [internal usage]
-// Default function. Can be changed (see hashtable_new())
-UInt _set_compute_hash(void* key, size_t dataSize, size_t hashSize)
+// Hash of an item: default (bytes) hash, or custom one [internal usage]
+UInt _set_hash(Set* set, void* item)
 {
-  UInt res = 0;
-  // Interpret the bytes in key as a piece of string
-  unsigned char* keyStr = (unsigned char*)key;
-  for (size_t i = 0; i < dataSize; i++)
-    // NOTE: '31' from here https://stackoverflow.com/a/4384446
-    res = (*(keyStr+i) + 31 * res) % hashSize;
-  return res;
+  if (set->getHash == NULL)
+    return _compute_hash(item, set->dataSize);
+  return set->getHash(item, set->hashSize);
 }
 
-// Get hash index from key [internal usage]
-UInt _set_get_hindex(Set* set, void* key)
+// Control byte of a full slot: 7 bits of the (mixed) hash [internal usage]
+uint8_t _set_tag(UInt hash)
+{
+  // NOTE: custom hashes may be small integers: mix before taking top bits
+  return (uint8_t)((hash * 0x9e3779b97f4a7c15ULL) >> 57);
+}
+
+// Item at given slot [internal usage]
+char* _set_item(Set* set, UInt slot)
+{
+  return set->items + slot * set->dataSize;
+}
+
+// Compare two items, without a memcmp call for word sizes [internal usage]
+bool _set_equal(Set* set, void* item1, void* item2)
+{
+  switch (set->dataSize)
+  {
+    case 4:
+    {
+      uint32_t a, b;
+      memcpy(&a, item1, 4);
+      memcpy(&b, item2, 4);
+      return (a == b);
+    }
+    case 8:
+    {
+      uint64_t a, b;
+      memcpy(&a, item1, 8);
+      memcpy(&b, item2, 8);
+      return (a == b);
+    }
+    default:
+      return (memcmp(item1, item2, set->dataSize) == 0);
+  }
+}
+
+// Hash of an item for the filter: custom hashes depend on the slots count,
+// so the default one is used instead [internal usage]
+UInt _set_filter_hash(Set* set, void* item, UInt hash)
 {
   if (set->getHash == NULL)
-    return _set_compute_hash(key, set->dataSize, set->hashSize);
-  return set->getHash(key, set->hashSize);
+    return hash;
+  return _compute_hash(item, set->dataSize);
+}
+
+// (Re)build the filter from all items, sized for the slots count
+// [internal usage]
+void _set_build_filter(Set* set, Real falsePositiveRate)
+{
+  if (set->filter != NULL)
+    bloomfilter_destroy(set->filter);
+  set->filter = _bloomfilter_new(
+    set->hashSize * 3 / 4, falsePositiveRate, set->allocator);
+  for (UInt i = 0; i < set->hashSize; i++)
+  {
+    if (!(set->meta[i] & SET_EMPTY))
+    {
+      bloomfilter_add_hash(set->filter,
+                           _compute_hash(_set_item(set, i), set->dataSize));
+    }
+  }
+}
+
+// Index of the slot holding item, or hashSize if absent [internal usage]
+UInt _set_find(Set* set, void* item, UInt hash)
+{
+  UInt mask = set->hashSize - 1,
+       i = hash & mask;
+  uint8_t tag = _set_tag(hash);
+  // NOTE: load factor < 1, so an empty slot ends the probe sequence
+  while (set->meta[i] != SET_EMPTY)
+  {
+    if (set->meta[i] == tag && _set_equal(set, _set_item(set, i), item))
+      return i;
+    i = (i + 1) & mask;
+  }
+  return set->hashSize;
+}
+
+// Copy an item in the first free slot of its probe sequence [internal usage]
+void _set_place(Set* set, void* item, UInt hash)
+{
+  UInt mask = set->hashSize - 1,
+       i = hash & mask;
+  while (!(set->meta[i] & SET_EMPTY))
+    i = (i + 1) & mask;
+  if (set->meta[i] == SET_EMPTY)
+    set->used++;
+  memcpy(_set_item(set, i), item, set->dataSize);
+  set->meta[i] = _set_tag(hash);
+}
+
+// Move all items into new slots arrays (tombstones vanish) [internal usage]
+void _set_rehash(Set* set, size_t newHashSize)
+{
+  char* items = set->items;
+  uint8_t* meta = set->meta;
+  size_t hashSize = set->hashSize;
+  _set_alloc_slots(set, newHashSize);
+  // NOTE: hashes are recomputed (custom ones depend on slots count)
+  for (UInt i = 0; i < hashSize; i++)
+  {
+    if (!(meta[i] & SET_EMPTY))
+    {
+      void* item = items + i * set->dataSize;
+      _set_place(set, item, _set_hash(set, item));
+    }
+  }
+  allocator_free(set->allocator, items, hashSize * set->dataSize);
+  allocator_free(set->allocator, meta, hashSize);
+  // Deleted items leave the filter, which grows with the slots
+  if (set->filter != NULL)
+    _set_build_filter(set, set->filter->falsePositiveRate);
+}
+
+// Tell if the filter proves item absent [internal usage]
+bool _set_filter_rejects(Set* set, void* item, UInt hash)
+{
+  return (set->filter != NULL &&
+          !bloomfilter_has_hash(set->filter,
+                                _set_filter_hash(set, item, hash)));
 }
 
 bool set_has(Set* set, void* item)
 {
-  UInt hashIdx = _set_get_hindex(set, item);
-  SetCell* cell = set->head[hashIdx];
-  while (cell != NULL)
+  UInt hash = _set_hash(set, item);
+  if (_set_filter_rejects(set, item, hash))
+    return false;
+  return (_set_find(set, item, hash) < set->hashSize);
+}
+
+// Add an item known to be absent [internal usage]
+void _set_add_new(Set* set, void* item, UInt hash)
+{
+  // Keep load factor (with tombstones) under 3/4
+  if ((set->used + 1) * 4 > set->hashSize * 3)
   {
-    if (memcmp(cell->item, item, set->dataSize) == 0)
-      return true;
-    cell = cell->next;
+    // Grow if really full, otherwise just clean tombstones
+    size_t newHashSize = set->hashSize;
+    if ((set->size + 1) * 2 > newHashSize)
+      newHashSize *= 2;
+    _set_rehash(set, newHashSize);
+    hash = _set_hash(set, item);
   }
-  return false;
+  _set_place(set, item, hash);
+  set->size++;
+  if (set->filter != NULL)
+    bloomfilter_add_hash(set->filter, _set_filter_hash(set, item, hash));
 }
 
 void _set_add(Set* set, void* item)
 {
-  UInt hashIdx = _set_get_hindex(set, item);
-  SetCell *cell = set->head[hashIdx],
-          *prev = NULL;
-  while (cell != NULL)
+  UInt hash = _set_hash(set, item);
+  if (!_set_filter_rejects(set, item, hash) &&
+      _set_find(set, item, hash) < set->hashSize)
+    // Already here: nothing to do
+    return;
+  _set_add_new(set, item, hash);
+}
+
+void _set_delete(Set* set, void* item)
+{
+  UInt hash = _set_hash(set, item);
+  if (_set_filter_rejects(set, item, hash))
+    return;
+  UInt i = _set_find(set, item, hash);
+  if (i == set->hashSize)
+    return;
+  UInt next = (i + 1) & (set->hashSize - 1);
+  if (set->meta[next] == SET_EMPTY)
   {
-    if (memcmp(cell->item, item, set->dataSize) == 0)
-      // Already here: nothing to do
-      return;
-    prev = cell;
-    cell = cell->next;
+    // No probe sequence goes through this slot: it can be freed
+    set->meta[i] = SET_EMPTY;
+    set->used--;
   }
-  // New element: insert after prev (which may be NULL)
-  SetCell* newCell = (SetCell*) safe_malloc(sizeof(SetCell));
-  newCell->item = safe_malloc(set->dataSize);
-  memcpy(newCell->item, item, set->dataSize);
-  newCell->next = NULL;
-  if (prev == NULL)
-    set->head[hashIdx] = newCell;
   else
-    prev->next = newCell;
-  set->size++;
+    set->meta[i] = SET_DELETED;
+  set->size--;
 }
 
-void _set_delete(Set* set, void* item)
+void set_reserve(Set* set, UInt count)
 {
-  UInt hashIdx = _set_get_hindex(set, item);
-  SetCell *cell = set->head[hashIdx],
-          *prev = NULL;
-  while (cell != NULL)
+  size_t hashSize = set->hashSize;
+  while (count * 4 > hashSize * 3)
+    hashSize *= 2;
+  if (hashSize > set->hashSize)
+    _set_rehash(set, hashSize);
+}
+
+void set_attach_filter(Set* set, Real falsePositiveRate)
+{
+  _set_build_filter(set, falsePositiveRate);
+}
+
+void set_detach_filter(Set* set)
+{
+  if (set->filter != NULL)
+    bloomfilter_destroy(set->filter);
+  set->filter = NULL;
+}
+
+///////////////////////
+// Set algebra logic //
+///////////////////////
+
+// Scan of a slots range, copying items whose membership in other is
+// inOther [internal usage]
+typedef struct SetFilterTask {
+  Set* set; ///< Set to scan.
+  Set* other; ///< Set to test items against.
+  bool inOther; ///< Keep items in other (or not in other).
+  UInt begin; ///< First slot of the range.
+  UInt end; ///< End slot of the range (excluded).
+  char* output; ///< Destination of kept items.
+  UInt count; ///< Number of kept items.
+} SetFilterTask;
+
+void* _set_filter_task(void* arg)
+{
+  SetFilterTask* task = (SetFilterTask*)arg;
+  Set* set = task->set;
+  task->count = 0;
+  for (UInt i = task->begin; i < task->end; i++)
   {
-    if (memcmp(cell->item, item, set->dataSize) == 0)
+    if (set->meta[i] & SET_EMPTY)
+      continue;
+    char* item = _set_item(set, i);
+    if (set_has(task->other, item) == task->inOther)
     {
-      if (prev == NULL)
-        set->head[hashIdx] = cell->next;
-      else
-        prev->next = cell->next;
-      safe_free(cell->item);
-      safe_free(cell);
-      set->size--;
-      break;
+      memcpy(task->output + task->count * set->dataSize, item,
+             set->dataSize);
+      task->count++;
     }
-    prev = cell;
-    cell = cell->next;
   }
+  return NULL;
 }
 
-Vector* set_to_vector(Set* set) {
-  Vector* v = _vector_new(set->dataSize);
-  for (UInt i = 0; i < set->hashSize; i++) {
-    SetCell* cell = set->head[i];
-    while (cell != NULL) {
-      _vector_push(v, cell->item);
-      cell = cell->next;
+// Copy items of set whose membership in other is inOther into a buffer of
+// set->size items (returned), by slots ranges scanned in parallel.
+// Items kept by task t are tasks[t].output[0 .. tasks[t].count[ [internal usage]
+char* _set_filter(Set* set, Set* other, bool inOther,
+                  SetFilterTask* tasks, UInt* tasksCount)
+{
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  UInt threads = set->hashSize / SET_PARALLEL_SLOTS;
+  if (threads > (UInt)cpus)
+    threads = (cpus > 1 ? (UInt)cpus : 1);
+  if (threads > SET_MAX_THREADS)
+    threads = SET_MAX_THREADS;
+  if (threads == 0)
+    threads = 1;
+  // NOTE: one buffer (allocated here, not in threads), each range writing
+  // after the items of previous ranges
+  char* buffer = (char*) allocator_alloc(
+    set->allocator, (set->size > 0 ? set->size : 1) * set->dataSize);
+  UInt offset = 0;
+  for (UInt t = 0; t < threads; t++)
+  {
+    UInt begin = t * (set->hashSize / threads),
+         end = (t + 1 < threads ? begin + set->hashSize / threads
+                                : set->hashSize);
+    tasks[t] = (SetFilterTask) {
+      .set = set, .other = other, .inOther = inOther,
+      .begin = begin, .end = end,
+      .output = buffer + offset * set->dataSize, .count = 0
+    };
+    for (UInt i = begin; i < end; i++)
+      offset += !(set->meta[i] & SET_EMPTY);
+  }
+  pthread_t pthreads[SET_MAX_THREADS];
+  bool forked[SET_MAX_THREADS];
+  for (UInt t = 1; t < threads; t++)
+  {
+    forked[t] =
+      (pthread_create(&pthreads[t], NULL, _set_filter_task, &tasks[t]) == 0);
+  }
+  _set_filter_task(&tasks[0]);
+  for (UInt t = 1; t < threads; t++)
+  {
+    if (forked[t])
+      pthread_join(pthreads[t], NULL);
+    else
+      // Could not create a thread: do the work here
+      _set_filter_task(&tasks[t]);
+  }
+  *tasksCount = threads;
+  return buffer;
+}
+
+// Release a buffer from _set_filter() [internal usage]
+void _set_filter_free(Set* set, char* buffer)
+{
+  allocator_free(set->allocator, buffer,
+                 (set->size > 0 ? set->size : 1) * set->dataSize);
+}
+
+// Count items kept by filter tasks [internal usage]
+UInt _set_filter_count(SetFilterTask* tasks, UInt tasksCount)
+{
+  UInt count = 0;
+  for (UInt t = 0; t < tasksCount; t++)
+    count += tasks[t].count;
+  return count;
+}
+
+// Add (absent) items kept by filter tasks to set [internal usage]
+void _set_add_filtered(Set* set, SetFilterTask* tasks, UInt tasksCount)
+{
+  set_reserve(set, set->size + _set_filter_count(tasks, tasksCount));
+  for (UInt t = 0; t < tasksCount; t++)
+  {
+    for (UInt j = 0; j < tasks[t].count; j++)
+    {
+      char* item = tasks[t].output + j * set->dataSize;
+      _set_add_new(set, item, _set_hash(set, item));
     }
   }
-  return v;
 }
 
-void set_clear(Set* set)
+// Delete items kept by filter tasks from set [internal usage]
+void _set_delete_filtered(Set* set, SetFilterTask* tasks, UInt tasksCount)
 {
-  for (UInt i = 0; i < set->hashSize; i++)
+  for (UInt t = 0; t < tasksCount; t++)
+  {
+    for (UInt j = 0; j < tasks[t].count; j++)
+      _set_delete(set, tasks[t].output + j * tasks[t].set->dataSize);
+  }
+}
+
+// Return a new empty set like given one, with room for count items
+// [internal usage]
+Set* _set_new_like(Set* set, UInt count)
+{
+  Set* result = _set_new(set->dataSize, 0, set->getHash, set->allocator);
+  set_reserve(result, count);
+  if (set->filter != NULL)
+    set_attach_filter(result, set->filter->falsePositiveRate);
+  return result;
+}
+
+void set_union_inplace(Set* set, Set* other)
+{
+  SetFilterTask tasks[SET_MAX_THREADS];
+  UInt tasksCount;
+  char* buffer = _set_filter(other, set, false, tasks, &tasksCount);
+  _set_add_filtered(set, tasks, tasksCount);
+  _set_filter_free(other, buffer);
+}
+
+void set_intersect_inplace(Set* set, Set* other)
+{
+  SetFilterTask tasks[SET_MAX_THREADS];
+  UInt tasksCount;
+  UInt size = set->size;
+  char* buffer = _set_filter(set, other, false, tasks, &tasksCount);
+  _set_delete_filtered(set, tasks, tasksCount);
+  // NOTE: buffer was sized for the set before deletions
+  allocator_free(set->allocator, buffer, (size > 0 ? size : 1) * set->dataSize);
+}
+
+void set_difference_inplace(Set* set, Set* other)
+{
+  SetFilterTask tasks[SET_MAX_THREADS];
+  UInt tasksCount;
+  // Scan the smaller set for common items
+  Set* scanned = (other->size < set->size ? other : set);
+  UInt size = scanned->size;
+  char* buffer = _set_filter(
+    scanned, (scanned == set ? other : set), true, tasks, &tasksCount);
+  _set_delete_filtered(set, tasks, tasksCount);
+  allocator_free(
+    scanned->allocator, buffer, (size > 0 ? size : 1) * scanned->dataSize);
+}
+
+Set* set_union(Set* set1, Set* set2)
+{
+  // Copy the larger set, add missing items of the smaller one
+  Set* larger = (set1->size >= set2->size ? set1 : set2),
+     * smaller = (larger == set1 ? set2 : set1);
+  SetFilterTask tasks[SET_MAX_THREADS];
+  UInt tasksCount;
+  char* buffer = _set_filter(smaller, larger, false, tasks, &tasksCount);
+  Set* result = _set_new_like(
+    set1, larger->size + _set_filter_count(tasks, tasksCount));
+  for (UInt i = 0; i < larger->hashSize; i++)
   {
-    SetCell* cell = set->head[i];
-    while (cell != NULL)
+    if (!(larger->meta[i] & SET_EMPTY))
     {
-      SetCell* next = cell->next;
-      safe_free(cell->item);
-      safe_free(cell);
-      cell = next;
+      char* item = _set_item(larger, i);
+      _set_add_new(result, item, _set_hash(result, item));
     }
-    set->head[i] = NULL;
   }
+  _set_add_filtered(result, tasks, tasksCount);
+  _set_filter_free(smaller, buffer);
+  return result;
+}
+
+Set* set_intersect(Set* set1, Set* set2)
+{
+  // Scan the smaller set for common items
+  Set* smaller = (set1->size <= set2->size ? set1 : set2);
+  SetFilterTask tasks[SET_MAX_THREADS];
+  UInt tasksCount;
+  char* buffer = _set_filter(
+    smaller, (smaller == set1 ? set2 : set1), true, tasks, &tasksCount);
+  Set* result = _set_new_like(set1, _set_filter_count(tasks, tasksCount));
+  _set_add_filtered(result, tasks, tasksCount);
+  _set_filter_free(smaller, buffer);
+  return result;
+}
+
+Set* set_difference(Set* set1, Set* set2)
+{
+  SetFilterTask tasks[SET_MAX_THREADS];
+  UInt tasksCount;
+  char* buffer = _set_filter(set1, set2, false, tasks, &tasksCount);
+  Set* result = _set_new_like(set1, _set_filter_count(tasks, tasksCount));
+  _set_add_filtered(result, tasks, tasksCount);
+  _set_filter_free(set1, buffer);
+  return result;
+}
+
+Vector* set_to_vector(Set* set) {
+  Vector* v = _vector_new(set->dataSize, set->allocator);
+  for (UInt i = 0; i < set->hashSize; i++) {
+    if (!(set->meta[i] & SET_EMPTY))
+      _vector_push(v, _set_item(set, i));
+  }
+  return v;
+}
+
+void set_clear(Set* set)
+{
+  // NOTE: items are inline: forgetting them is enough
+  memset(set->meta, SET_EMPTY, set->hashSize);
   set->size = 0;
+  set->used = 0;
+  if (set->filter != NULL)
+    bloomfilter_clear(set->filter);
 }
 
 void set_destroy(Set* set)
 {
-  set_clear(set);
-  safe_free(set->head);
-  safe_free(set);
+  set_detach_filter(set);
+  _set_free_slots(set);
+  allocator_free(set->allocator, set, sizeof(Set));
 }
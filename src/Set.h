@@ -10,24 +10,41 @@
 #include "cgds/safe_alloc.h"
 #include "cgds/types.h"
 #include "cgds/Vector.h"
+#include "cgds/BloomFilter.h"
 
 /**
- * @brief Cell of a set.
+ * @brief Control byte of an empty slot.
  */
-typedef struct SetCell {
-  void* item; ///< Generic data (key) contained in this cell.
-  struct SetCell* next; ///< Pointer to next cell in the list.
-} SetCell;
+#define SET_EMPTY 0x80
+
+/**
+ * @brief Control byte of a deleted slot (tombstone).
+ */
+#define SET_DELETED 0xFE
 
 /**
  * @brief Generic set containing any data (of same size).
+ *
+ * Open addressing with linear probing: items are stored inline in a flat
+ * power-of-two slots array, next to an array of control bytes (empty,
+ * deleted, or 7 bits of the item hash, checked before comparing items).
+ * Slots are rehashed into a twice larger array when the load factor
+ * (including tombstones) would exceed 3/4.
+ * The optional getHash(item, hashSize) function is called with the current
+ * number of slots; its result is reduced modulo hashSize.
+ * An optional Bloom filter (see set_attach_filter()) answers most lookups
+ * of absent items without probing slots; it is rebuilt with the slots.
  */
 typedef struct Set {
   UInt size; ///< Count elements in the set.
-  size_t dataSize; ///< Size of a set cell element in bytes.
-  size_t hashSize; ///< (Maximum) Number of stored hash keys.
-  SetCell** head; ///< Pointers to the first cell in a list.
+  size_t dataSize; ///< Size of a set element in bytes.
+  size_t hashSize; ///< Number of slots (power of 2).
+  UInt used; ///< Count slots full or deleted.
+  char* items; ///< Items (hashSize slots of dataSize bytes).
+  uint8_t* meta; ///< Control byte of each slot.
   UInt (*getHash)(void*, size_t); ///< Custom hash function (optional)
+  Allocator* allocator; ///< Allocator of the struct and arrays.
+  BloomFilter* filter; ///< Filter of absent items (NULL if not attached).
 } Set;
 
 /**
@@ -36,8 +53,9 @@ typedef struct Set {
 void _set_init(
   Set* set, ///< "this" pointer.
   size_t dataSize, ///< Size in bytes of a set element.
-  size_t hashSize, ///< (Maximum) Number of stored hash keys.
-  UInt (*getHash)(void*, size_t); ///< Custom hash function (optional)
+  size_t hashSize, ///< Initial number of slots (rounded to a power of 2).
+  UInt (*getHash)(void*, size_t), ///< Custom hash function (optional)
+  Allocator* allocator ///< Memory allocator (NULL: default one).
 );
 
 /**
@@ -45,20 +63,30 @@ void _set_init(
  */
 Set* _set_new(
   size_t dataSize, ///< Size in bytes of a set element.
-  size_t hashSize, ///< (Maximum) Number of stored hash keys.
-  UInt (*getHash)(void*, size_t) ///< Custom hash function (nullable)
+  size_t hashSize, ///< Initial number of slots (rounded to a power of 2).
+  UInt (*getHash)(void*, size_t), ///< Custom hash function (nullable)
+  Allocator* allocator ///< Memory allocator (NULL: default one).
 );
 
 /**
  * @brief Return an allocated and initialized set.
  * @param type Type of a set element (int, char*, ...).
- * @param hsize Size of the internal pointers array.
+ * @param hsize Initial number of slots (grows as needed).
  * @param getHash Custom hash function (nullable)
  *
  * Usage: Set* set_new(<Type> type, UInt hash_size, UInt (*getHash)(void*, size_t))
  */
 #define set_new(type, hsize, getHash) \
-  _set_new(sizeof(type), hsize, getHash)
+  _set_new(sizeof(type), hsize, getHash, NULL)
+
+/**
+ * @brief Return an allocated and initialized set, using given allocator.
+ *
+ * Usage: Set* set_new_with(<Type> type, UInt hash_size,
+ *                          UInt (*getHash)(void*, size_t), Allocator* a)
+ */
+#define set_new_with(type, hsize, getHash, allocator) \
+  _set_new(sizeof(type), hsize, getHash, allocator)
 
 /**
  * @brief Copy constructor (shallow copy, ok for basic types).
@@ -133,7 +161,89 @@ void _set_delete(
 }
 
 /**
- * @brief Initialize a vector with (pointers to) set elements.
+ * @brief Make room for count elements (in total) without rehashing.
+ */
+void set_reserve(
+  Set* set, ///< "this" pointer.
+  UInt count ///< Number of elements to hold.
+);
+
+/**
+ * @brief Attach a Bloom filter, checked before the slots by lookups, adds
+ * and deletes. The filter is kept up to date (and sized for the slots
+ * count) by the set.
+ */
+void set_attach_filter(
+  Set* set, ///< "this" pointer.
+  Real falsePositiveRate ///< Target rate of absent items not rejected.
+);
+
+/**
+ * @brief Remove the Bloom filter (if any).
+ */
+void set_detach_filter(
+  Set* set ///< "this" pointer.
+);
+
+//*******************
+// Set algebra logic
+//*******************
+
+// NOTE: operands have elements of the same size. Results use the hash
+// function, allocator and filter (if any) of the first operand. Large
+// operands are scanned by several threads (disjoint slots ranges), so
+// custom hash functions must be thread-safe.
+
+/**
+ * @brief Return a new set with elements of set1 or set2.
+ */
+Set* set_union(
+  Set* set1, ///< First operand.
+  Set* set2 ///< Second operand.
+);
+
+/**
+ * @brief Return a new set with elements of set1 and set2.
+ */
+Set* set_intersect(
+  Set* set1, ///< First operand.
+  Set* set2 ///< Second operand.
+);
+
+/**
+ * @brief Return a new set with elements of set1 not in set2.
+ */
+Set* set_difference(
+  Set* set1, ///< First operand.
+  Set* set2 ///< Second operand.
+);
+
+/**
+ * @brief Add elements of other to set.
+ */
+void set_union_inplace(
+  Set* set, ///< "this" pointer.
+  Set* other ///< Set to merge into "this".
+);
+
+/**
+ * @brief Keep only elements of set also in other.
+ */
+void set_intersect_inplace(
+  Set* set, ///< "this" pointer.
+  Set* other ///< Set to intersect "this" with.
+);
+
+/**
+ * @brief Remove elements of other from set.
+ */
+void set_difference_inplace(
+  Set* set, ///< "this" pointer.
+  Set* other ///< Set of elements to remove from "this".
+);
+
+/**
+ * @brief Initialize a vector with (copies of) set elements.
  */
 Vector* set_to_vector(
   Set* set ///< "this" pointer.
@@ -147,7 +257,7 @@ void set_clear(
 );
 
 /**
- * @brief Destroy the set: clear it, and free hashes array.
+ * @brief Destroy the set: free slots arrays.
  */
 void set_destroy(
   Set* set ///< "this" pointer.
@@ -4,23 +4,25 @@
 
 #include "cgds/Stack.h"
 
-void _stack_init(Stack* stack, size_t dataSize)
+void _stack_init(Stack* stack, size_t dataSize, Allocator* allocator)
 {
   stack->dataSize = dataSize;
-  _vector_init(stack->array, dataSize);
+  _vector_init(stack->array, dataSize, allocator);
 }
 
-Stack* _stack_new(size_t dataSize)
+Stack* _stack_new(size_t dataSize, Allocator* allocator)
 {
-  Stack* stack = (Stack*) safe_malloc(sizeof (Stack));
-  stack->array = _vector_new(dataSize);
-  _stack_init(stack, dataSize);
+  allocator = allocator_or_default(allocator);
+  Stack* stack = (Stack*) allocator_alloc(allocator, sizeof (Stack));
+  stack->array = _vector_new(dataSize, allocator);
+  _stack_init(stack, dataSize, allocator);
   return stack;
 }
 
 Stack* stack_copy(Stack* stack)
 {
-  Stack* stackCopy = (Stack*) safe_malloc(sizeof (Stack));
+  Stack* stackCopy =
+    (Stack*) allocator_alloc(stack->array->allocator, sizeof (Stack));
   stackCopy->dataSize = stack->dataSize;
   Vector* arrayCopy = vector_copy(stack->array);
   stackCopy->array = arrayCopy;
@@ -59,6 +61,7 @@ void stack_clear(Stack* stack)
 
 void stack_destroy(Stack* stack)
 {
+  Allocator* allocator = stack->array->allocator;
   vector_destroy(stack->array);
-  safe_free(stack);
+  allocator_free(allocator, stack, sizeof (Stack));
 }
@@ -24,14 +24,16 @@ typedef struct Stack {
  */
 void _stack_init(
   Stack* stack, ///< "this" pointer.
-  size_t dataSize ///< Size in bytes of a stack element.
+  size_t dataSize, ///< Size in bytes of a stack element.
+  Allocator* allocator ///< Memory allocator (NULL: default one).
 );
 
 /**
  * @brief Return an allocated and initialized stack.
  */
 Stack* _stack_new(
-  size_t dataSize ///< Size in bytes of a stack element.
+  size_t dataSize, ///< Size in bytes of a stack element.
+  Allocator* allocator ///< Memory allocator (NULL: default one).
 );
 
 /**
@@ -41,7 +43,17 @@ Stack* _stack_new(
  * Usage: Stack* stack_new(<Type> type)
  */
 #define stack_new(type) \
-  _stack_new(sizeof(type))
+  _stack_new(sizeof(type), NULL)
+
+/**
+ * @brief Return an allocated and initialized stack, using given allocator.
+ * @param type Type of a stack element (int, char*, ...).
+ * @param allocator Memory allocator (Allocator*).
+ *
+ * Usage: Stack* stack_new_with(<Type> type, Allocator* allocator)
+ */
+#define stack_new_with(type, allocator) \
+  _stack_new(sizeof(type), allocator)
 
 /**
  * @brief Copy constructor (shallow copy, ok for basic types).
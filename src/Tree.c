@@ -8,23 +8,26 @@
 // Tree logic //
 ////////////////
 
-void _tree_init(Tree* tree, size_t dataSize)
+void _tree_init(Tree* tree, size_t dataSize, Allocator* allocator)
 {
   tree->root = NULL;
   tree->dataSize = dataSize;
   tree->size = 0;
+  tree->allocator = allocator_or_default(allocator);
+  pool_init(&tree->nodePool, sizeof (TreeNode) + dataSize, tree->allocator);
 }
 
-Tree* _tree_new(size_t dataSize)
+Tree* _tree_new(size_t dataSize, Allocator* allocator)
 {
-  Tree* tree = (Tree*) safe_malloc(sizeof (Tree));
-  _tree_init(tree, dataSize);
+  allocator = allocator_or_default(allocator);
+  Tree* tree = (Tree*) allocator_alloc(allocator, sizeof (Tree));
+  _tree_init(tree, dataSize, allocator);
   return tree;
 }
 
 Tree* tree_copy(Tree* tree)
 {
-  Tree* treeCopy = _tree_new(tree->dataSize);
+  Tree* treeCopy = _tree_new(tree->dataSize, tree->allocator);
   if (tree->root == NULL)
     return treeCopy;
   _tree_set_root(treeCopy, tree->root->data);
@@ -126,10 +129,15 @@ bool tree_is_leaf(TreeNode* treeNode)
   return (treeNode->firstChild == NULL);
 }
 
+// Get a node (with room for its data) from the pool [internal usage]
+TreeNode* _tree_new_node(Tree* tree)
+{
+  return (TreeNode*) pool_alloc(&tree->nodePool);
+}
+
 void _tree_set_root(Tree* tree, void* data)
 {
-  tree->root = (TreeNode*) safe_malloc(sizeof (TreeNode));
-  tree->root->data = safe_malloc(tree->dataSize);
+  tree->root = _tree_new_node(tree);
   memcpy(tree->root->data, data, tree->dataSize);
   tree->root->parent = NULL;
   tree->root->firstChild = NULL;
@@ -151,8 +159,7 @@ void _tree_set(Tree* tree, TreeNode* treeNode, void* data)
 
 TreeNode* _tree_add_child(Tree* tree, TreeNode* treeNode, void* data)
 {
-  TreeNode* newChildNode = (TreeNode*) safe_malloc(sizeof (TreeNode));
-  newChildNode->data = safe_malloc(tree->dataSize);
+  TreeNode* newChildNode = _tree_new_node(tree);
   memcpy(newChildNode->data, data, tree->dataSize);
   newChildNode->next = NULL;
   if (treeNode->lastChild != NULL)
@@ -170,8 +177,7 @@ TreeNode* _tree_add_child(Tree* tree, TreeNode* treeNode, void* data)
 
 TreeNode* _tree_add_sibling(Tree* tree, TreeNode* treeNode, void* data)
 {
-  TreeNode* newSiblingNode = (TreeNode*) safe_malloc(sizeof (TreeNode));
-  newSiblingNode->data = safe_malloc(tree->dataSize);
+  TreeNode* newSiblingNode = _tree_new_node(tree);
   memcpy(newSiblingNode->data, data, tree->dataSize);
   newSiblingNode->next = treeNode->next;
   if (treeNode->next != NULL)
@@ -194,8 +200,7 @@ void _tree_remove_rekursiv(Tree* tree, TreeNode* treeNode)
     _tree_remove_rekursiv(tree, child);
     child = nextChild;
   }
-  safe_free(treeNode->data);
-  safe_free(treeNode);
+  pool_free(&tree->nodePool, treeNode);
   tree->size--;
 }
 
@@ -230,16 +235,15 @@ void tree_rm_childs(Tree* tree, TreeNode* treeNode)
 
 void tree_clear(Tree* tree)
 {
-  if (tree->root != NULL)
-    _tree_remove_rekursiv(tree, tree->root);
-  _tree_init(tree, tree->dataSize);
+  // NOTE: all nodes are in the pool: no need to walk them
+  pool_release(&tree->nodePool);
+  _tree_init(tree, tree->dataSize, tree->allocator);
 }
 
 void tree_destroy(Tree* tree)
 {
-  if (tree->root != NULL)
-    tree_clear(tree);
-  safe_free(tree);
+  tree_clear(tree);
+  allocator_free(tree->allocator, tree, sizeof (Tree));
 }
 
 ////////////////////
@@ -248,8 +252,10 @@ void tree_destroy(Tree* tree)
 
 TreeIterator* tree_get_iterator(Tree* tree, TreeIteratorMode mode)
 {
-  TreeIterator* treeI = (TreeIterator*) safe_malloc(sizeof (TreeIterator));
+  TreeIterator* treeI = (TreeIterator*)
+    allocator_alloc(tree->allocator, sizeof (TreeIterator));
   treeI->tree = tree;
+  treeI->allocator = tree->allocator;
   treeI->mode = mode;
   treeI_reset(treeI);
   return treeI;
@@ -323,5 +329,5 @@ void treeI_move_next(TreeIterator* treeI)
 
 void treeI_destroy(TreeIterator* treeI)
 {
-  safe_free(treeI);
+  allocator_free(treeI->allocator, treeI, sizeof (TreeIterator));
 }
@@ -8,6 +8,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "cgds/safe_alloc.h"
+#include "cgds/Pool.h"
 #include "cgds/types.h"
 
 //***********
@@ -18,12 +19,12 @@
  * @brief Tree node, containing some generic data.
  */
 typedef struct TreeNode {
-  void* data; ///< Generic data contained in this node.
   struct TreeNode* parent; ///< Pointer to parent node (NULL if node is root).
   struct TreeNode* firstChild; ///< Pointer to the first child (if any).
   struct TreeNode* lastChild; ///< Pointer to the last child (if any).
   struct TreeNode* prev; ///< Pointer to the previous sibling (on the left).
   struct TreeNode* next; ///< Pointer to the next sibling (on the right).
+  char data[] POOL_PAYLOAD; ///< Generic data contained in this node.
 } TreeNode;
 
 /**
@@ -33,6 +34,8 @@ typedef struct Tree {
   TreeNode* root; ///< Root node of the tree.
   size_t dataSize; ///< Size of *data at a tree node, in bytes.
   UInt size; ///< Count nodes in the tree.
+  Allocator* allocator; ///< Allocator of the struct, nodes and iterators.
+  Pool nodePool; ///< Pool of nodes (with their data).
 } Tree;
 
 /**
@@ -40,14 +43,16 @@ typedef struct Tree {
  */
 void _tree_init(
   Tree* tree, ///< "this" pointer.
-  size_t dataSize ///< Size in bytes of a tree element.
+  size_t dataSize, ///< Size in bytes of a tree element.
+  Allocator* allocator ///< Memory allocator (NULL: default one).
 );
 
 /**
  * @brief Return an allocated and initialized tree.
  */
 Tree* _tree_new(
-  size_t dataSize ///< Size in bytes of a tree node element.
+  size_t dataSize, ///< Size in bytes of a tree node element.
+  Allocator* allocator ///< Memory allocator (NULL: default one).
 );
 
 /**
@@ -57,7 +62,17 @@ Tree* _tree_new(
  * Usage: Tree* tree_new(<Type> type)
  */
 #define tree_new(type) \
-  _tree_new(sizeof(type))
+  _tree_new(sizeof(type), NULL)
+
+/**
+ * @brief Return an allocated and initialized tree, using given allocator.
+ * @param type Type at a tree node (int, char*, ...).
+ * @param allocator Memory allocator (Allocator*).
+ *
+ * Usage: Tree* tree_new_with(<Type> type, Allocator* allocator)
+ */
+#define tree_new_with(type, allocator) \
+  _tree_new(sizeof(type), allocator)
 
 /**
  * @brief Copy constructor (shallow copy, ok for basic types).
@@ -270,6 +285,7 @@ typedef struct TreeIterator {
   Tree* tree; ///< Pointer to the tree to iterate over.
   TreeNode* current; ///< Current iterator position.
   TreeIteratorMode mode; ///< Mode of iteration (in depth or in breadth).
+  Allocator* allocator; ///< Allocator of the iterator (may outlive tree).
 } TreeIterator;
 
 /**
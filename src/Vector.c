@@ -3,33 +3,244 @@
  */
 
 #include "cgds/Vector.h"
+#include <math.h>
+#include <pthread.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define VECTOR_X86
+#endif
 
 //////////////////
 // Vector logic //
 //////////////////
 
-void _vector_init(Vector* vector, size_t dataSize)
+void _vector_init(Vector* vector, size_t dataSize, Allocator* allocator)
 {
   vector->datas = NULL;
   vector->dataSize = dataSize;
   vector->size = 0;
   vector->capacity = 0;
+  vector->policy.growFactor = 2.0;
+  vector->policy.growStep = 0;
+  vector->policy.hugeThreshold = 0;
+  vector->policy.shrinkBelow = 0.25;
+  vector->storage = HEAP_S;
+  vector->fd = -1;
+  vector->readOnly = false;
+  vector->inlineDatas = NULL;
+  vector->inlineCapacity = 0;
+  vector->allocator = allocator_or_default(allocator);
 }
 
-Vector* _vector_new(size_t dataSize)
+Vector* _vector_new(size_t dataSize, Allocator* allocator)
 {
-  Vector* vector = (Vector*) safe_malloc(sizeof (Vector));
-  _vector_init(vector, dataSize);
+  allocator = allocator_or_default(allocator);
+  Vector* vector = (Vector*) allocator_alloc(allocator, sizeof (Vector));
+  _vector_init(vector, dataSize, allocator);
   return vector;
 }
 
+void _vector_init_inline(Vector* vector, size_t dataSize, void* buffer,
+                         UInt inlineCapacity, Allocator* allocator)
+{
+  _vector_init(vector, dataSize, allocator);
+  if (inlineCapacity > 0)
+  {
+    vector->inlineDatas = buffer;
+    vector->inlineCapacity = inlineCapacity;
+    vector->datas = buffer;
+    vector->capacity = inlineCapacity;
+    vector->storage = INLINE_S;
+  }
+}
+
+Vector* _smallvector_new(
+  size_t dataSize, UInt inlineCapacity, Allocator* allocator)
+{
+  allocator = allocator_or_default(allocator);
+  // NOTE: sizeof(Vector) is a multiple of 8: buffer is suitably aligned
+  Vector* vector = (Vector*) allocator_alloc(
+    allocator, sizeof (Vector) + inlineCapacity * dataSize);
+  _vector_init_inline(vector, dataSize, (void*)vector + sizeof (Vector),
+                      inlineCapacity, allocator);
+  return vector;
+}
+
+// Size of the header preceding data array in a vector file
+#define VECTOR_FILE_HEADER_SIZE 64
+
+// Header at the beginning of a vector file [internal usage]
+typedef struct VectorFileHeader {
+  char magic[8]; ///< File signature.
+  UInt dataSize; ///< Size in bytes of a vector element.
+  UInt size; ///< Count elements in the vector.
+} VectorFileHeader;
+
+static const char VECTOR_FILE_MAGIC[8] = "CGDSVEC";
+
+Vector* vector_open_mmap(char* path, size_t dataSize, int flags)
+{
+#ifdef __linux__
+  bool readOnly = (flags & VECTOR_MMAP_RDONLY);
+  int openFlags = (readOnly ? O_RDONLY : O_RDWR);
+  if (flags & VECTOR_MMAP_CREATE)
+    openFlags |= O_CREAT;
+  if (flags & VECTOR_MMAP_TRUNC)
+    openFlags |= O_TRUNC;
+  int fd = open(path, openFlags, 0644);
+  if (fd < 0)
+    return NULL;
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0)
+  {
+    close(fd);
+    return NULL;
+  }
+  size_t fileSize = fileStat.st_size;
+  bool newFile = (fileSize == 0);
+  if (newFile && !readOnly)
+  {
+    fileSize = VECTOR_FILE_HEADER_SIZE;
+    if (ftruncate(fd, fileSize) != 0)
+    {
+      close(fd);
+      return NULL;
+    }
+  }
+  if (fileSize < VECTOR_FILE_HEADER_SIZE)
+  {
+    close(fd);
+    return NULL;
+  }
+  void* map = mmap(NULL, fileSize,
+                   readOnly ? PROT_READ : PROT_READ | PROT_WRITE,
+                   MAP_SHARED, fd, 0);
+  if (map == MAP_FAILED)
+  {
+    close(fd);
+    return NULL;
+  }
+  VectorFileHeader* header = (VectorFileHeader*) map;
+  UInt capacity = (fileSize - VECTOR_FILE_HEADER_SIZE) / dataSize;
+  if (newFile)
+  {
+    memcpy(header->magic, VECTOR_FILE_MAGIC, sizeof(header->magic));
+    header->dataSize = dataSize;
+    header->size = 0;
+  }
+  else if (
+    memcmp(header->magic, VECTOR_FILE_MAGIC, sizeof(header->magic)) != 0 ||
+    header->dataSize != dataSize ||
+    header->size > capacity
+  ) {
+    munmap(map, fileSize);
+    close(fd);
+    return NULL;
+  }
+  Vector* vector = _vector_new(dataSize, NULL);
+  vector->storage = FILE_S;
+  vector->fd = fd;
+  vector->readOnly = readOnly;
+  vector->datas = map + VECTOR_FILE_HEADER_SIZE;
+  vector->size = header->size;
+  vector->capacity = capacity;
+  return vector;
+#else
+  return NULL;
+#endif
+}
+
+// Exit on a modification of a read-only file-backed vector
+// [internal usage]
+void _vector_check_writable(Vector* vector)
+{
+  if (vector->readOnly)
+  {
+    fprintf(stderr, "Error: vector is read-only\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+// Resize the file behind a file-backed vector, and its mapping
+// [internal usage]
+void _vector_remap_file(Vector* vector, UInt newCapacity)
+{
+#ifdef __linux__
+  if (vector->readOnly)
+  {
+    // File is left as is: only growth is impossible
+    if (newCapacity > vector->capacity)
+      _vector_check_writable(vector);
+    return;
+  }
+  size_t oldFileSize =
+           VECTOR_FILE_HEADER_SIZE + vector->capacity * vector->dataSize,
+         newFileSize =
+           VECTOR_FILE_HEADER_SIZE + newCapacity * vector->dataSize;
+  void* map = vector->datas - VECTOR_FILE_HEADER_SIZE;
+  // Grow file before mapping, shrink mapping before file (no SIGBUS)
+  if (newFileSize > oldFileSize && ftruncate(vector->fd, newFileSize) != 0)
+  {
+    fprintf(stderr, "Error: unable to resize vector file\n");
+    exit(EXIT_FAILURE);
+  }
+  map = safe_remap(map, oldFileSize, newFileSize);
+  if (newFileSize < oldFileSize && ftruncate(vector->fd, newFileSize) != 0)
+  {
+    fprintf(stderr, "Error: unable to resize vector file\n");
+    exit(EXIT_FAILURE);
+  }
+  vector->datas = map + VECTOR_FILE_HEADER_SIZE;
+  vector->capacity = newCapacity;
+  ((VectorFileHeader*) map)->size = vector->size;
+#endif
+}
+
+void vector_sync(Vector* vector)
+{
+#ifdef __linux__
+  // NOTE: read-only mappings cannot be written, nor need flushing
+  if (vector->storage != FILE_S || vector->readOnly)
+    return;
+  VectorFileHeader* header =
+    (VectorFileHeader*) (vector->datas - VECTOR_FILE_HEADER_SIZE);
+  header->size = vector->size;
+  msync(header, VECTOR_FILE_HEADER_SIZE + vector->capacity * vector->dataSize,
+        MS_SYNC);
+#endif
+}
+
+void vector_close(Vector* vector)
+{
+#ifdef __linux__
+  if (vector->storage == FILE_S)
+  {
+    vector_sync(vector);
+    munmap(vector->datas - VECTOR_FILE_HEADER_SIZE,
+           VECTOR_FILE_HEADER_SIZE + vector->capacity * vector->dataSize);
+    close(vector->fd);
+    _vector_init(vector, vector->dataSize, vector->allocator);
+  }
+#endif
+  vector_destroy(vector);
+}
+
 Vector* vector_copy(Vector* vector)
 {
-  Vector* vectorCopy = _vector_new(vector->dataSize);
-  vectorCopy->size = vector->size;
-  vectorCopy->capacity = vector->capacity;
-  vectorCopy->datas = (void*) safe_malloc(vector->capacity * vector->dataSize);
+  Vector* vectorCopy = _smallvector_new(
+    vector->dataSize,
+    vector->inlineDatas != NULL ? vector->inlineCapacity : 0,
+    vector->allocator);
+  vectorCopy->policy = vector->policy;
+  _vector_realloc(vectorCopy, vector->capacity);
   memcpy(vectorCopy->datas, vector->datas, vector->size * vector->dataSize);
+  vectorCopy->size = vector->size;
   return vectorCopy;
 }
 
@@ -43,22 +254,139 @@ UInt vector_size(Vector* vector)
   return vector->size;
 }
 
+VectorPolicy vector_get_policy(Vector* vector)
+{
+  return vector->policy;
+}
+
+void vector_set_policy(Vector* vector, VectorPolicy policy)
+{
+  if (policy.growFactor < 1.0)
+    policy.growFactor = 1.0;
+  // Over one half, halving could leave capacity below size
+  if (policy.shrinkBelow < 0.0)
+    policy.shrinkBelow = 0.0;
+  if (policy.shrinkBelow > 0.5)
+    policy.shrinkBelow = 0.5;
+  vector->policy = policy;
+}
+
+// Release data array, whatever its storage [internal usage]
+void _vector_free_datas(Vector* vector)
+{
+  if (vector->storage == MMAP_S)
+    safe_unmap(vector->datas, vector->capacity * vector->dataSize);
+  else if (vector->storage == HEAP_S)
+  {
+    allocator_free(
+      vector->allocator, vector->datas, vector->capacity * vector->dataSize);
+  }
+}
+
 void _vector_realloc(Vector* vector, UInt newCapacity)
 {
-  void* rellocatedDatas = (void*) safe_malloc(newCapacity * vector->dataSize);
-  memcpy(rellocatedDatas, vector->datas, vector->size * vector->dataSize);
-  safe_free(vector->datas);
-  vector->datas = rellocatedDatas;
+  if (vector->storage == FILE_S)
+  {
+    _vector_remap_file(vector, newCapacity);
+    return;
+  }
+  if (vector->inlineDatas != NULL && newCapacity <= vector->inlineCapacity)
+  {
+    // Small enough for the inline buffer (if any)
+    if (vector->storage != INLINE_S)
+    {
+      UInt keptCount = vector->size < vector->inlineCapacity
+        ? vector->size
+        : vector->inlineCapacity;
+      memcpy(vector->inlineDatas, vector->datas, keptCount * vector->dataSize);
+      _vector_free_datas(vector);
+      vector->datas = vector->inlineDatas;
+      vector->storage = INLINE_S;
+    }
+    vector->capacity = vector->inlineCapacity;
+    return;
+  }
+  size_t newBytes = newCapacity * vector->dataSize;
+  VectorStorage newStorage =
+    vector->policy.hugeThreshold > 0 && newBytes >= vector->policy.hugeThreshold
+      ? MMAP_S
+      : HEAP_S;
+  if (newCapacity == 0)
+  {
+    // NOTE: realloc(ptr, 0) may return NULL, which safe_realloc() rejects
+    _vector_free_datas(vector);
+    vector->datas = NULL;
+    newStorage = HEAP_S;
+  }
+  else if (vector->datas != NULL && newStorage == vector->storage)
+  {
+    // Same kind of memory: let the system resize in place when it can
+    if (newStorage == MMAP_S)
+    {
+      vector->datas = safe_remap(
+        vector->datas, vector->capacity * vector->dataSize, newBytes);
+    }
+    else
+    {
+      vector->datas = allocator_realloc(vector->allocator, vector->datas,
+        vector->capacity * vector->dataSize, newBytes);
+    }
+  }
+  else
+  {
+    // Storage change (or first allocation): copy is unavoidable
+    void* reallocatedDatas =
+      (newStorage == MMAP_S
+        ? safe_map(newBytes)
+        : allocator_alloc(vector->allocator, newBytes));
+    UInt keptCount = vector->size < newCapacity ? vector->size : newCapacity;
+    if (vector->datas != NULL)
+      memcpy(reallocatedDatas, vector->datas, keptCount * vector->dataSize);
+    _vector_free_datas(vector);
+    vector->datas = reallocatedDatas;
+  }
+  vector->storage = newStorage;
   vector->capacity = newCapacity;
 }
 
+// Reallocate (following growth policy) to hold at least minCapacity elements
+// [internal usage]
+void _vector_grow(Vector* vector, UInt minCapacity)
+{
+  if (minCapacity <= vector->capacity)
+    return;
+  UInt increasedCapacity =
+    (UInt)(vector->capacity * vector->policy.growFactor) +
+    vector->policy.growStep;
+  if (increasedCapacity < minCapacity)
+    increasedCapacity = minCapacity;
+  _vector_realloc(vector, increasedCapacity);
+}
+
+// Halve capacity as long as the load factor is under shrinkBelow
+// [internal usage]
+void _vector_shrink(Vector* vector)
+{
+  if (vector->storage == INLINE_S || vector->readOnly)
+    return;
+  UInt reducedCapacity = vector->capacity;
+  // NOTE: capacity 1 is kept, to not free/allocate around empty state
+  while (
+    reducedCapacity > 1 &&
+    reducedCapacity / 2 >= vector->size &&
+    vector->size < reducedCapacity * vector->policy.shrinkBelow
+  ) {
+    reducedCapacity >>= 1;
+  }
+  if (reducedCapacity < vector->capacity)
+    _vector_realloc(vector, reducedCapacity);
+}
+
 void _vector_push(Vector* vector, void* data)
 {
+  _vector_check_writable(vector);
   if (vector->size >= vector->capacity)
-  {
-    UInt increasedCapacity = vector->capacity > 0 ? 2 * vector->capacity : 1;
-    _vector_realloc(vector, increasedCapacity);
-  }
+    _vector_grow(vector, vector->size + 1);
   memcpy(
     vector->datas + vector->size * vector->dataSize,
     data,
@@ -66,11 +394,74 @@ void _vector_push(Vector* vector, void* data)
   vector->size++;
 }
 
+void vector_reserve(Vector* vector, UInt capacity)
+{
+  if (capacity > vector->capacity)
+    _vector_realloc(vector, capacity);
+}
+
+void vector_resize(Vector* vector, UInt size)
+{
+  if (size > vector->size)
+  {
+    _vector_check_writable(vector);
+    _vector_grow(vector, size);
+    memset(
+      vector->datas + vector->size * vector->dataSize,
+      0,
+      (size - vector->size) * vector->dataSize);
+  }
+  vector->size = size;
+}
+
+void vector_append_n(Vector* vector, void* datas, UInt count)
+{
+  _vector_check_writable(vector);
+  _vector_grow(vector, vector->size + count);
+  memcpy(
+    vector->datas + vector->size * vector->dataSize,
+    datas,
+    count * vector->dataSize);
+  vector->size += count;
+}
+
+void vector_insert_range(Vector* vector, UInt index, void* datas, UInt count)
+{
+  _vector_check_writable(vector);
+  _vector_grow(vector, vector->size + count);
+  void* position = vector->datas + index * vector->dataSize;
+  memmove(
+    position + count * vector->dataSize,
+    position,
+    (vector->size - index) * vector->dataSize);
+  memcpy(position, datas, count * vector->dataSize);
+  vector->size += count;
+}
+
+void vector_erase_range(Vector* vector, UInt index, UInt count)
+{
+  if (index + count < vector->size)
+    // Elements move: not a plain truncation
+    _vector_check_writable(vector);
+  void* position = vector->datas + index * vector->dataSize;
+  memmove(
+    position,
+    position + count * vector->dataSize,
+    (vector->size - index - count) * vector->dataSize);
+  vector->size -= count;
+  _vector_shrink(vector);
+}
+
 void vector_pop(Vector* vector)
 {
   vector->size--;
-  if (vector_size(vector) <= (vector->capacity >> 1))
-    _vector_realloc(vector, vector->capacity >> 1);
+  _vector_shrink(vector);
+}
+
+void vector_shrink_to_fit(Vector* vector)
+{
+  if (vector->capacity > vector->size)
+    _vector_realloc(vector, vector->size);
 }
 
 void* _vector_get(Vector* vector, UInt index)
@@ -85,14 +476,24 @@ void _vector_set(Vector* vector, UInt index, void* data)
 
 void vector_clear(Vector* vector)
 {
-  safe_free(vector->datas);
-  _vector_init(vector, vector->dataSize);
+  // Growth policy is kept
+  vector->size = 0;
+  _vector_realloc(vector, 0);
 }
 
 void vector_destroy(Vector* vector)
 {
+  if (vector->storage == FILE_S)
+  {
+    vector_close(vector);
+    return;
+  }
   vector_clear(vector);
-  safe_free(vector);
+  size_t blockSize = sizeof (Vector);
+  if (vector->inlineDatas == (void*)vector + sizeof (Vector))
+    // Small vector: inline buffer follows the struct
+    blockSize += vector->inlineCapacity * vector->dataSize;
+  allocator_free(vector->allocator, vector, blockSize);
 }
 
 ////////////////////
@@ -101,9 +502,10 @@ void vector_destroy(Vector* vector)
 
 VectorIterator* vector_get_iterator(Vector* vector)
 {
-  VectorIterator* vectorI =
-    (VectorIterator*) safe_malloc(sizeof (VectorIterator));
+  VectorIterator* vectorI = (VectorIterator*)
+    allocator_alloc(vector->allocator, sizeof (VectorIterator));
   vectorI->vector = vector;
+  vectorI->allocator = vector->allocator;
   vectorI_reset_begin(vectorI);
   return vectorI;
 }
@@ -151,5 +553,899 @@ void vectorI_move_prev(VectorIterator* vectorI)
 
 void vectorI_destroy(VectorIterator* vectorI)
 {
-  safe_free(vectorI);
+  allocator_free(vectorI->allocator, vectorI, sizeof (VectorIterator));
+}
+
+//////////////////
+// Kernel logic //
+//////////////////
+
+// NOTE: [perf] each kernel exists in up to three flavors: scalar (portable),
+// SSE2 (x86 baseline) and AVX2 (selected at runtime). Unaligned loads are
+// used everywhere: datas only has malloc alignment.
+
+// Tell if AVX2 instructions are available, checking CPU once [internal usage]
+bool _vector_has_avx2()
+{
+#ifdef VECTOR_X86
+  static int hasAvx2 = -1;
+  if (hasAvx2 < 0)
+  {
+    __builtin_cpu_init();
+    hasAvx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+  }
+  return (hasAvx2 == 1);
+#else
+  return false;
+#endif
+}
+
+#ifdef VECTOR_X86
+
+__attribute__((target("avx2")))
+Int _vector_find64_avx2(const uint64_t* datas, UInt size, uint64_t key)
+{
+  __m256i keys = _mm256_set1_epi64x(key);
+  UInt i = 0;
+  for (; i + 4 <= size; i += 4)
+  {
+    __m256i eq = _mm256_cmpeq_epi64(
+      _mm256_loadu_si256((const __m256i*)(datas + i)), keys);
+    int mask = _mm256_movemask_pd(_mm256_castsi256_pd(eq));
+    if (mask != 0)
+      return i + __builtin_ctz(mask);
+  }
+  for (; i < size; i++)
+  {
+    if (datas[i] == key)
+      return i;
+  }
+  return -1;
+}
+
+__attribute__((target("avx2")))
+Int _vector_find32_avx2(const uint32_t* datas, UInt size, uint32_t key)
+{
+  __m256i keys = _mm256_set1_epi32(key);
+  UInt i = 0;
+  for (; i + 8 <= size; i += 8)
+  {
+    __m256i eq = _mm256_cmpeq_epi32(
+      _mm256_loadu_si256((const __m256i*)(datas + i)), keys);
+    int mask = _mm256_movemask_ps(_mm256_castsi256_ps(eq));
+    if (mask != 0)
+      return i + __builtin_ctz(mask);
+  }
+  for (; i < size; i++)
+  {
+    if (datas[i] == key)
+      return i;
+  }
+  return -1;
+}
+
+__attribute__((target("avx2")))
+UInt _vector_count64_avx2(const uint64_t* datas, UInt size, uint64_t key)
+{
+  __m256i keys = _mm256_set1_epi64x(key);
+  UInt count = 0, i = 0;
+  for (; i + 4 <= size; i += 4)
+  {
+    __m256i eq = _mm256_cmpeq_epi64(
+      _mm256_loadu_si256((const __m256i*)(datas + i)), keys);
+    count += __builtin_popcount(_mm256_movemask_pd(_mm256_castsi256_pd(eq)));
+  }
+  for (; i < size; i++)
+    count += (datas[i] == key);
+  return count;
+}
+
+__attribute__((target("avx2")))
+UInt _vector_count32_avx2(const uint32_t* datas, UInt size, uint32_t key)
+{
+  __m256i keys = _mm256_set1_epi32(key);
+  UInt count = 0, i = 0;
+  for (; i + 8 <= size; i += 8)
+  {
+    __m256i eq = _mm256_cmpeq_epi32(
+      _mm256_loadu_si256((const __m256i*)(datas + i)), keys);
+    count += __builtin_popcount(_mm256_movemask_ps(_mm256_castsi256_ps(eq)));
+  }
+  for (; i < size; i++)
+    count += (datas[i] == key);
+  return count;
+}
+
+__attribute__((target("avx2")))
+Int _vector_sum_int_avx2(const Int* datas, UInt size)
+{
+  __m256i acc = _mm256_setzero_si256();
+  UInt i = 0;
+  for (; i + 4 <= size; i += 4)
+  {
+    acc = _mm256_add_epi64(
+      acc, _mm256_loadu_si256((const __m256i*)(datas + i)));
+  }
+  Int lanes[4];
+  _mm256_storeu_si256((__m256i*)lanes, acc);
+  Int sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  for (; i < size; i++)
+    sum += datas[i];
+  return sum;
+}
+
+__attribute__((target("avx2")))
+Int _vector_minmax_int_avx2(const Int* datas, UInt size, bool findMax)
+{
+  Int res = (findMax ? INT64_MIN : INT64_MAX);
+  __m256i acc = _mm256_set1_epi64x(res);
+  UInt i = 0;
+  for (; i + 4 <= size; i += 4)
+  {
+    __m256i v = _mm256_loadu_si256((const __m256i*)(datas + i));
+    // mask = (v > acc) for max, (acc > v) for min
+    __m256i mask =
+      (findMax ? _mm256_cmpgt_epi64(v, acc) : _mm256_cmpgt_epi64(acc, v));
+    acc = _mm256_blendv_epi8(acc, v, mask);
+  }
+  Int lanes[4];
+  _mm256_storeu_si256((__m256i*)lanes, acc);
+  for (int j = 0; j < 4; j++)
+  {
+    if (findMax ? lanes[j] > res : lanes[j] < res)
+      res = lanes[j];
+  }
+  for (; i < size; i++)
+  {
+    if (findMax ? datas[i] > res : datas[i] < res)
+      res = datas[i];
+  }
+  return res;
+}
+
+__attribute__((target("avx2")))
+Real _vector_sum_real_avx2(const Real* datas, UInt size)
+{
+  // Two accumulators, to hide addition latency
+  __m256d acc1 = _mm256_setzero_pd(),
+          acc2 = _mm256_setzero_pd();
+  UInt i = 0;
+  for (; i + 8 <= size; i += 8)
+  {
+    acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(datas + i));
+    acc2 = _mm256_add_pd(acc2, _mm256_loadu_pd(datas + i + 4));
+  }
+  Real lanes[4];
+  _mm256_storeu_pd(lanes, _mm256_add_pd(acc1, acc2));
+  Real sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+  for (; i < size; i++)
+    sum += datas[i];
+  return sum;
+}
+
+__attribute__((target("avx2")))
+Real _vector_minmax_real_avx2(const Real* datas, UInt size, bool findMax)
+{
+  Real res = (findMax ? -INFINITY : INFINITY);
+  __m256d acc = _mm256_set1_pd(res);
+  UInt i = 0;
+  for (; i + 4 <= size; i += 4)
+  {
+    __m256d v = _mm256_loadu_pd(datas + i);
+    acc = (findMax ? _mm256_max_pd(acc, v) : _mm256_min_pd(acc, v));
+  }
+  Real lanes[4];
+  _mm256_storeu_pd(lanes, acc);
+  for (int j = 0; j < 4; j++)
+  {
+    if (findMax ? lanes[j] > res : lanes[j] < res)
+      res = lanes[j];
+  }
+  for (; i < size; i++)
+  {
+    if (findMax ? datas[i] > res : datas[i] < res)
+      res = datas[i];
+  }
+  return res;
+}
+
+#endif
+
+#ifdef __SSE2__
+
+Int _vector_find64_sse2(const uint64_t* datas, UInt size, uint64_t key)
+{
+  __m128i keys = _mm_set1_epi64x(key);
+  UInt i = 0;
+  for (; i + 2 <= size; i += 2)
+  {
+    // No 64-bit comparison in SSE2: both 32-bit halves must match
+    __m128i eq = _mm_cmpeq_epi32(
+      _mm_loadu_si128((const __m128i*)(datas + i)), keys);
+    eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+    int mask = _mm_movemask_pd(_mm_castsi128_pd(eq));
+    if (mask != 0)
+      return i + __builtin_ctz(mask);
+  }
+  if (i < size && datas[i] == key)
+    return i;
+  return -1;
+}
+
+Int _vector_find32_sse2(const uint32_t* datas, UInt size, uint32_t key)
+{
+  __m128i keys = _mm_set1_epi32(key);
+  UInt i = 0;
+  for (; i + 4 <= size; i += 4)
+  {
+    __m128i eq = _mm_cmpeq_epi32(
+      _mm_loadu_si128((const __m128i*)(datas + i)), keys);
+    int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+    if (mask != 0)
+      return i + __builtin_ctz(mask);
+  }
+  for (; i < size; i++)
+  {
+    if (datas[i] == key)
+      return i;
+  }
+  return -1;
+}
+
+UInt _vector_count64_sse2(const uint64_t* datas, UInt size, uint64_t key)
+{
+  __m128i keys = _mm_set1_epi64x(key);
+  UInt count = 0, i = 0;
+  for (; i + 2 <= size; i += 2)
+  {
+    __m128i eq = _mm_cmpeq_epi32(
+      _mm_loadu_si128((const __m128i*)(datas + i)), keys);
+    eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+    count += __builtin_popcount(_mm_movemask_pd(_mm_castsi128_pd(eq)));
+  }
+  if (i < size)
+    count += (datas[i] == key);
+  return count;
+}
+
+UInt _vector_count32_sse2(const uint32_t* datas, UInt size, uint32_t key)
+{
+  __m128i keys = _mm_set1_epi32(key);
+  UInt count = 0, i = 0;
+  for (; i + 4 <= size; i += 4)
+  {
+    __m128i eq = _mm_cmpeq_epi32(
+      _mm_loadu_si128((const __m128i*)(datas + i)), keys);
+    count += __builtin_popcount(_mm_movemask_ps(_mm_castsi128_ps(eq)));
+  }
+  for (; i < size; i++)
+    count += (datas[i] == key);
+  return count;
+}
+
+Int _vector_sum_int_sse2(const Int* datas, UInt size)
+{
+  __m128i acc = _mm_setzero_si128();
+  UInt i = 0;
+  for (; i + 2 <= size; i += 2)
+    acc = _mm_add_epi64(acc, _mm_loadu_si128((const __m128i*)(datas + i)));
+  Int lanes[2];
+  _mm_storeu_si128((__m128i*)lanes, acc);
+  Int sum = lanes[0] + lanes[1];
+  if (i < size)
+    sum += datas[i];
+  return sum;
+}
+
+Real _vector_sum_real_sse2(const Real* datas, UInt size)
+{
+  __m128d acc1 = _mm_setzero_pd(),
+          acc2 = _mm_setzero_pd();
+  UInt i = 0;
+  for (; i + 4 <= size; i += 4)
+  {
+    acc1 = _mm_add_pd(acc1, _mm_loadu_pd(datas + i));
+    acc2 = _mm_add_pd(acc2, _mm_loadu_pd(datas + i + 2));
+  }
+  Real lanes[2];
+  _mm_storeu_pd(lanes, _mm_add_pd(acc1, acc2));
+  Real sum = lanes[0] + lanes[1];
+  for (; i < size; i++)
+    sum += datas[i];
+  return sum;
+}
+
+Real _vector_minmax_real_sse2(const Real* datas, UInt size, bool findMax)
+{
+  Real res = (findMax ? -INFINITY : INFINITY);
+  __m128d acc = _mm_set1_pd(res);
+  UInt i = 0;
+  for (; i + 2 <= size; i += 2)
+  {
+    __m128d v = _mm_loadu_pd(datas + i);
+    acc = (findMax ? _mm_max_pd(acc, v) : _mm_min_pd(acc, v));
+  }
+  Real lanes[2];
+  _mm_storeu_pd(lanes, acc);
+  for (int j = 0; j < 2; j++)
+  {
+    if (findMax ? lanes[j] > res : lanes[j] < res)
+      res = lanes[j];
+  }
+  if (i < size && (findMax ? datas[i] > res : datas[i] < res))
+    res = datas[i];
+  return res;
+}
+
+#endif
+
+Int _vector_find(Vector* vector, void* data)
+{
+  if (vector->dataSize == 8)
+  {
+    uint64_t key;
+    memcpy(&key, data, 8);
+#ifdef VECTOR_X86
+    if (_vector_has_avx2())
+      return _vector_find64_avx2(vector->datas, vector->size, key);
+#endif
+#ifdef __SSE2__
+    return _vector_find64_sse2(vector->datas, vector->size, key);
+#endif
+  }
+  else if (vector->dataSize == 4)
+  {
+    uint32_t key;
+    memcpy(&key, data, 4);
+#ifdef VECTOR_X86
+    if (_vector_has_avx2())
+      return _vector_find32_avx2(vector->datas, vector->size, key);
+#endif
+#ifdef __SSE2__
+    return _vector_find32_sse2(vector->datas, vector->size, key);
+#endif
+  }
+  // Scalar fallback (any element size)
+  for (UInt i = 0; i < vector->size; i++)
+  {
+    if (memcmp(_vector_get(vector, i), data, vector->dataSize) == 0)
+      return i;
+  }
+  return -1;
+}
+
+UInt _vector_count(Vector* vector, void* data)
+{
+  if (vector->dataSize == 8)
+  {
+    uint64_t key;
+    memcpy(&key, data, 8);
+#ifdef VECTOR_X86
+    if (_vector_has_avx2())
+      return _vector_count64_avx2(vector->datas, vector->size, key);
+#endif
+#ifdef __SSE2__
+    return _vector_count64_sse2(vector->datas, vector->size, key);
+#endif
+  }
+  else if (vector->dataSize == 4)
+  {
+    uint32_t key;
+    memcpy(&key, data, 4);
+#ifdef VECTOR_X86
+    if (_vector_has_avx2())
+      return _vector_count32_avx2(vector->datas, vector->size, key);
+#endif
+#ifdef __SSE2__
+    return _vector_count32_sse2(vector->datas, vector->size, key);
+#endif
+  }
+  UInt count = 0;
+  for (UInt i = 0; i < vector->size; i++)
+    count += (memcmp(_vector_get(vector, i), data, vector->dataSize) == 0);
+  return count;
+}
+
+void _vector_fill(Vector* vector, void* data)
+{
+  if (vector->size == 0)
+    return;
+  // Copy the first element, then double the filled area at each step:
+  // log(size) memcpy() calls, which run at memory bandwidth.
+  memcpy(vector->datas, data, vector->dataSize);
+  UInt filled = 1;
+  while (filled < vector->size)
+  {
+    UInt count = (filled <= vector->size - filled
+      ? filled
+      : vector->size - filled);
+    memcpy(
+      vector->datas + filled * vector->dataSize,
+      vector->datas,
+      count * vector->dataSize);
+    filled += count;
+  }
+}
+
+// Exit if elements are not 8 bytes values, as typed kernels expect
+// [internal usage]
+void _vector_check_8bytes(Vector* vector)
+{
+  if (vector->dataSize != sizeof(Int))
+  {
+    fprintf(stderr, "Error: vector elements must be Int, UInt or Real\n");
+    exit(EXIT_FAILURE);
+  }
+}
+
+Int vector_sum_int(Vector* vector)
+{
+  _vector_check_8bytes(vector);
+#ifdef VECTOR_X86
+  if (_vector_has_avx2())
+    return _vector_sum_int_avx2(vector->datas, vector->size);
+#endif
+#ifdef __SSE2__
+  return _vector_sum_int_sse2(vector->datas, vector->size);
+#else
+  Int sum = 0;
+  for (UInt i = 0; i < vector->size; i++)
+    sum += ((Int*)vector->datas)[i];
+  return sum;
+#endif
+}
+
+// Minimum or maximum of Int values [internal usage]
+Int _vector_minmax_int(Vector* vector, bool findMax)
+{
+  _vector_check_8bytes(vector);
+#ifdef VECTOR_X86
+  if (_vector_has_avx2())
+    return _vector_minmax_int_avx2(vector->datas, vector->size, findMax);
+#endif
+  // NOTE: no 64-bit integer comparison in SSE2
+  Int res = (findMax ? INT64_MIN : INT64_MAX);
+  for (UInt i = 0; i < vector->size; i++)
+  {
+    Int value = ((Int*)vector->datas)[i];
+    if (findMax ? value > res : value < res)
+      res = value;
+  }
+  return res;
+}
+
+Int vector_min_int(Vector* vector)
+{
+  return _vector_minmax_int(vector, false);
+}
+
+Int vector_max_int(Vector* vector)
+{
+  return _vector_minmax_int(vector, true);
+}
+
+Real vector_sum_real(Vector* vector)
+{
+  _vector_check_8bytes(vector);
+#ifdef VECTOR_X86
+  if (_vector_has_avx2())
+    return _vector_sum_real_avx2(vector->datas, vector->size);
+#endif
+#ifdef __SSE2__
+  return _vector_sum_real_sse2(vector->datas, vector->size);
+#else
+  Real sum = 0.0;
+  for (UInt i = 0; i < vector->size; i++)
+    sum += ((Real*)vector->datas)[i];
+  return sum;
+#endif
+}
+
+// Minimum or maximum of Real values [internal usage]
+Real _vector_minmax_real(Vector* vector, bool findMax)
+{
+  _vector_check_8bytes(vector);
+#ifdef VECTOR_X86
+  if (_vector_has_avx2())
+    return _vector_minmax_real_avx2(vector->datas, vector->size, findMax);
+#endif
+#ifdef __SSE2__
+  return _vector_minmax_real_sse2(vector->datas, vector->size, findMax);
+#else
+  Real res = (findMax ? -INFINITY : INFINITY);
+  for (UInt i = 0; i < vector->size; i++)
+  {
+    Real value = ((Real*)vector->datas)[i];
+    if (findMax ? value > res : value < res)
+      res = value;
+  }
+  return res;
+#endif
+}
+
+Real vector_min_real(Vector* vector)
+{
+  return _vector_minmax_real(vector, false);
+}
+
+Real vector_max_real(Vector* vector)
+{
+  return _vector_minmax_real(vector, true);
+}
+
+///////////////////
+// Sorting logic //
+///////////////////
+
+// Below this number of elements, sort or merge in the current thread
+#define VECTOR_PARALLEL_THRESHOLD 16384
+// Below this number of elements, merge sort switches to insertion sort
+#define VECTOR_INSERTION_THRESHOLD 16
+
+// Index of first element >= data (> data if 'upper') in a sorted array
+// [internal usage]
+UInt _vector_bound(void* datas, UInt size, void* data, size_t dataSize,
+                   int (*compare)(const void*, const void*), bool upper)
+{
+  UInt low = 0, high = size;
+  while (low < high)
+  {
+    UInt mid = low + (high - low) / 2;
+    int cmp = compare(datas + mid * dataSize, data);
+    if (cmp < 0 || (upper && cmp == 0))
+      low = mid + 1;
+    else
+      high = mid;
+  }
+  return low;
+}
+
+// Stable insertion sort; 'tmp' must hold one element [internal usage]
+void _vector_insertion_sort(void* datas, void* tmp, UInt size, size_t dataSize,
+                            int (*compare)(const void*, const void*))
+{
+  for (UInt i = 1; i < size; i++)
+  {
+    if (compare(datas + (i - 1) * dataSize, datas + i * dataSize) <= 0)
+      continue;
+    memcpy(tmp, datas + i * dataSize, dataSize);
+    UInt j = i - 1;
+    while (j > 0 && compare(datas + (j - 1) * dataSize, tmp) > 0)
+      j--;
+    memmove(datas + (j + 1) * dataSize, datas + j * dataSize,
+            (i - j) * dataSize);
+    memcpy(datas + j * dataSize, tmp, dataSize);
+  }
+}
+
+// Stable merge of two sorted runs into 'output' [internal usage]
+void _vector_merge(void* left, UInt leftSize, void* right, UInt rightSize,
+                   void* output, size_t dataSize,
+                   int (*compare)(const void*, const void*))
+{
+  while (leftSize > 0 && rightSize > 0)
+  {
+    // Equal elements: left one first
+    if (compare(right, left) < 0)
+    {
+      memcpy(output, right, dataSize);
+      right += dataSize;
+      rightSize--;
+    }
+    else
+    {
+      memcpy(output, left, dataSize);
+      left += dataSize;
+      leftSize--;
+    }
+    output += dataSize;
+  }
+  memcpy(output, left, leftSize * dataSize);
+  memcpy(output + leftSize * dataSize, right, rightSize * dataSize);
+}
+
+// Sequential stable merge sort, using 'buffer' of same size [internal usage]
+void _vector_merge_sort(void* datas, void* buffer, UInt size, size_t dataSize,
+                        int (*compare)(const void*, const void*))
+{
+  if (size <= VECTOR_INSERTION_THRESHOLD)
+  {
+    _vector_insertion_sort(datas, buffer, size, dataSize, compare);
+    return;
+  }
+  UInt half = size / 2;
+  void* middle = datas + half * dataSize;
+  _vector_merge_sort(datas, buffer, half, dataSize, compare);
+  _vector_merge_sort(middle, buffer + half * dataSize, size - half,
+                     dataSize, compare);
+  if (compare(middle - dataSize, middle) <= 0)
+    // Runs already in order
+    return;
+  _vector_merge(datas, half, middle, size - half, buffer, dataSize, compare);
+  memcpy(datas, buffer, size * dataSize);
+}
+
+// Run task(arg1) in a new thread and task(arg2) in the current one, then wait
+// [internal usage]
+void _vector_fork_join(void* (*task)(void*), void* arg1, void* arg2)
+{
+  pthread_t thread;
+  bool forked = (pthread_create(&thread, NULL, task, arg1) == 0);
+  task(arg2);
+  if (forked)
+    pthread_join(thread, NULL);
+  else
+    // Could not create a thread: do the work here
+    task(arg1);
+}
+
+// Arguments of a (possibly parallel) merge [internal usage]
+typedef struct MergeTask {
+  void* left; ///< First sorted run.
+  UInt leftSize; ///< Number of elements in first run.
+  void* right; ///< Second sorted run.
+  UInt rightSize; ///< Number of elements in second run.
+  void* output; ///< Destination array (leftSize + rightSize elements).
+  size_t dataSize; ///< Size in bytes of an element.
+  int (*compare)(const void*, const void*); ///< Comparison function.
+  UInt threads; ///< Number of threads allowed for this task.
+} MergeTask;
+
+// Split the larger run at its middle, find the matching split point in the
+// other run, and merge both halves independently [internal usage]
+void* _vector_merge_task(void* arg)
+{
+  MergeTask* task = (MergeTask*) arg;
+  size_t dataSize = task->dataSize;
+  if (
+    task->threads <= 1 ||
+    task->leftSize + task->rightSize < VECTOR_PARALLEL_THRESHOLD
+  ) {
+    _vector_merge(task->left, task->leftSize, task->right, task->rightSize,
+                  task->output, dataSize, task->compare);
+    return NULL;
+  }
+  MergeTask first = *task, second = *task;
+  if (task->leftSize >= task->rightSize)
+  {
+    // Right elements equal to the pivot go after it (stability)
+    UInt mid = task->leftSize / 2;
+    void* pivot = task->left + mid * dataSize;
+    UInt split = _vector_bound(task->right, task->rightSize, pivot,
+                               dataSize, task->compare, false);
+    first.leftSize = mid;
+    first.rightSize = split;
+    second.left = pivot;
+    second.leftSize = task->leftSize - mid;
+    second.right = task->right + split * dataSize;
+    second.rightSize = task->rightSize - split;
+  }
+  else
+  {
+    // Left elements equal to the pivot go before it (stability)
+    UInt mid = task->rightSize / 2;
+    void* pivot = task->right + mid * dataSize;
+    UInt split = _vector_bound(task->left, task->leftSize, pivot,
+                               dataSize, task->compare, true);
+    first.leftSize = split;
+    first.rightSize = mid;
+    second.left = task->left + split * dataSize;
+    second.leftSize = task->leftSize - split;
+    second.right = pivot;
+    second.rightSize = task->rightSize - mid;
+  }
+  second.output =
+    task->output + (first.leftSize + first.rightSize) * dataSize;
+  first.threads = task->threads / 2;
+  second.threads = task->threads - first.threads;
+  _vector_fork_join(_vector_merge_task, &first, &second);
+  return NULL;
+}
+
+// Arguments of a (possibly parallel) sort [internal usage]
+typedef struct SortTask {
+  void* datas; ///< Elements to sort.
+  void* buffer; ///< Temporary area of same size.
+  UInt size; ///< Number of elements to sort.
+  size_t dataSize; ///< Size in bytes of an element.
+  int (*compare)(const void*, const void*); ///< Comparison function.
+  bool stable; ///< Whether equal elements must keep their order.
+  UInt threads; ///< Number of threads allowed for this task.
+} SortTask;
+
+// Sort both halves (in parallel), then merge them [internal usage]
+void* _vector_sort_task(void* arg)
+{
+  SortTask* task = (SortTask*) arg;
+  size_t dataSize = task->dataSize;
+  if (task->threads <= 1 || task->size < VECTOR_PARALLEL_THRESHOLD)
+  {
+    if (task->stable)
+    {
+      _vector_merge_sort(task->datas, task->buffer, task->size,
+                         dataSize, task->compare);
+    }
+    else
+      qsort(task->datas, task->size, dataSize, task->compare);
+    return NULL;
+  }
+  UInt half = task->size / 2;
+  SortTask first = *task, second = *task;
+  first.size = half;
+  first.threads = task->threads / 2;
+  second.datas = task->datas + half * dataSize;
+  second.buffer = task->buffer + half * dataSize;
+  second.size = task->size - half;
+  second.threads = task->threads - first.threads;
+  _vector_fork_join(_vector_sort_task, &first, &second);
+  MergeTask merge = {
+    .left = task->datas,
+    .leftSize = half,
+    .right = second.datas,
+    .rightSize = second.size,
+    .output = task->buffer,
+    .dataSize = dataSize,
+    .compare = task->compare,
+    .threads = task->threads
+  };
+  _vector_merge_task(&merge);
+  memcpy(task->datas, task->buffer, task->size * dataSize);
+  return NULL;
+}
+
+// Comparison sort, parallel if the vector is large enough [internal usage]
+void _vector_sort(Vector* vector, int (*compare)(const void*, const void*),
+                  bool stable)
+{
+  if (vector->size < 2)
+    return;
+  long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+  UInt threads = (cpus > 1 ? (UInt)cpus : 1);
+  if (!stable && (threads == 1 || vector->size < VECTOR_PARALLEL_THRESHOLD))
+  {
+    qsort(vector->datas, vector->size, vector->dataSize, compare);
+    return;
+  }
+  SortTask task = {
+    .datas = vector->datas,
+    .buffer =
+      allocator_alloc(vector->allocator, vector->size * vector->dataSize),
+    .size = vector->size,
+    .dataSize = vector->dataSize,
+    .compare = compare,
+    .stable = stable,
+    .threads = threads
+  };
+  _vector_sort_task(&task);
+  allocator_free(
+    vector->allocator, task.buffer, vector->size * vector->dataSize);
+}
+
+void vector_sort(Vector* vector, int (*compare)(const void*, const void*))
+{
+  _vector_sort(vector, compare, false);
+}
+
+void vector_stable_sort(Vector* vector,
+                        int (*compare)(const void*, const void*))
+{
+  _vector_sort(vector, compare, true);
+}
+
+// Type of 64-bits keys for radix sort [internal usage]
+typedef enum {
+  UINT_KEY = 0, ///< UInt: bits already in order.
+  INT_KEY = 1, ///< Int: flip sign bit.
+  REAL_KEY = 2 ///< Real: flip sign bit if positive, all bits otherwise.
+} RadixKeyType;
+
+// Map a key to an unsigned integer of same rank [internal usage]
+uint64_t _vector_radix_encode(uint64_t bits, RadixKeyType keyType)
+{
+  const uint64_t signBit = (uint64_t)1 << 63;
+  switch (keyType)
+  {
+    case INT_KEY:
+      return bits ^ signBit;
+    case REAL_KEY:
+      return (bits & signBit ? ~bits : bits ^ signBit);
+    default:
+      return bits;
+  }
+}
+
+// Inverse of _vector_radix_encode() [internal usage]
+uint64_t _vector_radix_decode(uint64_t bits, RadixKeyType keyType)
+{
+  const uint64_t signBit = (uint64_t)1 << 63;
+  switch (keyType)
+  {
+    case INT_KEY:
+      return bits ^ signBit;
+    case REAL_KEY:
+      return (bits & signBit ? bits ^ signBit : ~bits);
+    default:
+      return bits;
+  }
+}
+
+// LSD radix sort on 8-bits digits of 64-bits keys [internal usage]
+void _vector_radix_sort(Vector* vector, RadixKeyType keyType)
+{
+  _vector_check_8bytes(vector);
+  UInt size = vector->size;
+  if (size < 2)
+    return;
+  uint64_t *source = (uint64_t*) vector->datas,
+           *buffer = (uint64_t*)
+             allocator_alloc(vector->allocator, size * sizeof(uint64_t)),
+           *target = buffer;
+  // All histograms in a single pass
+  UInt* counts = (UInt*)
+    allocator_alloc(vector->allocator, 8 * 256 * sizeof(UInt));
+  memset(counts, 0, 8 * 256 * sizeof(UInt));
+  for (UInt i = 0; i < size; i++)
+  {
+    source[i] = _vector_radix_encode(source[i], keyType);
+    for (int d = 0; d < 8; d++)
+      counts[256 * d + ((source[i] >> (8 * d)) & 0xFF)]++;
+  }
+  for (int d = 0; d < 8; d++)
+  {
+    UInt* count = counts + 256 * d;
+    if (count[(source[0] >> (8 * d)) & 0xFF] == size)
+      // All keys share this digit: nothing to do
+      continue;
+    UInt offset = 0;
+    for (int digit = 0; digit < 256; digit++)
+    {
+      UInt digitCount = count[digit];
+      count[digit] = offset;
+      offset += digitCount;
+    }
+    for (UInt i = 0; i < size; i++)
+      target[count[(source[i] >> (8 * d)) & 0xFF]++] = source[i];
+    uint64_t* tmp = source;
+    source = target;
+    target = tmp;
+  }
+  if (source != vector->datas)
+    memcpy(vector->datas, source, size * sizeof(uint64_t));
+  source = (uint64_t*) vector->datas;
+  for (UInt i = 0; i < size; i++)
+    source[i] = _vector_radix_decode(source[i], keyType);
+  allocator_free(vector->allocator, counts, 8 * 256 * sizeof(UInt));
+  allocator_free(vector->allocator, buffer, size * sizeof(uint64_t));
+}
+
+void vector_sort_int(Vector* vector)
+{
+  _vector_radix_sort(vector, INT_KEY);
+}
+
+void vector_sort_uint(Vector* vector)
+{
+  _vector_radix_sort(vector, UINT_KEY);
+}
+
+void vector_sort_real(Vector* vector)
+{
+  _vector_radix_sort(vector, REAL_KEY);
+}
+
+UInt _vector_lower_bound(Vector* vector, void* data,
+                         int (*compare)(const void*, const void*))
+{
+  return _vector_bound(vector->datas, vector->size, data, vector->dataSize,
+                       compare, false);
+}
+
+bool _vector_binary_search(Vector* vector, void* data,
+                           int (*compare)(const void*, const void*))
+{
+  UInt index = _vector_lower_bound(vector, data, compare);
+  return (
+    index < vector->size &&
+    compare(_vector_get(vector, index), data) == 0
+  );
 }
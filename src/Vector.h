@@ -14,6 +14,44 @@
 // Vector logic
 //*************
 
+/**
+ * @brief Memory backing the data array of a vector.
+ */
+typedef enum {
+  HEAP_S = 0, ///< Array allocated on the heap (grown with realloc).
+  MMAP_S = 1, ///< Array in an anonymous memory mapping (grown with mremap).
+  FILE_S = 2, ///< Array in a shared file mapping (see vector_open_mmap()).
+  INLINE_S = 3 ///< Array in the inline buffer of a small vector.
+} VectorStorage;
+
+/**
+ * @brief Flags to open a file-backed vector (may be combined with '|').
+ */
+typedef enum {
+  VECTOR_MMAP_CREATE = 1, ///< Create the file if it does not exist.
+  VECTOR_MMAP_TRUNC = 2, ///< Discard current file content.
+  VECTOR_MMAP_RDONLY = 4 ///< Read-only mapping: vector must not be modified.
+} VectorMmapFlag;
+
+/**
+ * @brief Growth policy of a vector.
+ *
+ * When full, capacity becomes capacity * growFactor + growStep.
+ * After a removal, capacity is halved while size < capacity * shrinkBelow,
+ * never below size. shrinkBelow is clamped to [0, 1/2]; with the default
+ * growFactor 2, values under 1/2 leave a gap between growth and shrink
+ * points, so that alternating push/pop never reallocates.
+ * Arrays of at least hugeThreshold bytes are memory-mapped (with huge pages
+ * if possible), so that they grow by remapping pages instead of copying.
+ * Note that glibc realloc() already relies on mremap for large blocks.
+ */
+typedef struct VectorPolicy {
+  Real growFactor; ///< Capacity multiplier when the vector is full (>= 1).
+  UInt growStep; ///< Capacity increment when the vector is full.
+  size_t hugeThreshold; ///< Array size (bytes) from which to map (0: never).
+  Real shrinkBelow; ///< Load factor under which to shrink (0: never, <= 0.5).
+} VectorPolicy;
+
 /**
  * @brief Generic resizable array.
  */
@@ -22,6 +60,13 @@ typedef struct Vector {
   size_t dataSize; ///< Size in bytes of a vector element.
   UInt size; ///< Count elements in the vector.
   UInt capacity; ///< Current maximal capacity; always larger than size.
+  VectorPolicy policy; ///< Growth policy.
+  VectorStorage storage; ///< Kind of memory currently holding datas.
+  int fd; ///< Descriptor of the backing file (FILE_S storage only).
+  bool readOnly; ///< Opened with VECTOR_MMAP_RDONLY: elements are read-only.
+  void* inlineDatas; ///< Inline buffer of a small vector (NULL if none).
+  UInt inlineCapacity; ///< Number of elements fitting in inlineDatas.
+  Allocator* allocator; ///< Allocator of the struct and HEAP_S arrays.
 } Vector;
 
 /**
@@ -29,14 +74,16 @@ typedef struct Vector {
  */
 void _vector_init(
   Vector* vector, ///< "this" pointer.
-  size_t dataSize ///< Size in bytes of a vector element.
+  size_t dataSize, ///< Size in bytes of a vector element.
+  Allocator* allocator ///< Memory allocator (NULL: default one).
 );
 
 /**
  * @brief Return an allocated and initialized vector.
  */
 Vector* _vector_new(
-  size_t dataSize ///< Size in bytes of a vector element.
+  size_t dataSize, ///< Size in bytes of a vector element.
+  Allocator* allocator ///< Memory allocator (NULL: default one).
 );
 
 /**
@@ -46,7 +93,96 @@ Vector* _vector_new(
  * Usage: Vector* vector_new(<Type> type)
  */
 #define vector_new(type) \
-  _vector_new(sizeof(type))
+  _vector_new(sizeof(type), NULL)
+
+/**
+ * @brief Return an allocated and initialized vector, using given allocator.
+ * @param type Type of a vector element (int, char*, ...).
+ * @param allocator Memory allocator (Allocator*).
+ *
+ * Usage: Vector* vector_new_with(<Type> type, Allocator* allocator)
+ */
+#define vector_new_with(type, allocator) \
+  _vector_new(sizeof(type), allocator)
+
+/**
+ * @brief Initialize an empty small vector: up to inlineCapacity elements
+ * are kept in the given buffer, without any allocation.
+ *
+ * When more elements are needed the vector moves to regular storage, and
+ * comes back to the buffer when it shrinks enough. The buffer must outlive
+ * the vector (e.g. a member of the same struct).
+ */
+void _vector_init_inline(
+  Vector* vector, ///< "this" pointer.
+  size_t dataSize, ///< Size in bytes of a vector element.
+  void* buffer, ///< Inline buffer, of inlineCapacity elements.
+  UInt inlineCapacity, ///< Number of elements fitting in the buffer.
+  Allocator* allocator ///< Memory allocator (NULL: default one).
+);
+
+/**
+ * @brief Return an allocated and initialized small vector, with an inline
+ * buffer of inlineCapacity elements (in the same memory block).
+ */
+Vector* _smallvector_new(
+  size_t dataSize, ///< Size in bytes of a vector element.
+  UInt inlineCapacity, ///< Number of elements fitting in the inline buffer.
+  Allocator* allocator ///< Memory allocator (NULL: default one).
+);
+
+/**
+ * @brief Return an allocated and initialized small vector.
+ * @param type Type of a vector element (int, char*, ...).
+ * @param n Number of elements stored without further allocation.
+ *
+ * Usage: Vector* smallvector_new(<Type> type, UInt n)
+ */
+#define smallvector_new(type, n) \
+  _smallvector_new(sizeof(type), n, NULL)
+
+/**
+ * @brief Return an allocated and initialized small vector, using given
+ * allocator.
+ *
+ * Usage: Vector* smallvector_new_with(<Type> type, UInt n, Allocator* a)
+ */
+#define smallvector_new_with(type, n, allocator) \
+  _smallvector_new(sizeof(type), n, allocator)
+
+/**
+ * @brief Return a vector stored in a memory-mapped file, or NULL if the file
+ * cannot be opened or was not written by a vector of same element size.
+ *
+ * The file holds a small header followed by the data array: reopening it
+ * gives back the vector as it was at last vector_sync() or vector_close().
+ * Growth extends the file (ftruncate) and its mapping (mremap). Linux only.
+ *
+ * With VECTOR_MMAP_RDONLY, the file is never modified: reads (get, find,
+ * sum, search, iterators...), vector_copy(), and size reductions that move
+ * no element (pop, resize down, erase at the end, clear) are allowed, the
+ * latter only on the in-memory view. Push, append, insert, other erasures
+ * and growth print an error and exit; set, fill and sort must not be used.
+ */
+Vector* vector_open_mmap(
+  char* path, ///< Path to the backing file.
+  size_t dataSize, ///< Size in bytes of a vector element.
+  int flags ///< Combination of VectorMmapFlag values.
+);
+
+/**
+ * @brief Flush a file-backed vector (content and size) to its file.
+ */
+void vector_sync(
+  Vector* vector ///< "this" pointer.
+);
+
+/**
+ * @brief Flush a file-backed vector, unmap it and free 'vector' pointer.
+ */
+void vector_close(
+  Vector* vector ///< "this" pointer.
+);
 
 /**
  * @brief Copy constructor (shallow copy, ok for basic types).
@@ -69,6 +205,21 @@ UInt vector_size(
   Vector* vector ///< "this" pointer.
 );
 
+/**
+ * @brief Return the growth policy of the vector.
+ */
+VectorPolicy vector_get_policy(
+  Vector* vector ///< "this" pointer.
+);
+
+/**
+ * @brief Set the growth policy of the vector (applies to next reallocation).
+ */
+void vector_set_policy(
+  Vector* vector, ///< "this" pointer.
+  VectorPolicy policy ///< New growth policy.
+);
+
 /**
  * @brief Reallocate internal array.
  */
@@ -98,6 +249,50 @@ void _vector_push(
   _vector_push(vector, &tmp); \
 }
 
+/**
+ * @brief Ensure capacity is at least the given number of elements.
+ */
+void vector_reserve(
+  Vector* vector, ///< "this" pointer.
+  UInt capacity ///< Minimal capacity (in number of elements).
+);
+
+/**
+ * @brief Change the number of elements; new elements are zero-filled.
+ */
+void vector_resize(
+  Vector* vector, ///< "this" pointer.
+  UInt size ///< New size of the vector.
+);
+
+/**
+ * @brief Add a contiguous array of elements at the end.
+ */
+void vector_append_n(
+  Vector* vector, ///< "this" pointer.
+  void* datas, ///< Pointer to the first element to be added.
+  UInt count ///< Number of elements to be added.
+);
+
+/**
+ * @brief Insert a contiguous array of elements before given index.
+ */
+void vector_insert_range(
+  Vector* vector, ///< "this" pointer.
+  UInt index, ///< Insertion position, in [0, size].
+  void* datas, ///< Pointer to the first element to be inserted.
+  UInt count ///< Number of elements to be inserted.
+);
+
+/**
+ * @brief Remove count elements starting at given index.
+ */
+void vector_erase_range(
+  Vector* vector, ///< "this" pointer.
+  UInt index, ///< Index of the first element to remove.
+  UInt count ///< Number of elements to remove.
+);
+
 /**
  * @brief Remove the last pushed element.
  */
@@ -105,6 +300,13 @@ void vector_pop(
   Vector* vector ///< "this" pointer.
 );
 
+/**
+ * @brief Reduce capacity to the current size.
+ */
+void vector_shrink_to_fit(
+  Vector* vector ///< "this" pointer.
+);
+
 /**
  * @brief Get the element at given index.
  */
@@ -159,6 +361,7 @@ void vector_clear(
 
 /**
  * @brief Destroy the vector: clear it, and free 'vector' pointer.
+ * @note File-backed vectors are closed instead (file content is kept).
  */
 void vector_destroy(
   Vector* vector ///< "this" pointer.
@@ -174,6 +377,7 @@ void vector_destroy(
 typedef struct VectorIterator {
   Vector* vector; ///< Vector to be iterated.
   void* current; ///< Current vector element.
+  Allocator* allocator; ///< Allocator of the iterator (may outlive vector).
 } VectorIterator;
 
 /**
@@ -266,4 +470,228 @@ void vectorI_destroy(
   VectorIterator* vectorI ///< "this" pointer.
 );
 
+//*************
+// Kernel logic
+//*************
+
+// NOTE: following functions work directly on the data array. Elements of
+// 4 or 8 bytes are processed with SIMD instructions (SSE2, or AVX2 when the
+// CPU supports it, detected at runtime); other sizes use scalar code.
+// Typed sums, minima, maxima and sorts (_int, _uint, _real) require
+// elements of sizeof(Int) bytes: on other vectors they print an error and
+// exit.
+
+/**
+ * @brief Return index of the first element equal (bytewise) to given data,
+ * or -1 if not found.
+ */
+Int _vector_find(
+  Vector* vector, ///< "this" pointer.
+  void* data ///< Pointer to data to search.
+);
+
+/**
+ * @brief Search the first element equal (bytewise) to given data.
+ * @param vector "this" pointer.
+ * @param data Data to search.
+ * @param index 'out' variable to contain the result (-1 if not found).
+ *
+ * Usage: void vector_find(Vector* vector, void data, Int index)
+ */
+#define vector_find(vector, data, index) \
+{ \
+  typeof(data) tmp = data; \
+  index = _vector_find(vector, &tmp); \
+}
+
+/**
+ * @brief Count elements equal (bytewise) to given data.
+ */
+UInt _vector_count(
+  Vector* vector, ///< "this" pointer.
+  void* data ///< Pointer to data to count.
+);
+
+/**
+ * @brief Count elements equal (bytewise) to given data.
+ * @param vector "this" pointer.
+ * @param data Data to count.
+ * @param count 'out' variable to contain the result.
+ *
+ * Usage: void vector_count(Vector* vector, void data, UInt count)
+ */
+#define vector_count(vector, data, count) \
+{ \
+  typeof(data) tmp = data; \
+  count = _vector_count(vector, &tmp); \
+}
+
+/**
+ * @brief Assign given data to all elements (size is unchanged).
+ */
+void _vector_fill(
+  Vector* vector, ///< "this" pointer.
+  void* data ///< Pointer to data to be assigned.
+);
+
+/**
+ * @brief Assign given data to all elements (size is unchanged).
+ * @param vector "this" pointer.
+ * @param data Data to be assigned.
+ *
+ * Usage: void vector_fill(Vector* vector, void data)
+ */
+#define vector_fill(vector, data) \
+{ \
+  typeof(data) tmp = data; \
+  _vector_fill(vector, &tmp); \
+}
+
+/**
+ * @brief Return the sum of a vector of Int (0 if empty).
+ */
+Int vector_sum_int(
+  Vector* vector ///< "this" pointer.
+);
+
+/**
+ * @brief Return the minimum of a vector of Int (INT64_MAX if empty).
+ */
+Int vector_min_int(
+  Vector* vector ///< "this" pointer.
+);
+
+/**
+ * @brief Return the maximum of a vector of Int (INT64_MIN if empty).
+ */
+Int vector_max_int(
+  Vector* vector ///< "this" pointer.
+);
+
+/**
+ * @brief Return the sum of a vector of Real (0 if empty).
+ * @note Summation order differs from a sequential loop (rounding may vary).
+ */
+Real vector_sum_real(
+  Vector* vector ///< "this" pointer.
+);
+
+/**
+ * @brief Return the minimum of a vector of Real (INFINITY if empty).
+ * @note NaN values are not supported.
+ */
+Real vector_min_real(
+  Vector* vector ///< "this" pointer.
+);
+
+/**
+ * @brief Return the maximum of a vector of Real (-INFINITY if empty).
+ * @note NaN values are not supported.
+ */
+Real vector_max_real(
+  Vector* vector ///< "this" pointer.
+);
+
+//**************
+// Sorting logic
+//**************
+
+// NOTE: comparison functions follow qsort() convention: negative if
+// first argument is smaller, 0 if equal, positive otherwise.
+// Comparison sorts of large vectors are split across threads (one per
+// online CPU), and sorted parts merged in parallel.
+
+/**
+ * @brief Sort the vector with a comparison function (not stable).
+ */
+void vector_sort(
+  Vector* vector, ///< "this" pointer.
+  int (*compare)(const void*, const void*) ///< Comparison function.
+);
+
+/**
+ * @brief Sort the vector with a comparison function, keeping the relative
+ * order of equal elements.
+ */
+void vector_stable_sort(
+  Vector* vector, ///< "this" pointer.
+  int (*compare)(const void*, const void*) ///< Comparison function.
+);
+
+/**
+ * @brief Sort a vector of Int in increasing order (radix sort, stable).
+ */
+void vector_sort_int(
+  Vector* vector ///< "this" pointer.
+);
+
+/**
+ * @brief Sort a vector of UInt in increasing order (radix sort, stable).
+ */
+void vector_sort_uint(
+  Vector* vector ///< "this" pointer.
+);
+
+/**
+ * @brief Sort a vector of Real in increasing order (radix sort, stable).
+ * @note NaN values are not supported.
+ */
+void vector_sort_real(
+  Vector* vector ///< "this" pointer.
+);
+
+/**
+ * @brief Return the index of the first element not smaller than given data
+ * (vector->size if none), in a sorted vector.
+ */
+UInt _vector_lower_bound(
+  Vector* vector, ///< "this" pointer.
+  void* data, ///< Pointer to data to search.
+  int (*compare)(const void*, const void*) ///< Comparison function.
+);
+
+/**
+ * @brief Find the first element not smaller than given data, in a sorted
+ * vector.
+ * @param vector "this" pointer.
+ * @param data Data to search.
+ * @param compare Comparison function.
+ * @param index 'out' variable to contain the result (vector->size if none).
+ *
+ * Usage: void vector_lower_bound(Vector* vector, void data,
+ *                                int (*compare)(const void*, const void*),
+ *                                UInt index)
+ */
+#define vector_lower_bound(vector, data, compare, index) \
+{ \
+  typeof(data) tmp = data; \
+  index = _vector_lower_bound(vector, &tmp, compare); \
+}
+
+/**
+ * @brief Tell if given data is present in a sorted vector.
+ */
+bool _vector_binary_search(
+  Vector* vector, ///< "this" pointer.
+  void* data, ///< Pointer to data to search.
+  int (*compare)(const void*, const void*) ///< Comparison function.
+);
+
+/**
+ * @brief Tell if given data is present in a sorted vector.
+ * @param vector "this" pointer.
+ * @param data Data to search.
+ * @param compare Comparison function.
+ * @param found 'out' boolean variable to contain the result.
+ *
+ * Usage: void vector_binary_search(Vector* vector, void data,
+ *                                  int (*compare)(const void*, const void*),
+ *                                  bool found)
+ */
+#define vector_binary_search(vector, data, compare, found) \
+{ \
+  typeof(data) tmp = data; \
+  found = _vector_binary_search(vector, &tmp, compare); \
+}
+
 #endif
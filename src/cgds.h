@@ -2,14 +2,20 @@
 #define LIBCGDS_H
 
 // To include everything:
+#include <cgds/Arena.h>
+#include <cgds/BloomFilter.h>
 #include <cgds/BufferTop.h>
+#include <cgds/ConcurrentHashTable.h>
 #include <cgds/HashTable.h>
 #include <cgds/Heap.h>
 #include <cgds/List.h>
+#include <cgds/Pool.h>
 #include <cgds/PriorityQueue.h>
 #include <cgds/Queue.h>
+#include <cgds/RoaringSet.h>
 #include <cgds/Stack.h>
 #include <cgds/Tree.h>
 #include <cgds/Vector.h>
+#include <cgds/typed.h>
 
 #endif
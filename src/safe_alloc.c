@@ -2,7 +2,11 @@
  * @file safe_alloc.c
  */
 
+#define _GNU_SOURCE //for mremap()
 #include "cgds/safe_alloc.h"
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
 
 void* safe_malloc(size_t size)
 {
@@ -42,3 +46,125 @@ void safe_free(void* ptr)
   if (ptr != NULL)
     free(ptr);
 }
+
+void* safe_map(size_t size)
+{
+#ifdef __linux__
+  void* res = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (res == MAP_FAILED)
+  {
+    fprintf(stderr, "Error: unable to map memory\n");
+    exit(EXIT_FAILURE);
+  }
+#ifdef MADV_HUGEPAGE
+  // Only a hint: ignore failure (THP may be disabled)
+  madvise(res, size, MADV_HUGEPAGE);
+#endif
+  return res;
+#else
+  return safe_malloc(size);
+#endif
+}
+
+void* safe_remap(void* ptr, size_t oldSize, size_t size)
+{
+#ifdef __linux__
+  void* res = mremap(ptr, oldSize, size, MREMAP_MAYMOVE);
+  if (res == MAP_FAILED)
+  {
+    fprintf(stderr, "Error: unable to remap memory\n");
+    exit(EXIT_FAILURE);
+  }
+#ifdef MADV_HUGEPAGE
+  madvise(res, size, MADV_HUGEPAGE);
+#endif
+  return res;
+#else
+  return safe_realloc(ptr, size);
+#endif
+}
+
+void safe_unmap(void* ptr, size_t size)
+{
+#ifdef __linux__
+  if (ptr != NULL)
+    munmap(ptr, size);
+#else
+  safe_free(ptr);
+#endif
+}
+
+//////////////////////
+// Allocators logic //
+//////////////////////
+
+// Functions of the default allocator [internal usage]
+void* _safe_allocator_alloc(void* ctx, size_t size)
+{
+  (void)ctx;
+  return safe_malloc(size);
+}
+
+void* _safe_allocator_realloc(
+  void* ctx, void* ptr, size_t oldSize, size_t size)
+{
+  (void)ctx;
+  (void)oldSize;
+  return safe_realloc(ptr, size);
+}
+
+void _safe_allocator_free(void* ctx, void* ptr, size_t size)
+{
+  (void)ctx;
+  (void)size;
+  safe_free(ptr);
+}
+
+Allocator safe_allocator = {
+  .alloc = _safe_allocator_alloc,
+  .realloc = _safe_allocator_realloc,
+  .free = _safe_allocator_free,
+  .ctx = NULL
+};
+
+Allocator* allocator_or_default(Allocator* allocator)
+{
+  return allocator != NULL ? allocator : &safe_allocator;
+}
+
+void* allocator_alloc(Allocator* allocator, size_t size)
+{
+  void* res = allocator->alloc(allocator->ctx, size);
+  if (res == NULL)
+  {
+    fprintf(stderr, "Error: unable to allocate memory\n");
+    exit(EXIT_FAILURE);
+  }
+  return res;
+}
+
+void* allocator_realloc(
+  Allocator* allocator, void* ptr, size_t oldSize, size_t size)
+{
+  if (ptr == NULL)
+    return allocator_alloc(allocator, size);
+  void* res = allocator->realloc(allocator->ctx, ptr, oldSize, size);
+  if (res == NULL)
+  {
+    fprintf(stderr, "Error: unable to reallocate memory\n");
+    exit(EXIT_FAILURE);
+  }
+  return res;
+}
+
+bool allocator_frees(Allocator* allocator)
+{
+  return (allocator->free != NULL);
+}
+
+void allocator_free(Allocator* allocator, void* ptr, size_t size)
+{
+  if (ptr != NULL && allocator->free != NULL)
+    allocator->free(allocator->ctx, ptr, size);
+}
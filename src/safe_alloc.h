@@ -8,6 +8,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <stdbool.h>
 
 /**
  * @brief Wrapper around stdlib malloc function.
@@ -42,4 +43,101 @@ void safe_free(
   void* ptr ///< Pointer on the area to be destroyed.
 );
 
+/**
+ * @brief Allocate an anonymous memory mapping (transparent huge pages
+ * requested when available); falls back to malloc on non-Linux systems.
+ * @return A pointer to the newly mapped area; exit program if fail.
+ */
+void* safe_map(
+  size_t size ///< Size of the area to map, in bytes.
+);
+
+/**
+ * @brief Grow or shrink a mapping obtained with safe_map(), without copying
+ * whenever the kernel can move page tables (mremap).
+ * @return A pointer to the remapped area; exit program if fail.
+ */
+void* safe_remap(
+  void* ptr, ///< Pointer on the mapped area.
+  size_t oldSize, ///< Current size of the mapping, in bytes.
+  size_t size ///< New size of the mapping, in bytes.
+);
+
+/**
+ * @brief Release a mapping obtained with safe_map().
+ */
+void safe_unmap(
+  void* ptr, ///< Pointer on the mapped area.
+  size_t size ///< Size of the mapping, in bytes.
+);
+
+/**
+ * @brief Memory allocator used by a container: function table plus context.
+ *
+ * Functions receive the context as first argument, and the size of the
+ * block on realloc/free (useful to pools and counting allocators).
+ * They may return NULL on failure: callers then exit, as safe_malloc() does.
+ * free may be NULL when blocks are all released at once by the allocator
+ * owner (see Arena): containers then skip per-node release walks.
+ */
+typedef struct Allocator {
+  void* (*alloc)(void* ctx, size_t size); ///< Allocate size bytes.
+  void* (*realloc)(void* ctx, void* ptr, size_t oldSize, size_t size);
+    ///< Resize a block (ptr is never NULL).
+  void (*free)(void* ctx, void* ptr, size_t size);
+    ///< Release a block (ptr is never NULL); may be NULL.
+  void* ctx; ///< Allocator state (arena, pool, counters...).
+} Allocator;
+
+/**
+ * @brief Default allocator, wrapping safe_malloc(), safe_realloc() and
+ * safe_free().
+ */
+extern Allocator safe_allocator;
+
+/**
+ * @brief Return the given allocator, or the default one if NULL.
+ */
+Allocator* allocator_or_default(
+  Allocator* allocator ///< Allocator (may be NULL).
+);
+
+/**
+ * @brief Allocate a block through an allocator.
+ * @return A pointer to the newly allocated area; exit program if fail.
+ */
+void* allocator_alloc(
+  Allocator* allocator, ///< Allocator (not NULL).
+  size_t size ///< Size of the block to allocate, in bytes.
+);
+
+/**
+ * @brief Resize a block through an allocator (allocate it if ptr is NULL).
+ * @return A pointer to the newly allocated area; exit program if fail.
+ */
+void* allocator_realloc(
+  Allocator* allocator, ///< Allocator (not NULL).
+  void* ptr, ///< Pointer on the area to be relocated.
+  size_t oldSize, ///< Current size of the block, in bytes.
+  size_t size ///< Size of the block to reallocate, in bytes.
+);
+
+/**
+ * @brief Return true if blocks of the allocator are released one by one,
+ * false if they are released in bulk (free function is NULL).
+ */
+bool allocator_frees(
+  Allocator* allocator ///< Allocator (not NULL).
+);
+
+/**
+ * @brief Release a block through an allocator (nothing done if ptr is NULL,
+ * or if the allocator releases in bulk).
+ */
+void allocator_free(
+  Allocator* allocator, ///< Allocator (not NULL).
+  void* ptr, ///< Pointer on the area to be destroyed.
+  size_t size ///< Size of the block, in bytes.
+);
+
 #endif
@@ -0,0 +1,797 @@
+/**
+ * @file typed.h
+ * @brief Statically typed containers, generated at compile time.
+ *
+ * Each CGDS_DEFINE_xxx() macro expands into a struct and a family of
+ * static inline functions working on a given element type. Contrary to the
+ * generic containers, element size is known at compile time: data is
+ * accessed through plain assignments instead of memcpy(), and the compiler
+ * is free to inline and vectorize loops.
+ *
+ * Usage (at file scope):
+ *
+ *     CGDS_DEFINE_VECTOR(int, IntVec)
+ *     ...
+ *     IntVec* v = IntVec_new();
+ *     IntVec_push(v, 32);
+ *     int a = IntVec_get(v, 0); //a now contains 32
+ *     IntVec_destroy(v);
+ */
+
+#ifndef CGDS_TYPED_H
+#define CGDS_TYPED_H
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "cgds/safe_alloc.h"
+#include "cgds/types.h"
+
+/**
+ * @brief Default hash function on the bytes of a key (word at a time).
+ */
+static inline UInt _cgds_hash_bytes(const void* key, size_t size)
+{
+  const unsigned char* bytes = (const unsigned char*) key;
+  UInt res = 0x9E3779B97F4A7C15ULL ^ size;
+  uint64_t word;
+  while (size >= sizeof(word))
+  {
+    memcpy(&word, bytes, sizeof(word));
+    res = (res ^ word) * 0xFF51AFD7ED558CCDULL;
+    res ^= res >> 32;
+    bytes += sizeof(word);
+    size -= sizeof(word);
+  }
+  if (size > 0)
+  {
+    word = 0;
+    memcpy(&word, bytes, size);
+    res = (res ^ word) * 0xFF51AFD7ED558CCDULL;
+  }
+  // Final avalanche (from MurmurHash3 fmix64)
+  res ^= res >> 33;
+  res *= 0xC4CEB9FE1A85EC53ULL;
+  res ^= res >> 33;
+  return res;
+}
+
+/**
+ * @brief Hash function for (NUL-terminated) string keys.
+ */
+static inline UInt cgds_hash_string(char* key)
+{
+  return _cgds_hash_bytes(key, strlen(key));
+}
+
+/**
+ * @brief Equality function for (NUL-terminated) string keys.
+ */
+static inline bool cgds_equal_string(char* key1, char* key2)
+{
+  return (strcmp(key1, key2) == 0);
+}
+
+/**
+ * @brief State of a slot in an open-addressing table.
+ */
+typedef enum {
+  CGDS_SLOT_EMPTY = 0, ///< Never used since last rehash.
+  CGDS_SLOT_FULL = 1, ///< Contains an element.
+  CGDS_SLOT_DELETED = 2 ///< Element removed (tombstone).
+} CgdsSlotState;
+
+//*************
+// Vector logic
+//*************
+
+/**
+ * @brief Define a resizable array of elements of type T, named Name.
+ *
+ * Generated functions: Name_init, Name_init_with(vector, allocator),
+ * Name_new, Name_new_with(allocator), Name_copy, Name_empty, Name_size,
+ * Name_reserve, Name_push, Name_append_n, Name_pop, Name_get, Name_set,
+ * Name_at (pointer to element), Name_clear, Name_destroy.
+ * Growth and shrink follow the default policy of Vector.
+ */
+#define CGDS_DEFINE_VECTOR(T, Name) \
+typedef struct Name { \
+  T* datas; \
+  UInt size; \
+  UInt capacity; \
+  Allocator* allocator; \
+} Name; \
+\
+static inline void Name##_init_with(Name* vector, Allocator* allocator) \
+{ \
+  vector->datas = NULL; \
+  vector->size = 0; \
+  vector->capacity = 0; \
+  vector->allocator = allocator_or_default(allocator); \
+} \
+\
+static inline void Name##_init(Name* vector) \
+{ \
+  Name##_init_with(vector, NULL); \
+} \
+\
+static inline Name* Name##_new_with(Allocator* allocator) \
+{ \
+  allocator = allocator_or_default(allocator); \
+  Name* vector = (Name*) allocator_alloc(allocator, sizeof (Name)); \
+  Name##_init_with(vector, allocator); \
+  return vector; \
+} \
+\
+static inline Name* Name##_new(void) \
+{ \
+  return Name##_new_with(NULL); \
+} \
+\
+static inline bool Name##_empty(Name* vector) \
+{ \
+  return (vector->size == 0); \
+} \
+\
+static inline UInt Name##_size(Name* vector) \
+{ \
+  return vector->size; \
+} \
+\
+static inline void Name##_realloc(Name* vector, UInt newCapacity) \
+{ \
+  if (newCapacity == 0) \
+  { \
+    allocator_free( \
+      vector->allocator, vector->datas, vector->capacity * sizeof(T)); \
+    vector->datas = NULL; \
+  } \
+  else \
+  { \
+    vector->datas = (T*) allocator_realloc(vector->allocator, vector->datas, \
+      vector->capacity * sizeof(T), newCapacity * sizeof(T)); \
+  } \
+  vector->capacity = newCapacity; \
+} \
+\
+static inline void Name##_reserve(Name* vector, UInt capacity) \
+{ \
+  if (capacity > vector->capacity) \
+    Name##_realloc(vector, capacity); \
+} \
+\
+static inline Name* Name##_copy(Name* vector) \
+{ \
+  Name* vectorCopy = Name##_new_with(vector->allocator); \
+  Name##_reserve(vectorCopy, vector->size); \
+  for (UInt i = 0; i < vector->size; i++) \
+    vectorCopy->datas[i] = vector->datas[i]; \
+  vectorCopy->size = vector->size; \
+  return vectorCopy; \
+} \
+\
+static inline void Name##_push(Name* vector, T data) \
+{ \
+  if (vector->size >= vector->capacity) \
+    Name##_realloc(vector, vector->capacity > 0 ? 2 * vector->capacity : 1); \
+  vector->datas[vector->size++] = data; \
+} \
+\
+static inline void Name##_append_n(Name* vector, T* datas, UInt count) \
+{ \
+  if (vector->size + count > vector->capacity) \
+  { \
+    UInt increasedCapacity = 2 * vector->capacity; \
+    if (increasedCapacity < vector->size + count) \
+      increasedCapacity = vector->size + count; \
+    Name##_realloc(vector, increasedCapacity); \
+  } \
+  memcpy(vector->datas + vector->size, datas, count * sizeof(T)); \
+  vector->size += count; \
+} \
+\
+static inline void Name##_pop(Name* vector) \
+{ \
+  vector->size--; \
+  if (vector->capacity > 1 && vector->size < (vector->capacity >> 2)) \
+    Name##_realloc(vector, vector->capacity >> 1); \
+} \
+\
+static inline T Name##_get(Name* vector, UInt index) \
+{ \
+  return vector->datas[index]; \
+} \
+\
+static inline T* Name##_at(Name* vector, UInt index) \
+{ \
+  return vector->datas + index; \
+} \
+\
+static inline void Name##_set(Name* vector, UInt index, T data) \
+{ \
+  vector->datas[index] = data; \
+} \
+\
+static inline void Name##_clear(Name* vector) \
+{ \
+  vector->size = 0; \
+  Name##_realloc(vector, 0); \
+} \
+\
+static inline void Name##_destroy(Name* vector) \
+{ \
+  Name##_clear(vector); \
+  allocator_free(vector->allocator, vector, sizeof (Name)); \
+}
+
+//***********
+// Heap logic
+//***********
+
+/**
+ * @brief Define a d-ary heap of items of type T (with Real values), named
+ * Name. Items and values are stored side by side in one array of records.
+ *
+ * Generated functions: Name_new(OrderType, UInt arity),
+ * Name_new_with(OrderType, UInt arity, Allocator*), Name_copy, Name_empty,
+ * Name_size, Name_insert(heap, item, value), Name_top, Name_top_value,
+ * Name_pop, Name_clear, Name_destroy.
+ */
+#define CGDS_DEFINE_HEAP(T, Name) \
+typedef struct Name##Record { \
+  Real value; \
+  T item; \
+} Name##Record; \
+\
+typedef struct Name { \
+  OrderType hType; \
+  UInt arity; \
+  Name##Record* records; \
+  UInt size; \
+  UInt capacity; \
+  Allocator* allocator; \
+} Name; \
+\
+static inline Name* Name##_new_with( \
+  OrderType hType, UInt arity, Allocator* allocator) \
+{ \
+  allocator = allocator_or_default(allocator); \
+  Name* heap = (Name*) allocator_alloc(allocator, sizeof (Name)); \
+  heap->hType = hType; \
+  heap->arity = arity; \
+  heap->records = NULL; \
+  heap->size = 0; \
+  heap->capacity = 0; \
+  heap->allocator = allocator; \
+  return heap; \
+} \
+\
+static inline Name* Name##_new(OrderType hType, UInt arity) \
+{ \
+  return Name##_new_with(hType, arity, NULL); \
+} \
+\
+static inline Name* Name##_copy(Name* heap) \
+{ \
+  Name* heapCopy = Name##_new_with(heap->hType, heap->arity, heap->allocator); \
+  if (heap->size > 0) \
+  { \
+    heapCopy->records = (Name##Record*) \
+      allocator_alloc(heap->allocator, heap->size * sizeof (Name##Record)); \
+    memcpy(heapCopy->records, heap->records, \
+           heap->size * sizeof (Name##Record)); \
+  } \
+  heapCopy->size = heap->size; \
+  heapCopy->capacity = heap->size; \
+  return heapCopy; \
+} \
+\
+static inline bool Name##_empty(Name* heap) \
+{ \
+  return (heap->size == 0); \
+} \
+\
+static inline UInt Name##_size(Name* heap) \
+{ \
+  return heap->size; \
+} \
+\
+/* True if value v1 must be above value v2 in the heap */ \
+static inline bool Name##_before(Name* heap, Real v1, Real v2) \
+{ \
+  return (heap->hType == MIN_T ? v1 < v2 : v1 > v2); \
+} \
+\
+static inline void Name##_insert(Name* heap, T item, Real value) \
+{ \
+  if (heap->size >= heap->capacity) \
+  { \
+    UInt newCapacity = (heap->capacity > 0 ? 2 * heap->capacity : 1); \
+    heap->records = (Name##Record*) allocator_realloc(heap->allocator, \
+      heap->records, heap->capacity * sizeof (Name##Record), \
+      newCapacity * sizeof (Name##Record)); \
+    heap->capacity = newCapacity; \
+  } \
+  /* Bubble up: move parents down until the new record lands */ \
+  UInt currentIndex = heap->size++; \
+  while (currentIndex > 0) \
+  { \
+    UInt parentIndex = (currentIndex - 1) / heap->arity; \
+    if (!Name##_before(heap, value, heap->records[parentIndex].value)) \
+      break; \
+    heap->records[currentIndex] = heap->records[parentIndex]; \
+    currentIndex = parentIndex; \
+  } \
+  heap->records[currentIndex].value = value; \
+  heap->records[currentIndex].item = item; \
+} \
+\
+static inline T Name##_top(Name* heap) \
+{ \
+  return heap->records[0].item; \
+} \
+\
+static inline Real Name##_top_value(Name* heap) \
+{ \
+  return heap->records[0].value; \
+} \
+\
+static inline void Name##_pop(Name* heap) \
+{ \
+  Name##Record last = heap->records[--heap->size]; \
+  /* Bubble down: move top children up until the last record lands */ \
+  UInt currentIndex = 0; \
+  while (true) \
+  { \
+    UInt firstChild = currentIndex * heap->arity + 1; \
+    if (firstChild >= heap->size) \
+      break; \
+    UInt topChild = firstChild; \
+    for (UInt i = 1; i < heap->arity && firstChild + i < heap->size; i++) \
+    { \
+      if (Name##_before(heap, heap->records[firstChild + i].value, \
+                        heap->records[topChild].value)) \
+      { \
+        topChild = firstChild + i; \
+      } \
+    } \
+    if (!Name##_before(heap, heap->records[topChild].value, last.value)) \
+      break; \
+    heap->records[currentIndex] = heap->records[topChild]; \
+    currentIndex = topChild; \
+  } \
+  if (heap->size > 0) \
+    heap->records[currentIndex] = last; \
+} \
+\
+static inline void Name##_clear(Name* heap) \
+{ \
+  allocator_free(heap->allocator, heap->records, \
+                 heap->capacity * sizeof (Name##Record)); \
+  heap->records = NULL; \
+  heap->size = 0; \
+  heap->capacity = 0; \
+} \
+\
+static inline void Name##_destroy(Name* heap) \
+{ \
+  Name##_clear(heap); \
+  allocator_free(heap->allocator, heap, sizeof (Name)); \
+}
+
+//**********
+// Set logic
+//**********
+
+/**
+ * @brief Define a set of items of type T, named Name, with given hash
+ * function UInt hash(T) and equality function bool equal(T, T).
+ *
+ * Items are stored inline in an open-addressing table (linear probing),
+ * resized to keep load factor under 3/4.
+ * Generated functions: Name_new, Name_new_with(allocator), Name_copy,
+ * Name_empty, Name_size, Name_has, Name_add, Name_delete, Name_clear,
+ * Name_destroy.
+ * To iterate: loop over slots i < set->capacity with
+ * set->states[i] == CGDS_SLOT_FULL, and read set->items[i].
+ */
+#define CGDS_DEFINE_SET_EX(T, Name, hash, equal) \
+typedef struct Name { \
+  T* items; \
+  unsigned char* states; \
+  UInt size; \
+  UInt used; /* full + deleted slots */ \
+  UInt capacity; \
+  Allocator* allocator; \
+} Name; \
+\
+static inline Name* Name##_new_with(Allocator* allocator) \
+{ \
+  allocator = allocator_or_default(allocator); \
+  Name* set = (Name*) allocator_alloc(allocator, sizeof (Name)); \
+  set->items = NULL; \
+  set->states = NULL; \
+  set->size = 0; \
+  set->used = 0; \
+  set->capacity = 0; \
+  set->allocator = allocator; \
+  return set; \
+} \
+\
+static inline Name* Name##_new(void) \
+{ \
+  return Name##_new_with(NULL); \
+} \
+\
+static inline bool Name##_empty(Name* set) \
+{ \
+  return (set->size == 0); \
+} \
+\
+static inline UInt Name##_size(Name* set) \
+{ \
+  return set->size; \
+} \
+\
+static inline void Name##_rehash(Name* set, UInt newCapacity) \
+{ \
+  T* items = set->items; \
+  unsigned char* states = set->states; \
+  UInt capacity = set->capacity; \
+  set->items = (T*) allocator_alloc(set->allocator, newCapacity * sizeof(T)); \
+  set->states = (unsigned char*) allocator_alloc(set->allocator, newCapacity); \
+  memset(set->states, CGDS_SLOT_EMPTY, newCapacity); \
+  set->capacity = newCapacity; \
+  set->used = set->size; \
+  UInt mask = newCapacity - 1; \
+  for (UInt i = 0; i < capacity; i++) \
+  { \
+    if (states[i] != CGDS_SLOT_FULL) \
+      continue; \
+    UInt j = hash(items[i]) & mask; \
+    while (set->states[j] != CGDS_SLOT_EMPTY) \
+      j = (j + 1) & mask; \
+    set->states[j] = CGDS_SLOT_FULL; \
+    set->items[j] = items[i]; \
+  } \
+  allocator_free(set->allocator, items, capacity * sizeof(T)); \
+  allocator_free(set->allocator, states, capacity); \
+} \
+\
+static inline Name* Name##_copy(Name* set) \
+{ \
+  Name* setCopy = Name##_new_with(set->allocator); \
+  if (set->capacity > 0) \
+  { \
+    setCopy->items = \
+      (T*) allocator_alloc(set->allocator, set->capacity * sizeof(T)); \
+    memcpy(setCopy->items, set->items, set->capacity * sizeof(T)); \
+    setCopy->states = \
+      (unsigned char*) allocator_alloc(set->allocator, set->capacity); \
+    memcpy(setCopy->states, set->states, set->capacity); \
+  } \
+  setCopy->size = set->size; \
+  setCopy->used = set->used; \
+  setCopy->capacity = set->capacity; \
+  return setCopy; \
+} \
+\
+static inline bool Name##_has(Name* set, T item) \
+{ \
+  if (set->capacity == 0) \
+    return false; \
+  UInt mask = set->capacity - 1, \
+       i = hash(item) & mask; \
+  while (set->states[i] != CGDS_SLOT_EMPTY) \
+  { \
+    if (set->states[i] == CGDS_SLOT_FULL && equal(set->items[i], item)) \
+      return true; \
+    i = (i + 1) & mask; \
+  } \
+  return false; \
+} \
+\
+static inline void Name##_add(Name* set, T item) \
+{ \
+  if ((set->used + 1) * 4 > set->capacity * 3) \
+  { \
+    /* Grow if really full, otherwise just clean tombstones */ \
+    UInt newCapacity = (set->capacity > 0 ? set->capacity : 8); \
+    while ((set->size + 1) * 2 > newCapacity) \
+      newCapacity *= 2; \
+    Name##_rehash(set, newCapacity); \
+  } \
+  UInt mask = set->capacity - 1, \
+       i = hash(item) & mask, \
+       freeSlot = set->capacity; \
+  while (set->states[i] != CGDS_SLOT_EMPTY) \
+  { \
+    if (set->states[i] == CGDS_SLOT_FULL && equal(set->items[i], item)) \
+      /* Already here: nothing to do */ \
+      return; \
+    if (set->states[i] == CGDS_SLOT_DELETED && freeSlot == set->capacity) \
+      freeSlot = i; \
+    i = (i + 1) & mask; \
+  } \
+  if (freeSlot < set->capacity) \
+    i = freeSlot; \
+  else \
+    set->used++; \
+  set->states[i] = CGDS_SLOT_FULL; \
+  set->items[i] = item; \
+  set->size++; \
+} \
+\
+static inline void Name##_delete(Name* set, T item) \
+{ \
+  if (set->capacity == 0) \
+    return; \
+  UInt mask = set->capacity - 1, \
+       i = hash(item) & mask; \
+  while (set->states[i] != CGDS_SLOT_EMPTY) \
+  { \
+    if (set->states[i] == CGDS_SLOT_FULL && equal(set->items[i], item)) \
+    { \
+      set->states[i] = CGDS_SLOT_DELETED; \
+      set->size--; \
+      return; \
+    } \
+    i = (i + 1) & mask; \
+  } \
+} \
+\
+static inline void Name##_clear(Name* set) \
+{ \
+  if (set->capacity > 0) \
+    memset(set->states, CGDS_SLOT_EMPTY, set->capacity); \
+  set->size = 0; \
+  set->used = 0; \
+} \
+\
+static inline void Name##_destroy(Name* set) \
+{ \
+  allocator_free(set->allocator, set->items, set->capacity * sizeof(T)); \
+  allocator_free(set->allocator, set->states, set->capacity); \
+  allocator_free(set->allocator, set, sizeof (Name)); \
+}
+
+/**
+ * @brief Define a set of items of type T, named Name, hashing and comparing
+ * the bytes of items (as Set does by default).
+ */
+#define CGDS_DEFINE_SET(T, Name) \
+static inline UInt Name##_hash_item(T item) \
+{ \
+  return _cgds_hash_bytes(&item, sizeof(T)); \
+} \
+static inline bool Name##_equal_items(T item1, T item2) \
+{ \
+  return (memcmp(&item1, &item2, sizeof(T)) == 0); \
+} \
+CGDS_DEFINE_SET_EX(T, Name, Name##_hash_item, Name##_equal_items)
+
+//****************
+// HashTable logic
+//****************
+
+/**
+ * @brief Define a dictionary K --> V, named Name, with given hash function
+ * UInt hash(K) and equality function bool equal(K, K).
+ *
+ * Keys and values are stored inline in an open-addressing table (linear
+ * probing), resized to keep load factor under 3/4. Keys are copied by
+ * assignment: for char* keys (see cgds_hash_string, cgds_equal_string),
+ * pointed strings must outlive the table.
+ * Generated functions: Name_new, Name_new_with(allocator), Name_copy,
+ * Name_empty, Name_size, Name_get (pointer to value, NULL if absent),
+ * Name_set, Name_delete, Name_clear, Name_destroy.
+ */
+#define CGDS_DEFINE_HASHTABLE_EX(K, V, Name, hash, equal) \
+typedef struct Name { \
+  K* keys; \
+  V* values; \
+  unsigned char* states; \
+  UInt size; \
+  UInt used; /* full + deleted slots */ \
+  UInt capacity; \
+  Allocator* allocator; \
+} Name; \
+\
+static inline Name* Name##_new_with(Allocator* allocator) \
+{ \
+  allocator = allocator_or_default(allocator); \
+  Name* hashTable = (Name*) allocator_alloc(allocator, sizeof (Name)); \
+  hashTable->keys = NULL; \
+  hashTable->values = NULL; \
+  hashTable->states = NULL; \
+  hashTable->size = 0; \
+  hashTable->used = 0; \
+  hashTable->capacity = 0; \
+  hashTable->allocator = allocator; \
+  return hashTable; \
+} \
+\
+static inline Name* Name##_new(void) \
+{ \
+  return Name##_new_with(NULL); \
+} \
+\
+static inline bool Name##_empty(Name* hashTable) \
+{ \
+  return (hashTable->size == 0); \
+} \
+\
+static inline UInt Name##_size(Name* hashTable) \
+{ \
+  return hashTable->size; \
+} \
+\
+static inline void Name##_rehash(Name* hashTable, UInt newCapacity) \
+{ \
+  K* keys = hashTable->keys; \
+  V* values = hashTable->values; \
+  unsigned char* states = hashTable->states; \
+  UInt capacity = hashTable->capacity; \
+  Allocator* allocator = hashTable->allocator; \
+  hashTable->keys = (K*) allocator_alloc(allocator, newCapacity * sizeof(K)); \
+  hashTable->values = \
+    (V*) allocator_alloc(allocator, newCapacity * sizeof(V)); \
+  hashTable->states = \
+    (unsigned char*) allocator_alloc(allocator, newCapacity); \
+  memset(hashTable->states, CGDS_SLOT_EMPTY, newCapacity); \
+  hashTable->capacity = newCapacity; \
+  hashTable->used = hashTable->size; \
+  UInt mask = newCapacity - 1; \
+  for (UInt i = 0; i < capacity; i++) \
+  { \
+    if (states[i] != CGDS_SLOT_FULL) \
+      continue; \
+    UInt j = hash(keys[i]) & mask; \
+    while (hashTable->states[j] != CGDS_SLOT_EMPTY) \
+      j = (j + 1) & mask; \
+    hashTable->states[j] = CGDS_SLOT_FULL; \
+    hashTable->keys[j] = keys[i]; \
+    hashTable->values[j] = values[i]; \
+  } \
+  allocator_free(allocator, keys, capacity * sizeof(K)); \
+  allocator_free(allocator, values, capacity * sizeof(V)); \
+  allocator_free(allocator, states, capacity); \
+} \
+\
+static inline Name* Name##_copy(Name* hashTable) \
+{ \
+  Allocator* allocator = hashTable->allocator; \
+  Name* hashTableCopy = Name##_new_with(allocator); \
+  UInt capacity = hashTable->capacity; \
+  if (capacity > 0) \
+  { \
+    hashTableCopy->keys = \
+      (K*) allocator_alloc(allocator, capacity * sizeof(K)); \
+    memcpy(hashTableCopy->keys, hashTable->keys, capacity * sizeof(K)); \
+    hashTableCopy->values = \
+      (V*) allocator_alloc(allocator, capacity * sizeof(V)); \
+    memcpy(hashTableCopy->values, hashTable->values, capacity * sizeof(V)); \
+    hashTableCopy->states = \
+      (unsigned char*) allocator_alloc(allocator, capacity); \
+    memcpy(hashTableCopy->states, hashTable->states, capacity); \
+  } \
+  hashTableCopy->size = hashTable->size; \
+  hashTableCopy->used = hashTable->used; \
+  hashTableCopy->capacity = capacity; \
+  return hashTableCopy; \
+} \
+\
+static inline V* Name##_get(Name* hashTable, K key) \
+{ \
+  if (hashTable->capacity == 0) \
+    return NULL; \
+  UInt mask = hashTable->capacity - 1, \
+       i = hash(key) & mask; \
+  while (hashTable->states[i] != CGDS_SLOT_EMPTY) \
+  { \
+    if ( \
+      hashTable->states[i] == CGDS_SLOT_FULL && \
+      equal(hashTable->keys[i], key) \
+    ) { \
+      return hashTable->values + i; \
+    } \
+    i = (i + 1) & mask; \
+  } \
+  return NULL; \
+} \
+\
+static inline void Name##_set(Name* hashTable, K key, V value) \
+{ \
+  if ((hashTable->used + 1) * 4 > hashTable->capacity * 3) \
+  { \
+    /* Grow if really full, otherwise just clean tombstones */ \
+    UInt newCapacity = (hashTable->capacity > 0 ? hashTable->capacity : 8); \
+    while ((hashTable->size + 1) * 2 > newCapacity) \
+      newCapacity *= 2; \
+    Name##_rehash(hashTable, newCapacity); \
+  } \
+  UInt mask = hashTable->capacity - 1, \
+       i = hash(key) & mask, \
+       freeSlot = hashTable->capacity; \
+  while (hashTable->states[i] != CGDS_SLOT_EMPTY) \
+  { \
+    if ( \
+      hashTable->states[i] == CGDS_SLOT_FULL && \
+      equal(hashTable->keys[i], key) \
+    ) { \
+      /* Modify: */ \
+      hashTable->values[i] = value; \
+      return; \
+    } \
+    if ( \
+      hashTable->states[i] == CGDS_SLOT_DELETED && \
+      freeSlot == hashTable->capacity \
+    ) { \
+      freeSlot = i; \
+    } \
+    i = (i + 1) & mask; \
+  } \
+  if (freeSlot < hashTable->capacity) \
+    i = freeSlot; \
+  else \
+    hashTable->used++; \
+  hashTable->states[i] = CGDS_SLOT_FULL; \
+  hashTable->keys[i] = key; \
+  hashTable->values[i] = value; \
+  hashTable->size++; \
+} \
+\
+static inline void Name##_delete(Name* hashTable, K key) \
+{ \
+  if (hashTable->capacity == 0) \
+    return; \
+  UInt mask = hashTable->capacity - 1, \
+       i = hash(key) & mask; \
+  while (hashTable->states[i] != CGDS_SLOT_EMPTY) \
+  { \
+    if ( \
+      hashTable->states[i] == CGDS_SLOT_FULL && \
+      equal(hashTable->keys[i], key) \
+    ) { \
+      hashTable->states[i] = CGDS_SLOT_DELETED; \
+      hashTable->size--; \
+      return; \
+    } \
+    i = (i + 1) & mask; \
+  } \
+} \
+\
+static inline void Name##_clear(Name* hashTable) \
+{ \
+  if (hashTable->capacity > 0) \
+    memset(hashTable->states, CGDS_SLOT_EMPTY, hashTable->capacity); \
+  hashTable->size = 0; \
+  hashTable->used = 0; \
+} \
+\
+static inline void Name##_destroy(Name* hashTable) \
+{ \
+  Allocator* allocator = hashTable->allocator; \
+  UInt capacity = hashTable->capacity; \
+  allocator_free(allocator, hashTable->keys, capacity * sizeof(K)); \
+  allocator_free(allocator, hashTable->values, capacity * sizeof(V)); \
+  allocator_free(allocator, hashTable->states, capacity); \
+  allocator_free(allocator, hashTable, sizeof (Name)); \
+}
+
+/**
+ * @brief Define a dictionary K --> V, named Name, hashing and comparing
+ * the bytes of keys.
+ */
+#define CGDS_DEFINE_HASHTABLE(K, V, Name) \
+static inline UInt Name##_hash_key(K key) \
+{ \
+  return _cgds_hash_bytes(&key, sizeof(K)); \
+} \
+static inline bool Name##_equal_keys(K key1, K key2) \
+{ \
+  return (memcmp(&key1, &key2, sizeof(K)) == 0); \
+} \
+CGDS_DEFINE_HASHTABLE_EX(K, V, Name, Name##_hash_key, Name##_equal_keys)
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef HELPERS_H
 #define HELPERS_H
 
+#include "cgds/safe_alloc.h"
+
 // types (POD) to be used as items inside our data structures
 typedef struct {
   int a;
@@ -12,4 +14,46 @@ typedef struct {
   StructTest1* b;
 } StructTest2;
 
+// allocator counting live blocks and bytes, to check containers release all
+typedef struct {
+  size_t bytes;
+  size_t blocks;
+} AllocCounter;
+
+static inline void* counting_alloc(void* ctx, size_t size)
+{
+  AllocCounter* counter = (AllocCounter*)ctx;
+  counter->bytes += size;
+  counter->blocks++;
+  return malloc(size);
+}
+
+static inline void* counting_realloc(
+  void* ctx, void* ptr, size_t oldSize, size_t size)
+{
+  AllocCounter* counter = (AllocCounter*)ctx;
+  counter->bytes += size - oldSize;
+  return realloc(ptr, size);
+}
+
+static inline void counting_free(void* ctx, void* ptr, size_t size)
+{
+  AllocCounter* counter = (AllocCounter*)ctx;
+  counter->bytes -= size;
+  counter->blocks--;
+  free(ptr);
+}
+
+static inline Allocator counting_allocator(AllocCounter* counter)
+{
+  counter->bytes = 0;
+  counter->blocks = 0;
+  return (Allocator) {
+    .alloc = counting_alloc,
+    .realloc = counting_realloc,
+    .free = counting_free,
+    .ctx = counter
+  };
+}
+
 #endif
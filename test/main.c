@@ -22,6 +22,7 @@ int main(int argc, char** argv)
 	t_heap_push_pop_basic();
 	t_heap_push_pop_evolved();
 	t_heap_copy();
+	t_heap_records();
 
 	//file ./t.Set.c :
 	t_set_clear();
@@ -30,6 +31,9 @@ int main(int argc, char** argv)
 	t_set_getnull_modify();
 	t_set_copy();
 	t_set_tovect();
+	t_set_resize();
+	t_set_algebra();
+	t_set_filter();
 
 	//file ./t.List.c :
 	t_list_clear();
@@ -37,6 +41,7 @@ int main(int argc, char** argv)
 	t_list_push_pop_basic();
 	t_list_push_pop_evolved();
 	t_list_copy();
+	t_list_inline_data();
 
 	//file ./t.BufferTop.c :
 	t_buffertop_clear();
@@ -51,6 +56,16 @@ int main(int argc, char** argv)
 	t_hashtable_set_remove_basic();
 	t_hashtable_getnull_modify();
 	t_hashtable_copy();
+	t_hashtable_allocator();
+	t_hashtable_resize();
+	t_hashtable_long_keys();
+	t_hashtable_binary_keys();
+	t_hashtable_key_storage();
+	t_hashtable_iterator();
+	t_hashtable_chunks();
+	t_hashtable_incremental_rehash();
+	t_hashtable_get_batch();
+	t_hashtable_filter();
 
 	//file ./t.Stack.c :
 	t_stack_clear();
@@ -72,6 +87,52 @@ int main(int argc, char** argv)
 	t_vector_push_pop_basic();
 	t_vector_push_pop_evolved();
 	t_vector_copy();
+	t_vector_growth_policy();
+	t_vector_shrink_policy();
+	t_vector_bulk_ranges();
+	t_vector_kernels();
+	t_vector_sort();
+	t_vector_mmap();
+	t_vector_small();
+	t_vector_allocator();
+
+	//file ./t.typed.c :
+	t_typed_vector();
+	t_typed_heap();
+	t_typed_set();
+	t_typed_hashtable();
+	t_typed_allocator();
+
+	//file ./t.Arena.c :
+	t_arena_alloc();
+	t_arena_realloc();
+	t_arena_reset();
+	t_arena_containers();
+
+	//file ./t.Pool.c :
+	t_pool_alloc_free();
+	t_pool_contiguous();
+	t_pool_release();
+	t_pool_containers();
+
+	//file ./t.ConcurrentHashTable.c :
+	t_concurrenthashtable_basic();
+	t_concurrenthashtable_keyed();
+	t_concurrenthashtable_threads();
+	t_concurrenthashtable_clear_threads();
+
+	//file ./t.RoaringSet.c :
+	t_roaringset_basic();
+	t_roaringset_containers();
+	t_roaringset_algebra();
+	t_roaringset_memory();
+	t_roaringset_allocator();
+
+	//file ./t.BloomFilter.c :
+	t_bloomfilter_basic();
+	t_bloomfilter_hashes();
+	t_bloomfilter_serialize();
+	t_bloomfilter_allocator();
 
 	return 0;
 }
@@ -0,0 +1,126 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include "cgds/Arena.h"
+#include "cgds/List.h"
+#include "cgds/Tree.h"
+#include "cgds/HashTable.h"
+#include "cgds/Vector.h"
+#include "helpers.h"
+#include "lut.h"
+
+void t_arena_alloc()
+{
+  Arena* arena = arena_new(1024);
+  lu_assert_int_eq(arena_used(arena), 0);
+
+  // Blocks are aligned and do not overlap
+  char* blocks[100];
+  for (int i = 0; i < 100; i++)
+  {
+    blocks[i] = (char*) arena_alloc(arena, i + 1);
+    lu_assert_int_eq((uintptr_t)blocks[i] & 15, 0);
+    memset(blocks[i], i, i + 1);
+  }
+  for (int i = 0; i < 100; i++)
+  {
+    for (int j = 0; j <= i; j++)
+      lu_assert_int_eq(blocks[i][j], i);
+  }
+
+  // Block larger than a chunk
+  char* big = (char*) arena_alloc(arena, 10000);
+  memset(big, 1, 10000);
+  lu_assert(arena_used(arena) >= 10000);
+
+  arena_destroy(arena);
+}
+
+void t_arena_realloc()
+{
+  Arena* arena = arena_new(1024);
+
+  // Last block grows in place
+  int* a = (int*) arena_alloc(arena, 4 * sizeof(int));
+  for (int i = 0; i < 4; i++)
+    a[i] = i;
+  int* b = (int*) arena_realloc(arena, a, 4 * sizeof(int), 8 * sizeof(int));
+  lu_assert(a == b);
+
+  // Other blocks are copied
+  arena_alloc(arena, 16);
+  int* c = (int*) arena_realloc(arena, b, 8 * sizeof(int), 16 * sizeof(int));
+  lu_assert(c != b);
+  for (int i = 0; i < 4; i++)
+    lu_assert_int_eq(c[i], i);
+
+  arena_destroy(arena);
+}
+
+void t_arena_reset()
+{
+  Arena* arena = arena_new(0);
+  for (int i = 0; i < 10000; i++)
+    arena_alloc(arena, 64);
+  lu_assert_int_eq(arena_used(arena), 10000 * 64);
+  lu_assert(arena->chunks->next != NULL);
+
+  arena_reset(arena);
+  lu_assert_int_eq(arena_used(arena), 0);
+  lu_assert(arena->chunks->next == NULL);
+  arena_alloc(arena, 64);
+  lu_assert_int_eq(arena_used(arena), 64);
+
+  // Stack-allocated arena
+  Arena localArena;
+  arena_init(&localArena, 128);
+  arena_alloc(&localArena, 1000);
+  arena_release(&localArena);
+  lu_assert(localArena.chunks == NULL);
+
+  arena_destroy(arena);
+}
+
+void t_arena_containers()
+{
+  Arena* arena = arena_new(0);
+  Allocator* allocator = arena_allocator(arena);
+
+  List* l = list_new_with(int, allocator);
+  Tree* t = tree_new_with(int, allocator);
+  HashTable* h = hashtable_new_with(int, 16, allocator);
+  Vector* v = vector_new_with(int, allocator);
+  tree_set_root(t, 0);
+  char key[16];
+  for (int i = 0; i < 1000; i++)
+  {
+    list_insert_back(l, i);
+    tree_add_child(t, t->root, i);
+    sprintf(key, "key%i", i);
+    hashtable_set(h, key, i);
+    vector_push(v, i);
+  }
+  int a;
+  list_get(l->tail, a);
+  lu_assert_int_eq(a, 999);
+  int* pa;
+  hashtable_get(h, "key500", pa);
+  lu_assert_int_eq(*pa, 500);
+
+  // Clear without walking the nodes: containers are reusable
+  list_clear(l);
+  tree_clear(t);
+  hashtable_clear(h);
+  lu_assert(list_empty(l));
+  lu_assert(tree_empty(t));
+  lu_assert(hashtable_empty(h));
+  hashtable_get(h, "key500", pa);
+  lu_assert(pa == NULL);
+  list_insert_front(l, 42);
+  list_get(l->head, a);
+  lu_assert_int_eq(a, 42);
+  hashtable_set(h, "key", 42);
+  lu_assert_int_eq(hashtable_size(h), 1);
+
+  // Everything released at once
+  arena_destroy(arena);
+}
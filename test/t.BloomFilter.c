@@ -0,0 +1,108 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include "cgds/BloomFilter.h"
+#include "helpers.h"
+#include "lut.h"
+
+void t_bloomfilter_basic()
+{
+  BloomFilter* f = bloomfilter_new(10000, 0.01);
+  lu_assert_int_eq(bloomfilter_size(f), 0);
+  lu_assert(!bloomfilter_has(f, "key", 3));
+
+  char key[32];
+  for (int i = 0; i < 10000; i++)
+  {
+    int length = sprintf(key, "key%i", i);
+    bloomfilter_add(f, key, length);
+  }
+  lu_assert_int_eq(bloomfilter_size(f), 10000);
+  // No false negatives
+  for (int i = 0; i < 10000; i++)
+  {
+    int length = sprintf(key, "key%i", i);
+    lu_assert(bloomfilter_has(f, key, length));
+  }
+  // False positives close to the target rate
+  int falsePositives = 0;
+  for (int i = 0; i < 100000; i++)
+  {
+    int length = sprintf(key, "other%i", i);
+    falsePositives += bloomfilter_has(f, key, length);
+  }
+  lu_assert_int_lt(falsePositives, 2000);
+
+  bloomfilter_clear(f);
+  lu_assert_int_eq(bloomfilter_size(f), 0);
+  lu_assert(!bloomfilter_has(f, "key7", 4));
+  bloomfilter_destroy(f);
+}
+
+void t_bloomfilter_hashes()
+{
+  // Small integer hashes (e.g. custom ones) are mixed before use
+  BloomFilter* f = bloomfilter_new(1000, 0.001);
+  for (UInt i = 0; i < 1000; i++)
+    bloomfilter_add_hash(f, 2 * i);
+  int falsePositives = 0;
+  for (UInt i = 0; i < 1000; i++)
+  {
+    lu_assert(bloomfilter_has_hash(f, 2 * i));
+    falsePositives += bloomfilter_has_hash(f, 2 * i + 1);
+  }
+  lu_assert_int_lt(falsePositives, 10);
+
+  BloomFilter* copy = bloomfilter_copy(f);
+  bloomfilter_clear(f);
+  lu_assert(!bloomfilter_has_hash(f, 4));
+  lu_assert(bloomfilter_has_hash(copy, 4));
+  lu_assert_int_eq(bloomfilter_size(copy), 1000);
+  bloomfilter_destroy(copy);
+  bloomfilter_destroy(f);
+}
+
+void t_bloomfilter_serialize()
+{
+  BloomFilter* f = bloomfilter_new(5000, 0.02);
+  for (int i = 0; i < 5000; i++)
+    bloomfilter_add(f, &i, sizeof(int));
+  size_t length = bloomfilter_serialized_size(f);
+  lu_assert_int_eq(length,
+    BLOOMFILTER_HEADER_SIZE + f->blocksCount * 8 * BLOOMFILTER_BLOCK_WORDS);
+  unsigned char* buffer = malloc(length);
+  bloomfilter_serialize(f, buffer);
+
+  BloomFilter* g = bloomfilter_deserialize(buffer, length);
+  lu_assert(g != NULL);
+  lu_assert_int_eq(bloomfilter_size(g), 5000);
+  lu_assert_int_eq(g->hashCount, f->hashCount);
+  lu_assert(g->falsePositiveRate == f->falsePositiveRate);
+  for (int i = 0; i < 10000; i++)
+    lu_assert(bloomfilter_has(g, &i, sizeof(int)) ==
+              bloomfilter_has(f, &i, sizeof(int)));
+  bloomfilter_destroy(g);
+
+  // Invalid buffers
+  lu_assert(bloomfilter_deserialize(buffer, length - 1) == NULL);
+  lu_assert(bloomfilter_deserialize(buffer, 10) == NULL);
+  buffer[0] = 'X';
+  lu_assert(bloomfilter_deserialize(buffer, length) == NULL);
+  free(buffer);
+  bloomfilter_destroy(f);
+}
+
+void t_bloomfilter_allocator()
+{
+  AllocCounter counter;
+  Allocator allocator = counting_allocator(&counter);
+  BloomFilter* f = bloomfilter_new_with(100, 0.05, &allocator);
+  bloomfilter_add(f, "a", 1);
+  BloomFilter* g = bloomfilter_copy(f);
+  lu_assert(bloomfilter_has(g, "a", 1));
+  // Blocks are aligned on cache lines
+  lu_assert_int_eq((size_t)g->words % 64, 0);
+  bloomfilter_destroy(f);
+  bloomfilter_destroy(g);
+  lu_assert_int_eq(counter.blocks, 0);
+  lu_assert_int_eq(counter.bytes, 0);
+}
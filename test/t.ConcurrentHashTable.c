@@ -0,0 +1,205 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <pthread.h>
+#include "cgds/ConcurrentHashTable.h"
+#include "helpers.h"
+#include "lut.h"
+
+void t_concurrenthashtable_basic()
+{
+  AllocCounter counter;
+  Allocator allocator = counting_allocator(&counter);
+  ConcurrentHashTable* h = concurrenthashtable_new_with(int, 4, &allocator);
+  lu_assert(concurrenthashtable_empty(h));
+
+  char key[32];
+  for (int i = 0; i < 1000; i++)
+  {
+    sprintf(key, "key%i", i);
+    concurrenthashtable_set(h, key, i);
+  }
+  lu_assert_int_eq(concurrenthashtable_size(h), 1000);
+  lu_assert(h->buckets->count >= 1000);
+
+  int a;
+  for (int i = 0; i < 1000; i++)
+  {
+    sprintf(key, "key%i", i);
+    lu_assert(concurrenthashtable_get(h, key, a));
+    lu_assert_int_eq(a, i);
+  }
+  lu_assert(!concurrenthashtable_get(h, "key", a));
+
+  // Modify, delete
+  concurrenthashtable_set(h, "key7", -7);
+  lu_assert(concurrenthashtable_get(h, "key7", a));
+  lu_assert_int_eq(a, -7);
+  lu_assert(concurrenthashtable_delete(h, "key8"));
+  lu_assert(!concurrenthashtable_delete(h, "key8"));
+  lu_assert(!concurrenthashtable_contains(h, "key8"));
+  lu_assert(concurrenthashtable_contains(h, "key9"));
+  lu_assert_int_eq(concurrenthashtable_size(h), 999);
+
+  concurrenthashtable_clear(h);
+  lu_assert(concurrenthashtable_empty(h));
+  lu_assert(!concurrenthashtable_contains(h, "key9"));
+  concurrenthashtable_set(h, "key9", 9);
+  lu_assert_int_eq(concurrenthashtable_size(h), 1);
+
+  // Retired nodes are released with the table
+  concurrenthashtable_destroy(h);
+  lu_assert_int_eq(counter.blocks, 0);
+  lu_assert_int_eq(counter.bytes, 0);
+}
+
+void t_concurrenthashtable_keyed()
+{
+  // Integer keys without data: a concurrent set
+  typedef struct {} Nothing;
+  ConcurrentHashTable* s =
+    concurrenthashtable_new_keyed(int, Nothing, 16, NULL, NULL);
+  Nothing nothing;
+  for (int i = 0; i < 500; i++)
+  {
+    int k = 3 * i;
+    _concurrenthashtable_set(s, &k, &nothing);
+  }
+  lu_assert_int_eq(concurrenthashtable_size(s), 500);
+  for (int i = 0; i < 1500; i++)
+  {
+    int remainder = i % 3;
+    lu_assert(concurrenthashtable_contains(s, &i) == (remainder == 0));
+  }
+  concurrenthashtable_destroy(s);
+}
+
+typedef struct {
+  ConcurrentHashTable* table;
+  int id;
+  int count;
+  int errors;
+} ConcurrentArg;
+
+// Writer: insert own keys, values (v, -v) always updated as a whole
+void* _concurrent_writer(void* p)
+{
+  ConcurrentArg* arg = (ConcurrentArg*)p;
+  char key[32];
+  for (int round = 0; round < 3; round++)
+  {
+    for (int i = 0; i < arg->count; i++)
+    {
+      sprintf(key, "w%i_%i", arg->id, i);
+      StructTest1 value = {round * i, -(double)(round * i)};
+      _concurrenthashtable_set(arg->table, key, &value);
+    }
+    for (int i = 0; i < arg->count; i += 2)
+    {
+      sprintf(key, "w%i_%i", arg->id, i);
+      concurrenthashtable_delete(arg->table, key);
+    }
+  }
+  return NULL;
+}
+
+// Reader: lookups never see torn values
+void* _concurrent_reader(void* p)
+{
+  ConcurrentArg* arg = (ConcurrentArg*)p;
+  char key[32];
+  StructTest1 value;
+  for (int round = 0; round < 3; round++)
+  {
+    for (int i = 0; i < arg->count; i++)
+    {
+      sprintf(key, "w%i_%i", i % 4, i);
+      if (_concurrenthashtable_get(arg->table, key, &value) &&
+          value.b != -(double)value.a)
+      {
+        arg->errors++;
+      }
+    }
+  }
+  return NULL;
+}
+
+void t_concurrenthashtable_threads()
+{
+  ConcurrentHashTable* h = concurrenthashtable_new(StructTest1, 8);
+  int count = 5000;
+  pthread_t threads[8];
+  ConcurrentArg args[8];
+  for (int t = 0; t < 8; t++)
+  {
+    args[t] = (ConcurrentArg){h, t % 4, count, 0};
+    pthread_create(&threads[t], NULL,
+                   t < 4 ? _concurrent_writer : _concurrent_reader, &args[t]);
+  }
+  for (int t = 0; t < 8; t++)
+    pthread_join(threads[t], NULL);
+  for (int t = 4; t < 8; t++)
+    lu_assert_int_eq(args[t].errors, 0);
+
+  // Odd keys of each writer remain, with last round values
+  lu_assert_int_eq(concurrenthashtable_size(h), 4 * count / 2);
+  char key[32];
+  StructTest1 value;
+  for (int w = 0; w < 4; w++)
+  {
+    for (int i = 0; i < count; i++)
+    {
+      sprintf(key, "w%i_%i", w, i);
+      bool found = _concurrenthashtable_get(h, key, &value);
+      lu_assert(found == ((i & 1) == 1));
+      if (found)
+        lu_assert_int_eq(value.a, 2 * i);
+    }
+  }
+  concurrenthashtable_destroy(h);
+}
+
+// Reader thread on a table being cleared and refilled
+void* _concurrent_clear_reader(void* p)
+{
+  ConcurrentArg* arg = (ConcurrentArg*)p;
+  int a;
+  for (int round = 0; round < 20; round++)
+  {
+    for (int i = 0; i < arg->count; i++)
+    {
+      if (_concurrenthashtable_get(arg->table, &i, &a) && a != 2 * i)
+        arg->errors++;
+    }
+  }
+  return NULL;
+}
+
+void t_concurrenthashtable_clear_threads()
+{
+  ConcurrentHashTable* h = concurrenthashtable_new_keyed(int, int, 8,
+                                                        NULL, NULL);
+  int count = 2000;
+  pthread_t threads[4];
+  ConcurrentArg args[4];
+  for (int t = 0; t < 4; t++)
+  {
+    args[t] = (ConcurrentArg){h, t, count, 0};
+    pthread_create(&threads[t], NULL, _concurrent_clear_reader, &args[t]);
+  }
+  for (int round = 0; round < 20; round++)
+  {
+    for (int i = 0; i < count; i++)
+    {
+      int v = 2 * i;
+      _concurrenthashtable_set(h, &i, &v);
+    }
+    concurrenthashtable_clear(h);
+  }
+  for (int t = 0; t < 4; t++)
+  {
+    pthread_join(threads[t], NULL);
+    lu_assert_int_eq(args[t].errors, 0);
+  }
+  lu_assert(concurrenthashtable_empty(h));
+  concurrenthashtable_destroy(h);
+}
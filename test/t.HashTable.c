@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <stdio.h>
 #include "cgds/HashTable.h"
 #include "helpers.h"
 #include "lut.h"
@@ -156,3 +157,592 @@ void t_hashtable_copy()
   hashtable_destroy(h);
   hashtable_destroy(hc);
 }
+
+void t_hashtable_allocator()
+{
+  AllocCounter counter;
+  Allocator allocator = counting_allocator(&counter);
+
+  HashTable* h = hashtable_new_with(int, 16, &allocator);
+  char key[16];
+  for (int i = 0; i < 100; i++)
+  {
+    sprintf(key, "key%i", i);
+    hashtable_set(h, key, i);
+  }
+  // struct + 2 slots arrays + cell slabs (16, 32 and 64 cells): short keys
+  // are stored in the cells
+  lu_assert_int_eq(counter.blocks, 3 + 3);
+
+  HashTable* hc = hashtable_copy(h);
+  lu_assert(hc->allocator == &allocator);
+  hashtable_delete(h, "key7");
+  lu_assert_int_eq(counter.blocks, 2 * (3 + 3));
+  hashtable_destroy(hc);
+  hashtable_clear(h);
+  lu_assert_int_eq(counter.blocks, 3);
+  hashtable_destroy(h);
+  lu_assert_int_eq(counter.blocks, 0);
+  lu_assert_int_eq(counter.bytes, 0);
+}
+
+void t_hashtable_resize()
+{
+  int n = 100000;
+  HashTable* h = hashtable_new(int, 1);
+  lu_assert_int_eq(h->hashSize, 8);
+
+  char key[16];
+  for (int i = 0; i < n; i++)
+  {
+    sprintf(key, "key%i", i);
+    hashtable_set(h, key, i);
+  }
+  lu_assert_int_eq(hashtable_size(h), n);
+  // Power of 2, load factor under 3/4
+  lu_assert_int_eq(h->hashSize & (h->hashSize - 1), 0);
+  lu_assert(h->used * 4 <= h->hashSize * 3);
+
+  int* pa;
+  for (int i = 0; i < n; i++)
+  {
+    sprintf(key, "key%i", i);
+    hashtable_get(h, key, pa);
+    lu_assert(pa != NULL);
+    lu_assert_int_eq(*pa, i);
+  }
+  hashtable_get(h, "key", pa);
+  lu_assert(pa == NULL);
+
+  // Pointers to data stay valid across rehashes
+  hashtable_get(h, "key0", pa);
+  for (int i = n; i < 2 * n; i++)
+  {
+    sprintf(key, "key%i", i);
+    hashtable_set(h, key, i);
+  }
+  int* pb;
+  hashtable_get(h, "key0", pb);
+  lu_assert(pa == pb);
+
+  // Deletions leave tombstones, reused or cleaned later
+  size_t hashSize = h->hashSize;
+  for (int round = 0; round < 10; round++)
+  {
+    for (int i = 0; i < 2 * n; i += 2)
+    {
+      sprintf(key, "key%i", i);
+      hashtable_delete(h, key);
+    }
+    lu_assert_int_eq(hashtable_size(h), n);
+    for (int i = 0; i < 2 * n; i += 2)
+    {
+      sprintf(key, "key%i", i);
+      hashtable_set(h, key, -i);
+    }
+  }
+  lu_assert_int_eq(h->hashSize, hashSize);
+  lu_assert_int_eq(hashtable_size(h), 2 * n);
+  for (int i = 0; i < 2 * n; i++)
+  {
+    sprintf(key, "key%i", i);
+    hashtable_get(h, key, pa);
+    int expected = (i & 1) ? i : -i;
+    lu_assert_int_eq(*pa, expected);
+  }
+
+  hashtable_destroy(h);
+}
+
+void t_hashtable_long_keys()
+{
+  HashTable* h = hashtable_new(int, 16);
+
+  // Keys of all lengths up to 200, differing only by their last character
+  // (covers every branch of the hash function)
+  char key[202];
+  for (int len = 1; len <= 200; len++)
+  {
+    memset(key, 'a', len);
+    key[len] = '\0';
+    hashtable_set(h, key, len);
+    key[len - 1] = 'b';
+    hashtable_set(h, key, -len);
+  }
+  lu_assert_int_eq(hashtable_size(h), 400);
+
+  // Cells cache key lengths and hashes (all distinct here)
+  for (UInt i = 0; i < h->hashSize; i++)
+  {
+    HashCell* cell = h->slots[i];
+    if (cell == NULL)
+      continue;
+    lu_assert_int_eq(cell->keyLength, strlen(cell->key));
+    for (UInt j = i + 1; j < h->hashSize; j++)
+      lu_assert(h->slots[j] == NULL || h->slots[j]->hash != cell->hash);
+  }
+
+  int* pa;
+  for (int len = 1; len <= 200; len++)
+  {
+    memset(key, 'a', len);
+    key[len] = '\0';
+    hashtable_get(h, key, pa);
+    lu_assert_int_eq(*pa, len);
+    key[len - 1] = 'b';
+    hashtable_get(h, key, pa);
+    lu_assert_int_eq(*pa, -len);
+  }
+  hashtable_set(h, "", 0);
+  hashtable_get(h, "", pa);
+  lu_assert_int_eq(*pa, 0);
+  hashtable_get(h, "c", pa);
+  lu_assert(pa == NULL);
+
+  hashtable_destroy(h);
+}
+
+typedef struct Point {
+  int x;
+  int y;
+} Point;
+
+UInt hash_point(void* key, size_t keySize)
+{
+  Point* p = (Point*)key;
+  return ((UInt)p->x * 0x9E3779B97F4A7C15ULL) ^ (UInt)p->y;
+}
+
+bool equal_points(void* key1, void* key2)
+{
+  Point* p1 = (Point*)key1;
+  Point* p2 = (Point*)key2;
+  return p1->x == p2->x && p1->y == p2->y;
+}
+
+void t_hashtable_binary_keys()
+{
+  AllocCounter counter;
+  Allocator allocator = counting_allocator(&counter);
+
+  // Integer keys, hashed and compared as bytes
+  HashTable* h = hashtable_new_keyed_with(int, double, 16, NULL, NULL,
+                                          &allocator);
+  for (int i = 0; i < 1000; i++)
+    hashtable_set_key(h, i * 7, (double)i);
+  lu_assert_int_eq(hashtable_size(h), 1000);
+  // No allocation per key: struct, 2 slots arrays, cell slabs
+  lu_assert(counter.blocks < 20);
+
+  double* pd;
+  for (int i = 0; i < 1000; i++)
+  {
+    hashtable_get_key(h, i * 7, pd);
+    lu_assert(pd != NULL);
+    lu_assert_int_eq((int)*pd, i);
+  }
+  hashtable_get_key(h, 1, pd);
+  lu_assert(pd == NULL);
+  for (int i = 0; i < 1000; i += 2)
+    hashtable_delete_key(h, i * 7);
+  lu_assert_int_eq(hashtable_size(h), 500);
+  hashtable_get_key(h, 14, pd);
+  lu_assert(pd == NULL);
+  hashtable_get_key(h, 21, pd);
+  lu_assert_int_eq((int)*pd, 3);
+
+  HashTable* hc = hashtable_copy(h);
+  hashtable_get_key(hc, 21, pd);
+  lu_assert_int_eq((int)*pd, 3);
+  hashtable_destroy(hc);
+  hashtable_destroy(h);
+  lu_assert_int_eq(counter.blocks, 0);
+
+  // Struct keys, with custom hash and equality
+  h = hashtable_new_keyed(Point, int, 16, hash_point, equal_points);
+  for (int x = 0; x < 30; x++)
+  {
+    for (int y = 0; y < 30; y++)
+      hashtable_set_key(h, ((Point){x, y}), x * y);
+  }
+  lu_assert_int_eq(hashtable_size(h), 900);
+  int* pa;
+  hashtable_get_key(h, ((Point){7, 9}), pa);
+  lu_assert_int_eq(*pa, 63);
+  Point p = {29, 29};
+  hashtable_get(h, &p, pa);
+  lu_assert_int_eq(*pa, 841);
+  hashtable_get_key(h, ((Point){30, 0}), pa);
+  lu_assert(pa == NULL);
+  hashtable_destroy(h);
+}
+
+void t_hashtable_key_storage()
+{
+  AllocCounter counter;
+  Allocator allocator = counting_allocator(&counter);
+  HashTable* h = hashtable_new_with(int, 16, &allocator);
+
+  // Short keys live in the cells
+  char key[64];
+  memset(key, 'a', HASHTABLE_INLINE_KEY - 1);
+  key[HASHTABLE_INLINE_KEY - 1] = '\0';
+  hashtable_set(h, key, 1);
+  lu_assert_int_eq(arena_used(&h->keyArena), 0);
+
+  // Long keys are appended to the keys arena
+  int n = 1000;
+  for (int i = 0; i < n; i++)
+  {
+    sprintf(key, "a_rather_long_key_number_%i", i);
+    hashtable_set(h, key, i);
+  }
+  size_t used = arena_used(&h->keyArena);
+  lu_assert(used >= 1000 * 28);
+  size_t blocks = counter.blocks;
+  lu_assert(blocks < 40);
+
+  int* pa;
+  for (int i = 0; i < n; i++)
+  {
+    sprintf(key, "a_rather_long_key_number_%i", i);
+    hashtable_get(h, key, pa);
+    lu_assert_int_eq(*pa, i);
+  }
+
+  // Deleted long keys are reclaimed on rehash
+  for (int i = 0; i < n; i++)
+  {
+    sprintf(key, "a_rather_long_key_number_%i", i);
+    hashtable_delete(h, key);
+  }
+  lu_assert_int_eq(hashtable_size(h), 1);
+  for (int i = 0; i < n; i++)
+  {
+    sprintf(key, "another_quite_long_key_%i", i);
+    hashtable_set(h, key, -i);
+  }
+  lu_assert(arena_used(&h->keyArena) < 2 * used);
+  for (int i = 0; i < n; i++)
+  {
+    sprintf(key, "another_quite_long_key_%i", i);
+    hashtable_get(h, key, pa);
+    lu_assert_int_eq(*pa, -i);
+  }
+  sprintf(key, "a_rather_long_key_number_%i", 5);
+  hashtable_get(h, key, pa);
+  lu_assert(pa == NULL);
+
+  hashtable_clear(h);
+  lu_assert_int_eq(arena_used(&h->keyArena), 0);
+  hashtable_destroy(h);
+  lu_assert_int_eq(counter.blocks, 0);
+  lu_assert_int_eq(counter.bytes, 0);
+}
+
+void t_hashtable_iterator()
+{
+  HashTable* h = hashtable_new(int, 16);
+  HashTableIterator* hi = hashtable_get_iterator(h);
+  lu_assert(!hashtableI_has_data(hi));
+  hashtableI_destroy(hi);
+
+  int n = 1000;
+  char key[16];
+  for (int i = 0; i < n; i++)
+  {
+    sprintf(key, "key%i", i);
+    hashtable_set(h, key, i);
+  }
+  for (int i = 0; i < n; i += 3)
+  {
+    sprintf(key, "key%i", i);
+    hashtable_delete(h, key);
+  }
+
+  // Each remaining entry seen once, keys and data in place
+  char seen[1000] = {0};
+  int count = 0, a;
+  hi = hashtable_get_iterator(h);
+  for (; hashtableI_has_data(hi); hashtableI_move_next(hi))
+  {
+    int i = atoi((char*)hashtableI_get_key(hi) + 3);
+    hashtableI_get(hi, a);
+    lu_assert_int_eq(a, i);
+    lu_assert_int_eq(seen[i], 0);
+    seen[i] = 1;
+    count++;
+    hashtableI_set(hi, -i);
+  }
+  lu_assert_int_eq(count, hashtable_size(h));
+  int* pa;
+  hashtable_get(h, "key1", pa);
+  lu_assert_int_eq(*pa, -1);
+  hashtableI_destroy(hi);
+  hashtable_destroy(h);
+}
+
+void t_hashtable_chunks()
+{
+  HashTable* h = hashtable_new_keyed(int, int, 16, NULL, NULL);
+  int n = 10000;
+  for (int i = 0; i < n; i++)
+    hashtable_set_key(h, i, 2 * i);
+
+  // Four disjoint ranges, scanned by chunks (as by threads: rehash first,
+  // so that creating iterators does not write to the table)
+  hashtable_rehash_step(h, h->oldHashSize);
+  lu_assert(h->oldSlots == NULL);
+  HashCell* cells[64];
+  long sum = 0;
+  int count = 0;
+  UInt quarter = h->hashSize / 4;
+  for (UInt r = 0; r < 4; r++)
+  {
+    HashTableIterator* hi = hashtable_get_range_iterator(
+      h, r * quarter, r < 3 ? (r + 1) * quarter : h->hashSize);
+    UInt chunkSize;
+    while ((chunkSize = hashtableI_next_chunk(hi, cells, 64)) > 0)
+    {
+      lu_assert(chunkSize <= 64);
+      for (UInt j = 0; j < chunkSize; j++)
+      {
+        int key = *((int*)cells[j]->key);
+        int value = *((int*)cells[j]->data);
+        lu_assert_int_eq(value, 2 * key);
+        sum += key;
+        count++;
+      }
+    }
+    lu_assert(!hashtableI_has_data(hi));
+    hashtableI_destroy(hi);
+  }
+  lu_assert_int_eq(count, n);
+  lu_assert(sum == (long)n * (n - 1) / 2);
+
+  // Range beyond slots is capped
+  HashTableIterator* hi = hashtable_get_range_iterator(
+    h, h->hashSize + 10, h->hashSize + 20);
+  lu_assert(!hashtableI_has_data(hi));
+  lu_assert_int_eq(hashtableI_next_chunk(hi, cells, 64), 0);
+  hashtableI_destroy(hi);
+  hashtable_destroy(h);
+}
+
+void t_hashtable_incremental_rehash()
+{
+  HashTable* h = hashtable_new(int, 1);
+  int n = 50000;
+  char key[16];
+  int* pa;
+  bool rehashed = false;
+  for (int i = 0; i < n; i++)
+  {
+    sprintf(key, "key%i", i);
+    size_t hashSize = h->hashSize;
+    hashtable_set(h, key, i);
+    if (h->hashSize != hashSize && hashSize >= 1024)
+    {
+      // Growth started: only a few old slots were migrated
+      lu_assert(h->oldSlots != NULL);
+      lu_assert(h->rehashIndex <= HASHTABLE_REHASH_STEP);
+      rehashed = true;
+    }
+    // All keys remain reachable during rehashes
+    if (h->oldSlots != NULL)
+    {
+      int j = i / 2;
+      sprintf(key, "key%i", j);
+      hashtable_get(h, key, pa);
+      lu_assert(pa != NULL);
+      lu_assert_int_eq(*pa, j);
+    }
+  }
+  lu_assert(rehashed);
+  lu_assert_int_eq(hashtable_size(h), n);
+
+  // Operations on keys not migrated yet
+  size_t hashSize = h->hashSize;
+  while (h->hashSize == hashSize)
+  {
+    sprintf(key, "key%i", n);
+    hashtable_set(h, key, n++);
+  }
+  lu_assert(h->oldSlots != NULL);
+  for (int i = 0; i < n; i += 2)
+  {
+    sprintf(key, "key%i", i);
+    hashtable_delete(h, key);
+  }
+  for (int i = 1; i < n; i += 2)
+  {
+    sprintf(key, "key%i", i);
+    hashtable_set(h, key, -i);
+  }
+  lu_assert_int_eq(hashtable_size(h), n / 2);
+
+  // Complete the rehash
+  while (hashtable_rehash_step(h, 1000));
+  lu_assert(h->oldSlots == NULL);
+  lu_assert(!hashtable_rehash_step(h, 1000));
+  for (int i = 0; i < n; i++)
+  {
+    sprintf(key, "key%i", i);
+    hashtable_get(h, key, pa);
+    if (i & 1)
+      lu_assert_int_eq(*pa, -i);
+    else
+      lu_assert(pa == NULL);
+  }
+
+  // Copy and clear while rehashing
+  while (h->oldSlots == NULL)
+  {
+    sprintf(key, "key%i", n);
+    hashtable_set(h, key, n++);
+  }
+  HashTable* hc = hashtable_copy(h);
+  lu_assert(h->oldSlots == NULL);
+  lu_assert_int_eq(hashtable_size(hc), hashtable_size(h));
+  hashtable_destroy(hc);
+  while (h->oldSlots == NULL)
+  {
+    sprintf(key, "key%i", n);
+    hashtable_set(h, key, n++);
+  }
+  hashtable_clear(h);
+  lu_assert(h->oldSlots == NULL);
+  hashtable_get(h, "key1", pa);
+  lu_assert(pa == NULL);
+  hashtable_destroy(h);
+}
+
+void t_hashtable_get_batch()
+{
+  // String keys
+  HashTable* h = hashtable_new(int, 16);
+  int n = 1000;
+  char keys[1000][16];
+  char* pkeys[1000];
+  for (int i = 0; i < n; i++)
+  {
+    sprintf(keys[i], "key%i", i);
+    pkeys[i] = keys[i];
+    if (i & 1)
+      hashtable_set(h, keys[i], i);
+  }
+  void* out[1000];
+  hashtable_get_batch(h, pkeys, n, out);
+  for (int i = 0; i < n; i++)
+  {
+    if (i & 1)
+      lu_assert_int_eq(*((int*)out[i]), i);
+    else
+      lu_assert(out[i] == NULL);
+  }
+  hashtable_get_batch(h, pkeys, 0, out);
+  hashtable_destroy(h);
+
+  // Fixed-size keys, contiguous; some lookups while rehashing
+  h = hashtable_new_keyed(int, int, 16, NULL, NULL);
+  int ikeys[1000];
+  for (int i = 0; i < n; i++)
+  {
+    ikeys[i] = 3 * i;
+    hashtable_set_key(h, ikeys[i], i);
+    if (h->oldSlots != NULL)
+    {
+      hashtable_get_batch(h, ikeys, i + 1, out);
+      for (int j = 0; j <= i; j++)
+        lu_assert_int_eq(*((int*)out[j]), j);
+    }
+  }
+  ikeys[7] = 1;
+  hashtable_get_batch(h, ikeys, n, out);
+  lu_assert(out[7] == NULL);
+  lu_assert_int_eq(*((int*)out[999]), 999);
+  hashtable_destroy(h);
+}
+
+void t_hashtable_filter()
+{
+  HashTable* h = hashtable_new(int, 16);
+  char key[32];
+  for (int i = 0; i < 100; i++)
+  {
+    sprintf(key, "key%i", i);
+    hashtable_set(h, key, i);
+  }
+  hashtable_attach_filter(h, 0.01);
+  lu_assert_int_eq(bloomfilter_size(h->filter), 100);
+
+  // Sets (new and existing keys), deletes and gets, some while rehashing
+  int* a;
+  for (int i = 0; i < 3000; i++)
+  {
+    sprintf(key, "key%i", i);
+    hashtable_set(h, key, 2 * i);
+    if (i % 3 == 0)
+      hashtable_delete(h, key);
+  }
+  lu_assert_int_eq(hashtable_size(h), 2000);
+  for (int i = 0; i < 3000; i++)
+  {
+    sprintf(key, "key%i", i);
+    hashtable_get(h, key, a);
+    int remainder = i % 3;
+    if (remainder == 0)
+    {
+      lu_assert(a == NULL);
+    }
+    else
+    {
+      lu_assert_int_eq(*a, 2 * i);
+    }
+  }
+  // Rebuilt when full: deleted keys left the filter
+  lu_assert(h->filter->size <= h->filter->capacity);
+  lu_assert(bloomfilter_size(h->filter) < 3000);
+  int rejected = 0;
+  for (int i = 0; i < 1000; i++)
+  {
+    sprintf(key, "absent%i", i);
+    hashtable_get(h, key, a);
+    lu_assert(a == NULL);
+    // String keys use the default hash: the filter can be queried directly
+    rejected += !bloomfilter_has(h->filter, key, strlen(key));
+  }
+  lu_assert_int_gt(rejected, 900);
+
+  // Batched lookups, copy and clear keep the filter in sync
+  char keys[64][16];
+  char* pkeys[64];
+  void* out[64];
+  for (int i = 0; i < 64; i++)
+  {
+    sprintf(keys[i], (i & 1) ? "key%i" : "miss%i", i);
+    pkeys[i] = keys[i];
+  }
+  hashtable_get_batch(h, pkeys, 64, out);
+  for (int i = 0; i < 64; i++)
+  {
+    int remainder = i % 3;
+    lu_assert((out[i] != NULL) == ((i & 1) && remainder != 0));
+  }
+  HashTable* copy = hashtable_copy(h);
+  lu_assert(copy->filter != NULL);
+  hashtable_get(copy, "key1", a);
+  lu_assert_int_eq(*a, 2);
+  hashtable_clear(h);
+  hashtable_get(h, "key1", a);
+  lu_assert(a == NULL);
+  hashtable_set(h, "key1", 5);
+  hashtable_get(h, "key1", a);
+  lu_assert_int_eq(*a, 5);
+  hashtable_detach_filter(h);
+  lu_assert(h->filter == NULL);
+  hashtable_get(h, "key1", a);
+  lu_assert_int_eq(*a, 5);
+  hashtable_destroy(copy);
+  hashtable_destroy(h);
+}
@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <string.h>
 #include "cgds/Heap.h"
 #include "helpers.h"
 #include "lut.h"
@@ -170,3 +171,57 @@ void t_heap_copy()
   heap_destroy(h);
   heap_destroy(hc);
 }
+
+void t_heap_records()
+{
+  // Items of odd sizes, small and large (saved out of the stack when sifting)
+  typedef struct { char c[3]; } Small;
+  typedef struct { int id; char pad[100]; } Large;
+  Heap* hs = heap_new(Small, MIN_T, 4);
+  lu_assert_int_eq(hs->recordSize, 2 * sizeof(Real));
+  Heap* hl = heap_new(Large, MAX_T, 2);
+  int n = 2000;
+  for (int i = 0; i < n; i++)
+  {
+    // Values: a permutation of [0, n[
+    int v = (i * 7919) % n;
+    Small s = {{(char)(v & 127), (char)(v >> 7), 0}};
+    heap_insert(hs, s, v);
+    Large l = {v};
+    memset(l.pad, v & 255, sizeof(l.pad));
+    heap_insert(hl, l, v);
+  }
+  lu_assert_int_eq(heap_size(hl), n);
+
+  // Items and values move together
+  Large l = {5};
+  memset(l.pad, 5, sizeof(l.pad));
+  heap_modify(hl, l, 5000.0);
+  ItemValue top = _heap_top(hl);
+  lu_assert_int_eq(((Large*)top.item)->id, 5);
+  lu_assert(top.value == 5000.0);
+  heap_remove(hl, l);
+  for (int i = 0; i < n; i++)
+  {
+    top = _heap_top(hs);
+    Small* s = (Small*)top.item;
+    lu_assert_int_eq(s->c[0] + 128 * s->c[1], i);
+    lu_assert(top.value == i);
+    heap_pop(hs);
+  }
+  for (int v = n - 1; v >= 0; v--)
+  {
+    if (v == 5)
+      continue;
+    top = _heap_top(hl);
+    Large* large = (Large*)top.item;
+    lu_assert_int_eq(large->id, v);
+    lu_assert_int_eq((unsigned char)large->pad[99], v & 255);
+    lu_assert(top.value == v);
+    heap_pop(hl);
+  }
+  lu_assert(heap_empty(hs));
+  lu_assert(heap_empty(hl));
+  heap_destroy(hs);
+  heap_destroy(hl);
+}
@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <stdint.h>
 #include "cgds/List.h"
 #include "helpers.h"
 #include "lut.h"
@@ -158,3 +159,32 @@ void t_list_copy()
   list_destroy(L);
   list_destroy(Lc);
 }
+
+void t_list_inline_data()
+{
+  List* l = list_new(StructTest1);
+  StructTest1 st1;
+  for (int i = 0; i < 10; i++)
+  {
+    st1.a = i;
+    st1.b = (double)i;
+    list_insert_back(l, st1);
+  }
+
+  // Data lives at the end of its cell, suitably aligned
+  ListIterator* li = list_get_iterator(l);
+  for (int i = 0; listI_has_data(li); i++)
+  {
+    ListCell* cell = li->current;
+    lu_assert((char*)cell->data == (char*)cell + sizeof(ListCell));
+    lu_assert_int_eq((uintptr_t)cell->data % POOL_ALIGNMENT, 0);
+    StructTest1* pst1 = (StructTest1*)cell->data;
+    lu_assert_int_eq(pst1->a, i);
+    listI_move_next(li);
+  }
+  listI_destroy(li);
+
+  // One pool block per element
+  lu_assert_int_eq(pool_count(&l->cellPool), 10);
+  list_destroy(l);
+}
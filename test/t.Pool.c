@@ -0,0 +1,111 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include "cgds/Pool.h"
+#include "cgds/List.h"
+#include "cgds/Tree.h"
+#include "helpers.h"
+#include "lut.h"
+
+void t_pool_alloc_free()
+{
+  Pool* pool = pool_new(sizeof(StructTest1), NULL);
+  lu_assert_int_eq(pool_count(pool), 0);
+
+  StructTest1* blocks[100];
+  for (int i = 0; i < 100; i++)
+  {
+    blocks[i] = (StructTest1*) pool_alloc(pool);
+    lu_assert_int_eq((uintptr_t)blocks[i] % POOL_ALIGNMENT, 0);
+    blocks[i]->a = i;
+    blocks[i]->b = (double)i;
+  }
+  lu_assert_int_eq(pool_count(pool), 100);
+  for (int i = 0; i < 100; i++)
+    lu_assert_int_eq(blocks[i]->a, i);
+
+  // Released blocks are recycled first (last released, first reused)
+  pool_free(pool, blocks[10]);
+  pool_free(pool, blocks[20]);
+  lu_assert_int_eq(pool_count(pool), 98);
+  lu_assert(pool_alloc(pool) == blocks[20]);
+  lu_assert(pool_alloc(pool) == blocks[10]);
+  lu_assert_int_eq(pool_count(pool), 100);
+
+  pool_destroy(pool);
+}
+
+void t_pool_contiguous()
+{
+  Pool* pool = pool_new(24, NULL);
+  lu_assert_int_eq(pool->blockSize, 32);
+
+  // Consecutive blocks of a slab are adjacent
+  char* previous = (char*) pool_alloc(pool);
+  for (int i = 1; i < 16; i++)
+  {
+    char* block = (char*) pool_alloc(pool);
+    lu_assert(block == previous + 32);
+    previous = block;
+  }
+  // Next slab is twice larger
+  pool_alloc(pool);
+  lu_assert_int_eq(pool->slabs->capacity, 32);
+
+  pool_destroy(pool);
+}
+
+void t_pool_release()
+{
+  AllocCounter counter;
+  Allocator allocator = counting_allocator(&counter);
+
+  Pool pool;
+  pool_init(&pool, 8, &allocator);
+  for (int i = 0; i < 1000; i++)
+    pool_alloc(&pool);
+  // 16 + 32 + ... + 512 = 1008 blocks
+  lu_assert_int_eq(counter.blocks, 6);
+  pool_release(&pool);
+  lu_assert_int_eq(counter.blocks, 0);
+  lu_assert_int_eq(counter.bytes, 0);
+  lu_assert_int_eq(pool_count(&pool), 0);
+
+  // Pool is reusable
+  int* a = (int*) pool_alloc(&pool);
+  *a = 42;
+  lu_assert_int_eq(counter.blocks, 1);
+  pool_release(&pool);
+}
+
+void t_pool_containers()
+{
+  AllocCounter counter;
+  Allocator allocator = counting_allocator(&counter);
+
+  // List cells are recycled by removals/insertions
+  List* l = list_new_with(int, &allocator);
+  for (int i = 0; i < 10; i++)
+    list_insert_back(l, i);
+  size_t blocks = counter.blocks;
+  ListCell* tail = l->tail;
+  list_remove_back(l);
+  list_insert_back(l, 42);
+  lu_assert(l->tail == tail);
+  int a;
+  list_get(l->tail, a);
+  lu_assert_int_eq(a, 42);
+  lu_assert_int_eq(counter.blocks, blocks);
+  list_destroy(l);
+  lu_assert_int_eq(counter.blocks, 0);
+
+  // Tree nodes too
+  Tree* t = tree_new_with(int, &allocator);
+  tree_set_root(t, 0);
+  for (int i = 0; i < 100; i++)
+    tree_add_child(t, t->root, i);
+  tree_rm_childs(t, t->root);
+  lu_assert_int_eq(pool_count(&t->nodePool), 1);
+  tree_destroy(t);
+  lu_assert_int_eq(counter.blocks, 0);
+  lu_assert_int_eq(counter.bytes, 0);
+}
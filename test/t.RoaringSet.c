@@ -0,0 +1,190 @@
+#include <stdlib.h>
+#include "cgds/RoaringSet.h"
+#include "cgds/Set.h"
+#include "helpers.h"
+#include "lut.h"
+
+void t_roaringset_basic()
+{
+  RoaringSet* s = roaringset_new();
+  lu_assert(roaringset_empty(s));
+
+  roaringset_add(s, 0);
+  roaringset_add(s, 70000);
+  roaringset_add(s, 3);
+  roaringset_add(s, 3);
+  roaringset_add(s, (UInt)1 << 40);
+  lu_assert_int_eq(roaringset_size(s), 4);
+  lu_assert_int_eq(s->count, 3);
+  lu_assert(roaringset_has(s, 70000));
+  lu_assert(roaringset_has(s, (UInt)1 << 40));
+  lu_assert(!roaringset_has(s, 4));
+  lu_assert(!roaringset_has(s, 70001));
+
+  roaringset_delete(s, 70000);
+  roaringset_delete(s, 70000);
+  roaringset_delete(s, 12);
+  lu_assert_int_eq(roaringset_size(s), 3);
+  lu_assert_int_eq(s->count, 2);
+  lu_assert(!roaringset_has(s, 70000));
+
+  roaringset_clear(s);
+  lu_assert(roaringset_empty(s));
+  lu_assert(!roaringset_has(s, 3));
+  roaringset_add(s, 5);
+  lu_assert_int_eq(roaringset_size(s), 1);
+  roaringset_destroy(s);
+}
+
+void t_roaringset_containers()
+{
+  // Dense keys become a bitmap, and an array again when sparse enough
+  RoaringSet* s = roaringset_new();
+  for (UInt i = 0; i < 2 * ROARINGSET_ARRAY_MAX; i++)
+    roaringset_add(s, 65536 + 3 * i);
+  lu_assert_int_eq(s->count, 1);
+  lu_assert(s->containers[0].cardinality > ROARINGSET_ARRAY_MAX);
+  for (UInt i = 0; i < 2 * ROARINGSET_ARRAY_MAX; i++)
+    lu_assert(roaringset_has(s, 65536 + 3 * i) && !roaringset_has(s, 65537 + 3 * i));
+  for (UInt i = 0; i < 2 * ROARINGSET_ARRAY_MAX; i += 2)
+    roaringset_delete(s, 65536 + 3 * i);
+  lu_assert_int_eq(roaringset_size(s), ROARINGSET_ARRAY_MAX);
+  lu_assert_int_eq(s->containers[0].capacity, ROARINGSET_ARRAY_MAX);
+
+  // Elements come out sorted
+  roaringset_add(s, 7);
+  Vector* v = roaringset_to_vector(s);
+  lu_assert_int_eq(vector_size(v), ROARINGSET_ARRAY_MAX + 1);
+  UInt a;
+  vector_get(v, 0, a);
+  lu_assert_int_eq(a, 7);
+  for (UInt i = 1; i <= ROARINGSET_ARRAY_MAX; i++)
+  {
+    vector_get(v, i, a);
+    lu_assert_int_eq(a, 65536 + 3 * (2 * i - 1));
+  }
+  vector_destroy(v);
+
+  RoaringSet* copy = roaringset_copy(s);
+  roaringset_delete(s, 7);
+  lu_assert(roaringset_has(copy, 7));
+  lu_assert_int_eq(roaringset_size(copy), ROARINGSET_ARRAY_MAX + 1);
+  roaringset_destroy(copy);
+  roaringset_destroy(s);
+}
+
+// Check that s holds exactly the elements i < limit such that has(i)
+void check_roaringset_content(RoaringSet* s, UInt limit, bool (*has)(UInt))
+{
+  UInt count = 0;
+  for (UInt i = 0; i < limit; i++)
+  {
+    lu_assert(roaringset_has(s, i) == has(i));
+    count += has(i);
+  }
+  lu_assert_int_eq(roaringset_size(s), count);
+}
+
+// Operands: multiples of 2 (bitmaps) and of 7 (arrays), plus a range
+// where both are dense or both sparse
+bool in_roaring1(UInt i) {
+  return (i % 2 == 0 && i < 200000) || (i >= 300000 && i % 50 == 0);
+}
+bool in_roaring2(UInt i) {
+  return (i % 7 == 0 && i < 150000) || (i >= 250000 && i % 3 == 0);
+}
+bool in_roaring_union(UInt i) { return in_roaring1(i) || in_roaring2(i); }
+bool in_roaring_intersect(UInt i) { return in_roaring1(i) && in_roaring2(i); }
+bool in_roaring_difference(UInt i) { return in_roaring1(i) && !in_roaring2(i); }
+
+void t_roaringset_algebra()
+{
+  UInt limit = 400000;
+  RoaringSet* s1 = roaringset_new();
+  RoaringSet* s2 = roaringset_new();
+  for (UInt i = 0; i < limit; i++)
+  {
+    if (in_roaring1(i))
+      roaringset_add(s1, i);
+    if (in_roaring2(i))
+      roaringset_add(s2, i);
+  }
+
+  RoaringSet* u = roaringset_union(s1, s2);
+  check_roaringset_content(u, limit, in_roaring_union);
+  RoaringSet* n = roaringset_intersect(s1, s2);
+  check_roaringset_content(n, limit, in_roaring_intersect);
+  lu_assert_int_eq(roaringset_intersect_size(s1, s2), roaringset_size(n));
+  lu_assert_int_eq(roaringset_intersect_size(s2, s1), roaringset_size(n));
+  RoaringSet* d = roaringset_difference(s1, s2);
+  check_roaringset_content(d, limit, in_roaring_difference);
+  roaringset_destroy(u);
+  roaringset_destroy(n);
+  roaringset_destroy(d);
+
+  // In-place variants
+  RoaringSet* s = roaringset_copy(s1);
+  roaringset_union_inplace(s, s2);
+  check_roaringset_content(s, limit, in_roaring_union);
+  roaringset_destroy(s);
+  s = roaringset_copy(s1);
+  roaringset_intersect_inplace(s, s2);
+  check_roaringset_content(s, limit, in_roaring_intersect);
+  roaringset_destroy(s);
+  s = roaringset_copy(s1);
+  roaringset_difference_inplace(s, s2);
+  check_roaringset_content(s, limit, in_roaring_difference);
+  roaringset_difference_inplace(s, s1);
+  lu_assert(roaringset_empty(s));
+  lu_assert_int_eq(s->count, 0);
+  roaringset_destroy(s);
+
+  roaringset_destroy(s1);
+  roaringset_destroy(s2);
+}
+
+void t_roaringset_memory()
+{
+  // One million IDs, 1 out of 4 in a 4M range: compare with Set
+  RoaringSet* r = roaringset_new();
+  Set* s = set_new(UInt, 16, NULL);
+  for (UInt i = 0; i < 1000000; i++)
+  {
+    UInt id = 4 * i + (i & 3);
+    roaringset_add(r, id);
+    set_add(s, id);
+  }
+  lu_assert_int_eq(roaringset_size(r), 1000000);
+  size_t setBytes = s->hashSize * (s->dataSize + 1);
+  size_t roaringBytes = roaringset_memory(r);
+  lu_assert(roaringBytes < 600000);
+  lu_assert(10 * roaringBytes < setBytes);
+  set_destroy(s);
+  roaringset_destroy(r);
+}
+
+void t_roaringset_allocator()
+{
+  AllocCounter counter;
+  Allocator allocator = counting_allocator(&counter);
+  RoaringSet* s1 = roaringset_new_with(&allocator);
+  RoaringSet* s2 = roaringset_new_with(&allocator);
+  for (UInt i = 0; i < 100000; i++)
+  {
+    roaringset_add(s1, 5 * i);
+    roaringset_add(s2, 3 * i);
+  }
+  RoaringSet* u = roaringset_union(s1, s2);
+  roaringset_intersect_inplace(u, s1);
+  lu_assert_int_eq(roaringset_size(u), 100000);
+  Vector* v = roaringset_to_vector(u);
+  lu_assert_int_eq(vector_size(v), 100000);
+  vector_destroy(v);
+  for (UInt i = 0; i < 500000; i++)
+    roaringset_delete(s1, i);
+  roaringset_destroy(u);
+  roaringset_destroy(s1);
+  roaringset_destroy(s2);
+  lu_assert_int_eq(counter.blocks, 0);
+  lu_assert_int_eq(counter.bytes, 0);
+}
@@ -141,3 +141,204 @@ void t_set_tovect()
   vector_destroy(v);
   set_destroy(s);
 }
+
+void t_set_resize()
+{
+  AllocCounter counter;
+  Allocator allocator = counting_allocator(&counter);
+
+  // Default hash, items stored inline: two arrays whatever the size
+  Set* s = set_new_with(UInt, 1, NULL, &allocator);
+  lu_assert_int_eq(s->hashSize, 8);
+  UInt n = 100000;
+  for (UInt i = 0; i < n; i++)
+  {
+    UInt id = i * 2654435761ULL;
+    set_add(s, id);
+    set_add(s, id);
+  }
+  lu_assert_int_eq(set_size(s), n);
+  lu_assert_int_eq(counter.blocks, 3);
+  lu_assert_int_eq(s->hashSize & (s->hashSize - 1), 0);
+  lu_assert(s->used * 4 <= s->hashSize * 3);
+  for (UInt i = 0; i < n; i++)
+  {
+    UInt id = i * 2654435761ULL,
+         other = id + 1;
+    lu_assert(set_has(s, &id));
+    lu_assert(!set_has(s, &other));
+  }
+
+  // Tombstones are reused or cleaned, without growing
+  size_t hashSize = s->hashSize;
+  for (int round = 0; round < 5; round++)
+  {
+    for (UInt i = 0; i < n; i += 2)
+      set_delete(s, i * 2654435761ULL);
+    lu_assert_int_eq(set_size(s), n / 2);
+    for (UInt i = 0; i < n; i += 2)
+      set_add(s, i * 2654435761ULL);
+  }
+  lu_assert_int_eq(s->hashSize, hashSize);
+  lu_assert_int_eq(set_size(s), n);
+
+  set_clear(s);
+  lu_assert(set_empty(s));
+  UInt zero = 0;
+  lu_assert(!set_has(s, &zero));
+  set_destroy(s);
+  lu_assert_int_eq(counter.blocks, 0);
+  lu_assert_int_eq(counter.bytes, 0);
+
+  // Custom hash, called with the current number of slots
+  s = set_new(int, 4, getHash_int);
+  for (int i = 0; i < 1000; i++)
+    set_add(s, i);
+  lu_assert_int_eq(set_size(s), 1000);
+  for (int i = 0; i < 1000; i++)
+    lu_assert(set_has(s, &i));
+  set_destroy(s);
+}
+
+// Check that s holds exactly the integers i in [0, n[ with expected(i)
+void check_set_content(Set* s, int n, bool (*expected)(int))
+{
+  UInt count = 0;
+  for (int i = 0; i < n; i++)
+  {
+    bool has = set_has(s, &i);
+    lu_assert(has == expected(i));
+    count += has;
+  }
+  lu_assert_int_eq(set_size(s), count);
+}
+
+// Operands: multiples of 2 and multiples of 3 (below some n)
+bool in_union(int i) { return (i % 2 == 0) || (i % 3 == 0); }
+bool in_intersection(int i) { return (i % 6 == 0); }
+bool in_difference(int i) { return (i % 2 == 0) && (i % 3 != 0); }
+bool in_difference_reversed(int i) { return (i % 3 == 0) && (i % 2 != 0); }
+
+void t_set_algebra()
+{
+  // Small sets (one thread), then large ones (several threads)
+  int sizes[2] = {100, 300000};
+  for (int k = 0; k < 2; k++)
+  {
+    int n = sizes[k];
+    Set* s2 = set_new(int, 16, NULL);
+    Set* s3 = set_new(int, 16, NULL);
+    for (int i = 0; i < n; i += 2)
+      set_add(s2, i);
+    for (int i = 0; i < n; i += 3)
+      set_add(s3, i);
+
+    Set* u = set_union(s2, s3);
+    check_set_content(u, n, in_union);
+    Set* inter = set_intersect(s2, s3);
+    check_set_content(inter, n, in_intersection);
+    Set* d = set_difference(s2, s3);
+    check_set_content(d, n, in_difference);
+    Set* dr = set_difference(s3, s2);
+    check_set_content(dr, n, in_difference_reversed);
+    // Operands unchanged
+    lu_assert_int_eq(set_size(s2), (n + 1) / 2);
+    lu_assert_int_eq(set_size(s3), (n + 2) / 3);
+    set_destroy(u);
+    set_destroy(inter);
+    set_destroy(d);
+    set_destroy(dr);
+
+    // In place variants
+    Set* c = set_copy(s2);
+    set_union_inplace(c, s3);
+    check_set_content(c, n, in_union);
+    set_destroy(c);
+    c = set_copy(s2);
+    set_intersect_inplace(c, s3);
+    check_set_content(c, n, in_intersection);
+    set_destroy(c);
+    c = set_copy(s2);
+    set_difference_inplace(c, s3);
+    check_set_content(c, n, in_difference);
+    set_destroy(c);
+    c = set_copy(s3);
+    set_difference_inplace(c, s2);
+    check_set_content(c, n, in_difference_reversed);
+    set_destroy(c);
+
+    set_destroy(s2);
+    set_destroy(s3);
+  }
+
+  // Empty operands, same operand twice
+  Set* e = set_new(int, 8, NULL);
+  Set* s = set_new(int, 8, NULL);
+  for (int i = 0; i < 10; i++)
+    set_add(s, i);
+  Set* r = set_intersect(s, e);
+  lu_assert(set_empty(r));
+  set_destroy(r);
+  r = set_union(e, s);
+  lu_assert_int_eq(set_size(r), 10);
+  set_destroy(r);
+  set_union_inplace(s, s);
+  lu_assert_int_eq(set_size(s), 10);
+  set_difference_inplace(s, s);
+  lu_assert(set_empty(s));
+  set_destroy(e);
+  set_destroy(s);
+}
+
+void t_set_filter()
+{
+  // Default and custom hashes (the filter then uses the default one)
+  for (int k = 0; k < 2; k++)
+  {
+    Set* s = set_new(int, 16, k == 0 ? NULL : getHash_int);
+    for (int i = 0; i < 100; i++)
+      set_add(s, 2 * i);
+    set_attach_filter(s, 0.01);
+    lu_assert(s->filter != NULL);
+
+    // Adds (with rehashes) and deletes through the filter
+    for (int i = 0; i < 20000; i++)
+      set_add(s, 2 * i);
+    for (int i = 0; i < 20000; i += 4)
+      set_delete(s, 2 * i);
+    lu_assert_int_eq(set_size(s), 15000);
+    for (int i = 0; i < 40000; i++)
+    {
+      int remainder = i % 8;
+      lu_assert(set_has(s, &i) == ((i & 1) == 0 && remainder != 0));
+    }
+    int misses = 0;
+    for (int i = 1; i < 40000; i += 2)
+      misses += !bloomfilter_has(s->filter, &i, sizeof(int));
+    lu_assert_int_gt(misses, 19000);
+
+    // Rehash rebuilds the filter without deleted items
+    set_reserve(s, 4 * s->hashSize);
+    lu_assert_int_eq(bloomfilter_size(s->filter), 15000);
+
+    // Copy, algebra results and clear keep a filter in sync
+    Set* copy = set_copy(s);
+    lu_assert(copy->filter != NULL);
+    int two = 2;
+    lu_assert(set_has(copy, &two));
+    Set* u = set_union(s, copy);
+    lu_assert(u->filter != NULL);
+    lu_assert_int_eq(set_size(u), 15000);
+    lu_assert(set_has(u, &two));
+    set_clear(s);
+    lu_assert(!set_has(s, &two));
+    set_add(s, 2);
+    lu_assert(set_has(s, &two));
+    set_detach_filter(s);
+    lu_assert(s->filter == NULL);
+    lu_assert(set_has(s, &two));
+    set_destroy(u);
+    set_destroy(copy);
+    set_destroy(s);
+  }
+}
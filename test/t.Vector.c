@@ -1,4 +1,6 @@
 #include <stdlib.h>
+#include <math.h>
+#include <unistd.h>
 #include "cgds/Vector.h"
 #include "helpers.h"
 #include "lut.h"
@@ -146,3 +148,512 @@ void t_vector_copy()
   vector_destroy(v);
   vector_destroy(vc);
 }
+
+void t_vector_growth_policy()
+{
+  int n = 100;
+
+  Vector* v = vector_new(int);
+  VectorPolicy policy = vector_get_policy(v);
+  policy.growFactor = 1.5;
+  policy.growStep = 4;
+  vector_set_policy(v, policy);
+  vector_push(v, 0);
+  lu_assert_int_eq(v->capacity, 4);
+  for (int i = 1; i < 5; i++)
+    vector_push(v, i);
+  lu_assert_int_eq(v->capacity, 10);
+  vector_destroy(v);
+
+  // Large arrays are memory-mapped, and remapped when growing
+  v = vector_new(Int);
+  policy = vector_get_policy(v);
+  policy.hugeThreshold = 64 * sizeof(Int);
+  vector_set_policy(v, policy);
+  for (int i = 0; i < n; i++)
+    vector_push(v, (Int)i);
+  lu_assert(v->storage == MMAP_S);
+  Vector* vc = vector_copy(v);
+  lu_assert(vc->storage == MMAP_S);
+  for (int i = 0; i < n; i++)
+  {
+    Int a, b;
+    vector_get(v, i, a);
+    vector_get(vc, i, b);
+    lu_assert_int_eq(a, i);
+    lu_assert_int_eq(b, i);
+  }
+  // Back to heap memory when shrinking below threshold
+  for (int i = 0; i < n - 10; i++)
+    vector_pop(v);
+  lu_assert(v->storage == HEAP_S);
+  for (int i = 0; i < 10; i++)
+  {
+    Int a;
+    vector_get(v, i, a);
+    lu_assert_int_eq(a, i);
+  }
+  vector_destroy(v);
+  vector_destroy(vc);
+}
+
+void t_vector_shrink_policy()
+{
+  Vector* v = vector_new(int);
+  for (int i = 0; i < 9; i++)
+    vector_push(v, i);
+  lu_assert_int_eq(v->capacity, 16);
+  // Oscillation around a power of two: no reallocation
+  void* datas = v->datas;
+  for (int i = 0; i < 100; i++)
+  {
+    vector_pop(v);
+    vector_push(v, i);
+  }
+  lu_assert_int_eq(v->capacity, 16);
+  lu_assert(v->datas == datas);
+  // Halve capacity only under a quarter
+  for (int i = 0; i < 5; i++)
+    vector_pop(v);
+  lu_assert_int_eq(v->capacity, 16);
+  vector_pop(v);
+  lu_assert_int_eq(v->capacity, 8);
+  vector_shrink_to_fit(v);
+  lu_assert_int_eq(v->capacity, 3);
+  for (int i = 0; i < 3; i++)
+  {
+    int a;
+    vector_get(v, i, a);
+    lu_assert_int_eq(a, i);
+  }
+  vector_destroy(v);
+
+  // Opt-out: never shrink
+  v = vector_new(int);
+  VectorPolicy policy = vector_get_policy(v);
+  policy.shrinkBelow = 0.0;
+  vector_set_policy(v, policy);
+  for (int i = 0; i < 32; i++)
+    vector_push(v, i);
+  while (!vector_empty(v))
+    vector_pop(v);
+  lu_assert_int_eq(v->capacity, 32);
+  vector_destroy(v);
+
+  // Large shrinkBelow: clamped, and capacity never goes under size
+  v = vector_new(int);
+  policy = vector_get_policy(v);
+  policy.shrinkBelow = 0.9;
+  vector_set_policy(v, policy);
+  lu_assert(vector_get_policy(v).shrinkBelow == 0.5);
+  for (int i = 0; i < 8; i++)
+    vector_push(v, i);
+  for (int i = 0; i < 5; i++)
+    vector_pop(v);
+  lu_assert_int_eq(v->size, 3);
+  lu_assert_int_eq(v->capacity, 4);
+  for (int i = 0; i < 3; i++)
+  {
+    int a;
+    vector_get(v, i, a);
+    lu_assert_int_eq(a, i);
+  }
+  vector_destroy(v);
+}
+
+void t_vector_bulk_ranges()
+{
+  int n = 100;
+
+  Vector* v = vector_new(int);
+  vector_reserve(v, n);
+  lu_assert_int_eq(v->capacity, n);
+  lu_assert(vector_empty(v));
+  int* ints = (int*) malloc(n * sizeof (int));
+  for (int i = 0; i < n; i++)
+    ints[i] = i;
+  vector_append_n(v, ints, n / 2);
+  lu_assert_int_eq(v->capacity, n);
+  // Insert [0, 10) between 49 and 50: positions 50 to 59
+  vector_append_n(v, ints + n / 2, n / 2);
+  vector_insert_range(v, n / 2, ints, 10);
+  lu_assert_int_eq(vector_size(v), n + 10);
+  int a;
+  for (int i = 0; i < n + 10; i++)
+  {
+    vector_get(v, i, a);
+    if (i < n / 2)
+      lu_assert_int_eq(a, i);
+    else if (i < n / 2 + 10)
+      lu_assert_int_eq(a, i - n / 2);
+    else
+      lu_assert_int_eq(a, i - 10);
+  }
+  // Erase them back
+  vector_erase_range(v, n / 2, 10);
+  lu_assert_int_eq(vector_size(v), n);
+  for (int i = 0; i < n; i++)
+  {
+    vector_get(v, i, a);
+    lu_assert_int_eq(a, i);
+  }
+  vector_erase_range(v, 0, n - 5);
+  lu_assert_int_eq(vector_size(v), 5);
+  lu_assert_int_le(v->capacity, 20);
+  vector_get(v, 0, a);
+  lu_assert_int_eq(a, n - 5);
+  // Resize: zero-filled extension
+  vector_resize(v, 8);
+  for (int i = 5; i < 8; i++)
+  {
+    vector_get(v, i, a);
+    lu_assert_int_eq(a, 0);
+  }
+  vector_resize(v, 2);
+  lu_assert_int_eq(vector_size(v), 2);
+  safe_free(ints);
+  vector_destroy(v);
+}
+
+void t_vector_kernels()
+{
+  int n = 1003;
+
+  Vector* v = vector_new(Int);
+  Int sum = 0;
+  for (int i = 0; i < n; i++)
+  {
+    Int value = (i % 7) - 3 * i;
+    vector_push(v, value);
+    sum += value;
+  }
+  lu_assert_int_eq(vector_sum_int(v), sum);
+  lu_assert_int_eq(vector_max_int(v), 0);
+  lu_assert_int_eq(vector_min_int(v), (Int) ((n - 1) % 7) - 3 * (n - 1));
+  Int index;
+  vector_find(v, (Int) (6 - 3 * 1000), index);
+  lu_assert_int_eq(index, 1000);
+  vector_find(v, (Int) 1, index);
+  lu_assert_int_eq(index, -1);
+  UInt count;
+  vector_fill(v, (Int) 42);
+  vector_count(v, (Int) 42, count);
+  lu_assert_int_eq(count, n);
+  vector_set(v, n - 1, (Int) 0);
+  vector_count(v, (Int) 42, count);
+  lu_assert_int_eq(count, n - 1);
+  vector_destroy(v);
+
+  v = vector_new(Real);
+  for (int i = 0; i < n; i++)
+    vector_push(v, (Real) i / 4);
+  lu_assert_dbl_eq(vector_sum_real(v), (Real) (n - 1) * n / 8);
+  lu_assert_dbl_eq(vector_min_real(v), 0.0);
+  lu_assert_dbl_eq(vector_max_real(v), (Real) (n - 1) / 4);
+  vector_find(v, 2.5, index);
+  lu_assert_int_eq(index, 10);
+  vector_destroy(v);
+
+  v = vector_new(int);
+  for (int i = 0; i < n; i++)
+    vector_push(v, i % 10);
+  vector_count(v, 9, count);
+  lu_assert_int_eq(count, n / 10);
+  vector_find(v, 7, index);
+  lu_assert_int_eq(index, 7);
+  vector_destroy(v);
+
+  v = vector_new(StructTest1);
+  StructTest1 st1;
+  memset(&st1, 0, sizeof (StructTest1));
+  for (int i = 0; i < 10; i++)
+  {
+    st1.a = i;
+    vector_push(v, st1);
+  }
+  st1.a = 5;
+  vector_find(v, st1, index);
+  lu_assert_int_eq(index, 5);
+  vector_destroy(v);
+}
+
+int compare_int(const void* a, const void* b)
+{
+  int x = *((const int*)a), y = *((const int*)b);
+  return (x > y) - (x < y);
+}
+
+int compare_st1_a(const void* a, const void* b)
+{
+  int x = ((const StructTest1*)a)->a, y = ((const StructTest1*)b)->a;
+  return (x > y) - (x < y);
+}
+
+void t_vector_sort()
+{
+  int n = 100000; //large enough for a parallel sort
+
+  Vector* v = vector_new(int);
+  for (int i = 0; i < n; i++)
+    vector_push(v, (int) (random() % 1000));
+  vector_sort(v, compare_int);
+  int a, b;
+  for (int i = 1; i < n; i++)
+  {
+    vector_get(v, i - 1, a);
+    vector_get(v, i, b);
+    lu_assert_int_le(a, b);
+  }
+  bool found;
+  vector_get(v, n / 2, a);
+  vector_binary_search(v, a, compare_int, found);
+  lu_assert(found);
+  vector_binary_search(v, 1000, compare_int, found);
+  lu_assert(!found);
+  UInt index;
+  vector_lower_bound(v, a, compare_int, index);
+  vector_get(v, index, b);
+  lu_assert_int_eq(a, b);
+  if (index > 0)
+  {
+    vector_get(v, index - 1, b);
+    lu_assert_int_lt(b, a);
+  }
+  vector_destroy(v);
+
+  // Stable sort: items with same 'a' keep their insertion order ('b')
+  v = vector_new(StructTest1);
+  for (int i = 0; i < n; i++)
+  {
+    StructTest1 st1 = { .a = (int) (random() % 100), .b = (double) i };
+    vector_push(v, st1);
+  }
+  vector_stable_sort(v, compare_st1_a);
+  StructTest1 st1Prev, st1Cell;
+  for (int i = 1; i < n; i++)
+  {
+    vector_get(v, i - 1, st1Prev);
+    vector_get(v, i, st1Cell);
+    lu_assert_int_le(st1Prev.a, st1Cell.a);
+    if (st1Prev.a == st1Cell.a)
+      lu_assert_dbl_lt(st1Prev.b, st1Cell.b);
+  }
+  vector_destroy(v);
+
+  // Radix sorts
+  v = vector_new(Int);
+  for (int i = 0; i < n; i++)
+    vector_push(v, (Int) (random() % 2000001) - 1000000);
+  vector_sort_int(v);
+  Int c, d;
+  for (int i = 1; i < n; i++)
+  {
+    vector_get(v, i - 1, c);
+    vector_get(v, i, d);
+    lu_assert(c <= d);
+  }
+  vector_destroy(v);
+  v = vector_new(Real);
+  for (int i = 0; i < n; i++)
+    vector_push(v, (Real) random() / RAND_MAX - 0.5);
+  vector_push(v, (Real) -INFINITY);
+  vector_push(v, 0.0);
+  vector_sort_real(v);
+  Real e, f;
+  vector_get(v, 0, e);
+  lu_assert(e == -INFINITY);
+  for (int i = 1; i <= n + 1; i++)
+  {
+    vector_get(v, i - 1, e);
+    vector_get(v, i, f);
+    lu_assert_dbl_le(e, f);
+  }
+  vector_destroy(v);
+}
+
+void t_vector_mmap()
+{
+  int n = 10000;
+
+  char path[] = "/tmp/cgds_vector_XXXXXX";
+  int fd = mkstemp(path);
+  lu_assert(fd >= 0);
+  close(fd);
+
+  Vector* v = vector_open_mmap(path, sizeof(Int), VECTOR_MMAP_TRUNC);
+  lu_assert(v != NULL);
+  lu_assert(vector_empty(v));
+  for (int i = 0; i < n; i++)
+    vector_push(v, (Int) i);
+  vector_set(v, 0, (Int) -1);
+  vector_close(v);
+
+  // Wrong element size: rejected
+  v = vector_open_mmap(path, sizeof(int), 0);
+  lu_assert(v == NULL);
+
+  // Reopen: same content
+  v = vector_open_mmap(path, sizeof(Int), VECTOR_MMAP_RDONLY);
+  lu_assert(v != NULL);
+  lu_assert_int_eq(vector_size(v), n);
+  Int a;
+  vector_get(v, 0, a);
+  lu_assert_int_eq(a, -1);
+  for (int i = 1; i < n; i++)
+  {
+    vector_get(v, i, a);
+    lu_assert_int_eq(a, i);
+  }
+  lu_assert_int_eq(vector_sum_int(v), (Int) (n - 1) * n / 2 - 1);
+  vector_close(v);
+
+  // Read-only: pops only shrink the in-memory view, not the file
+  v = vector_open_mmap(path, sizeof(Int), VECTOR_MMAP_RDONLY);
+  lu_assert(v != NULL);
+  lu_assert(v->readOnly);
+  for (int i = 0; i < n - 1; i++)
+    vector_pop(v);
+  lu_assert_int_eq(vector_size(v), 1);
+  vector_get(v, 0, a);
+  lu_assert_int_eq(a, -1);
+  vector_erase_range(v, 0, 1);
+  lu_assert(vector_empty(v));
+  vector_sync(v);
+  vector_close(v);
+  v = vector_open_mmap(path, sizeof(Int), VECTOR_MMAP_RDONLY);
+  lu_assert_int_eq(vector_size(v), n);
+  vector_clear(v);
+  lu_assert(vector_empty(v));
+  vector_destroy(v);
+
+  // Shrink, then reopen
+  v = vector_open_mmap(path, sizeof(Int), 0);
+  lu_assert(v != NULL);
+  vector_erase_range(v, 10, n - 10);
+  vector_pop(v);
+  vector_sync(v);
+  vector_destroy(v);
+  v = vector_open_mmap(path, sizeof(Int), 0);
+  lu_assert_int_eq(vector_size(v), 9);
+  vector_get(v, 8, a);
+  lu_assert_int_eq(a, 8);
+  vector_destroy(v);
+
+  unlink(path);
+}
+
+void t_vector_small()
+{
+  Vector* v = smallvector_new(int, 8);
+  lu_assert(v->storage == INLINE_S);
+  lu_assert_int_eq(v->capacity, 8);
+  void* buffer = v->datas;
+
+  // No allocation while inline buffer is enough
+  for (int i = 0; i < 8; i++)
+    vector_push(v, i);
+  lu_assert(v->datas == buffer);
+  lu_assert_int_eq(vector_size(v), 8);
+
+  // Growth: regular storage
+  for (int i = 8; i < 100; i++)
+    vector_push(v, i);
+  lu_assert(v->storage != INLINE_S);
+  int a;
+  for (int i = 0; i < 100; i++)
+  {
+    vector_get(v, i, a);
+    lu_assert_int_eq(a, i);
+  }
+
+  // Copy keeps the small buffer mode
+  Vector* w = vector_copy(v);
+  lu_assert(w->inlineDatas != NULL);
+  lu_assert_int_eq(vector_size(w), 100);
+  vector_clear(w);
+  lu_assert(w->storage == INLINE_S);
+  vector_push(w, 42);
+  vector_get(w, 0, a);
+  lu_assert_int_eq(a, 42);
+  vector_destroy(w);
+
+  // Back to inline buffer when small enough
+  vector_erase_range(v, 5, 95);
+  vector_shrink_to_fit(v);
+  lu_assert(v->datas == buffer);
+  lu_assert_int_eq(vector_size(v), 5);
+  for (int i = 0; i < 5; i++)
+  {
+    vector_get(v, i, a);
+    lu_assert_int_eq(a, i);
+  }
+  vector_clear(v);
+  lu_assert(v->datas == buffer);
+  lu_assert(vector_empty(v));
+  vector_destroy(v);
+}
+
+// Number of allocations through sort_counting_alloc()
+static int sortAllocations = 0;
+
+void* sort_counting_alloc(void* ctx, size_t size)
+{
+  sortAllocations++;
+  return counting_alloc(ctx, size);
+}
+
+void t_vector_allocator()
+{
+  AllocCounter counter;
+  Allocator allocator = counting_allocator(&counter);
+
+  Vector* v = vector_new_with(int, &allocator);
+  lu_assert(v->allocator == &allocator);
+  for (int i = 0; i < 1000; i++)
+    vector_push(v, i);
+  lu_assert(counter.bytes >= 1000 * sizeof(int));
+  lu_assert_int_eq(counter.blocks, 2);
+
+  // Copies and iterators use the same allocator
+  Vector* w = vector_copy(v);
+  VectorIterator* vi = vector_get_iterator(w);
+  lu_assert_int_eq(counter.blocks, 5);
+  vectorI_destroy(vi);
+  vector_destroy(w);
+  lu_assert_int_eq(counter.blocks, 2);
+
+  for (int i = 0; i < 1000; i++)
+    vector_pop(v);
+  vector_destroy(v);
+  lu_assert_int_eq(counter.blocks, 0);
+  lu_assert_int_eq(counter.bytes, 0);
+
+  // Small vector: one block while inline
+  v = smallvector_new_with(int, 4, &allocator);
+  vector_push(v, 1);
+  lu_assert_int_eq(counter.blocks, 1);
+  for (int i = 0; i < 10; i++)
+    vector_push(v, i);
+  lu_assert_int_eq(counter.blocks, 2);
+  vector_destroy(v);
+  lu_assert_int_eq(counter.bytes, 0);
+
+  // Radix sort temporaries (buffer and digit counts) too
+  Allocator sortAllocator = counting_allocator(&counter);
+  sortAllocator.alloc = sort_counting_alloc;
+  v = vector_new_with(Int, &sortAllocator);
+  for (Int i = 0; i < 1000; i++)
+    vector_push(v, (Int) ((i * 7919) & 1023) - 512);
+  size_t bytes = counter.bytes;
+  int allocations = sortAllocations;
+  vector_sort_int(v);
+  lu_assert_int_eq(sortAllocations - allocations, 2);
+  lu_assert_int_eq(counter.bytes, bytes);
+  vector_destroy(v);
+  lu_assert_int_eq(counter.bytes, 0);
+
+  // Default allocator
+  v = vector_new(int);
+  lu_assert(v->allocator == &safe_allocator);
+  vector_destroy(v);
+}
@@ -0,0 +1,150 @@
+#include <stdlib.h>
+#include "cgds/typed.h"
+#include "helpers.h"
+#include "lut.h"
+
+CGDS_DEFINE_VECTOR(int, IntVec)
+CGDS_DEFINE_HEAP(StructTest1, StHeap)
+CGDS_DEFINE_SET(UInt, UIntSet)
+CGDS_DEFINE_HASHTABLE(Int, double, IntDict)
+CGDS_DEFINE_HASHTABLE_EX(char*, int, StrDict,
+                         cgds_hash_string, cgds_equal_string)
+
+void t_typed_vector()
+{
+  int n = 100;
+
+  IntVec* v = IntVec_new();
+  lu_assert(IntVec_empty(v));
+  for (int i = 0; i < n; i++)
+    IntVec_push(v, i);
+  lu_assert_int_eq(IntVec_size(v), n);
+  for (int i = 0; i < n; i++)
+    lu_assert_int_eq(IntVec_get(v, i), i);
+  IntVec_set(v, 3, -3);
+  *IntVec_at(v, 4) = -4;
+  IntVec* vc = IntVec_copy(v);
+  lu_assert_int_eq(IntVec_get(vc, 3), -3);
+  lu_assert_int_eq(IntVec_get(vc, 4), -4);
+  IntVec_append_n(vc, v->datas, n);
+  lu_assert_int_eq(IntVec_size(vc), 2 * n);
+  lu_assert_int_eq(IntVec_get(vc, n + 10), 10);
+  for (int i = 0; i < n - 1; i++)
+    IntVec_pop(v);
+  lu_assert_int_eq(IntVec_size(v), 1);
+  lu_assert_int_eq(IntVec_get(v, 0), 0);
+  IntVec_destroy(v);
+  IntVec_destroy(vc);
+}
+
+void t_typed_heap()
+{
+  int n = 100;
+
+  StHeap* h = StHeap_new(MIN_T, 3);
+  for (int i = 0; i < n; i++)
+  {
+    StructTest1 st1 = { .a = i, .b = (double) i };
+    // Insert in "random" order: 37 is coprime with 100
+    StHeap_insert(h, st1, (Real) ((37 * i) % n));
+  }
+  lu_assert_int_eq(StHeap_size(h), n);
+  StHeap* hc = StHeap_copy(h);
+  for (int i = 0; i < n; i++)
+  {
+    lu_assert_dbl_eq(StHeap_top_value(h), (Real) i);
+    StructTest1 st1 = StHeap_top(h);
+    int ckValue = (37 * st1.a) % n;
+    lu_assert_int_eq(ckValue, i);
+    StHeap_pop(h);
+  }
+  lu_assert(StHeap_empty(h));
+  lu_assert_int_eq(StHeap_size(hc), n);
+  lu_assert_dbl_eq(StHeap_top_value(hc), 0.0);
+  StHeap_destroy(h);
+  StHeap_destroy(hc);
+}
+
+void t_typed_set()
+{
+  int n = 1000;
+
+  UIntSet* s = UIntSet_new();
+  for (int i = 0; i < n; i++)
+  {
+    UIntSet_add(s, (UInt) (3 * i));
+    UIntSet_add(s, (UInt) (3 * i)); //no effect
+  }
+  lu_assert_int_eq(UIntSet_size(s), n);
+  for (int i = 0; i < 3 * n; i++)
+    lu_assert(UIntSet_has(s, (UInt) i) == (i % 3 == 0));
+  for (int i = 0; i < n; i += 2)
+    UIntSet_delete(s, (UInt) (3 * i));
+  lu_assert_int_eq(UIntSet_size(s), n / 2);
+  UIntSet* sc = UIntSet_copy(s);
+  for (int i = 0; i < n; i++)
+  {
+    lu_assert(UIntSet_has(s, (UInt) (3 * i)) == (i % 2 == 1));
+    lu_assert(UIntSet_has(sc, (UInt) (3 * i)) == (i % 2 == 1));
+  }
+  UIntSet_clear(s);
+  lu_assert(UIntSet_empty(s));
+  lu_assert(!UIntSet_has(s, 3));
+  UIntSet_destroy(s);
+  UIntSet_destroy(sc);
+}
+
+void t_typed_hashtable()
+{
+  int n = 1000;
+
+  IntDict* h = IntDict_new();
+  for (int i = 0; i < n; i++)
+    IntDict_set(h, (Int) i, (double) i / 2);
+  lu_assert_int_eq(IntDict_size(h), n);
+  for (int i = 0; i < n; i++)
+    lu_assert_dbl_eq(*IntDict_get(h, (Int) i), (double) i / 2);
+  lu_assert(IntDict_get(h, (Int) n) == NULL);
+  IntDict_set(h, 7, -1.0);
+  lu_assert_dbl_eq(*IntDict_get(h, 7), -1.0);
+  for (int i = 0; i < n; i++)
+    IntDict_delete(h, (Int) i);
+  lu_assert(IntDict_empty(h));
+  IntDict_destroy(h);
+
+  StrDict* hs = StrDict_new();
+  StrDict_set(hs, "key1", 1);
+  StrDict_set(hs, "key2", 2);
+  char key[] = "key1";
+  lu_assert_int_eq(*StrDict_get(hs, key), 1);
+  StrDict* hsc = StrDict_copy(hs);
+  StrDict_delete(hs, "key1");
+  lu_assert(StrDict_get(hs, "key1") == NULL);
+  lu_assert_int_eq(*StrDict_get(hsc, "key1"), 1);
+  lu_assert_int_eq(*StrDict_get(hsc, "key2"), 2);
+  StrDict_destroy(hs);
+  StrDict_destroy(hsc);
+}
+
+void t_typed_allocator()
+{
+  AllocCounter counter;
+  Allocator allocator = counting_allocator(&counter);
+
+  IntVec* v = IntVec_new_with(&allocator);
+  UIntSet* s = UIntSet_new_with(&allocator);
+  for (int i = 0; i < 100; i++)
+  {
+    IntVec_push(v, i);
+    UIntSet_add(s, i);
+  }
+  IntVec* vc = IntVec_copy(v);
+  lu_assert(vc->allocator == &allocator);
+  IntVec_destroy(vc);
+  IntVec_clear(v);
+  lu_assert_int_eq(counter.blocks, 1 + 3);
+  IntVec_destroy(v);
+  UIntSet_destroy(s);
+  lu_assert_int_eq(counter.blocks, 0);
+  lu_assert_int_eq(counter.bytes, 0);
+}